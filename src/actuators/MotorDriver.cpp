@@ -14,7 +14,7 @@ MotorDriver::MotorDriver()
     DBG_PRINTLN("###########################################################");
     DBG_PRINTLN("#               Starting Motor Manager                   #");
     DBG_PRINTLN("###########################################################");
-    Dir = CONF->GetBool(DIR_STATE, DIR_STATE_DEFAULT); // Default direction
+    Dir = CONF->get<Cfg::DirState>(); // Default direction
 }
 
 // ==================================================
@@ -22,13 +22,13 @@ MotorDriver::MotorDriver()
 // ==================================================
 uint32_t MotorDriver::getTimeoutMs_() {
     // Max runtime / pulse window in ms for motor / electromagnet drive
-    return CONF->GetULong64(LOCK_TIMEOUT_KEY, LOCK_TIMEOUT_DEFAULT);
+    return CONF->get<Cfg::LockTimeout>();
 }
 
 bool MotorDriver::isElectroMag_() {
     // true  -> electromagnet lock mode (no end-of-road switches)
     // false -> screw drive lock mode (uses end-of-road switches)
-    return CONF->GetBool(LOCK_EMAG_KEY, LOCK_EMAG_DEFAULT);
+    return CONF->get<Cfg::LockEmag>();
 }
 
 // ==================================================
@@ -46,7 +46,7 @@ void MotorDriver::begin() {
     unlock_();
 
     // Honor stored LOCK_STATE at boot using your async tasks
-    if (CONF->GetBool(LOCK_STATE, LOCK_STATE_DEFAULT)) {
+    if (CONF->get<Cfg::LockState>()) {
         if (startLockTask())   DBG_PRINTLN("[MOTOR] Initial state: LOCKED. Lock task started. 🔒");
         else                   DBG_PRINTLN("[MOTOR] Failed to start initial lock task. ❌");
     } else {
@@ -33,13 +33,21 @@
 // Wire structures (ESP-NOW)
 // ============================================================================
 // NOTE: Frames are binary. Each frame starts with a type byte so the receiver
-//       can distinguish Command vs Response vs PairInit.
+//       can distinguish Command vs Response vs PairInit vs raw transport.
 enum NowFrameType : uint8_t {            // 1-byte discriminator for the top-level ESP-NOW frame category
     NOW_FRAME_CMD       = 0x01,          // Command frame (typically Master -> Slave)
     NOW_FRAME_RESP      = 0x02,          // Response frame (ACK/Event; typically Slave -> Master)
-    NOW_FRAME_PAIR_INIT = 0x03           // Pairing/init frame (used during onboarding/handshake)
+    NOW_FRAME_PAIR_INIT = 0x03,          // Pairing/init frame (used during onboarding/handshake)
+    NOW_FRAME_TRANSPORT = 0x04           // Serialized transport frame follows (native wire mode, both ways)
 };
 
+// Wire capabilities, negotiated at pairing: optional byte after PairInit
+// (master offer) and the ACK_PAIR_INIT payload (slave answer). Masters that
+// send a bare PairInit stay on CommandAPI frames.
+#define NOW_WIRE_TRANSPORT      0x01     // accepts NOW_FRAME_TRANSPORT frames
+#define NOW_WIRE_JOURNAL_BIN    0x02     // accepts EVT_JOURNAL (binary journal replay)
+#define NOW_WIRE_CAPS_LOCAL     (NOW_WIRE_TRANSPORT | NOW_WIRE_JOURNAL_BIN)   // what this slave speaks
+
 typedef uint16_t NowOpcode;              // 16-bit opcode identifying the specific command/ack/event (sent little-endian on wire)
 
 #define NOW_STATE_REASON_MAX   16        // Max bytes reserved for the "reason" string in AckStatePayload (fixed-size field)
@@ -81,7 +89,24 @@ struct AckStatePayload {                 // Response payload describing current
     char     reason[NOW_STATE_REASON_MAX]; // Human-readable reason text (not necessarily NUL-terminated; use reason_len)
 };
 
-// Pairing/init frame (fixed-size; no variable payload)
+// Payload for "ACK_LINK_STATS": master link quality as seen by the slave
+struct AckLinkStatsPayload {             // Response payload describing the ESP-NOW link
+    int8_t   rssi_last;                  // Last master frame RSSI (dBm); 0 = none captured
+    int8_t   rssi_avg;                   // Mean over the rolling RSSI window (dBm)
+    int8_t   rssi_min;                   // Window minimum (dBm)
+    int8_t   rssi_max;                   // Window maximum (dBm)
+    uint8_t  channel;                    // Current Wi-Fi/ESP-NOW channel
+    uint8_t  score;                      // Link-quality score 0..100
+    uint8_t  online;                     // Master presence (0/1)
+    uint8_t  fail_streak;                // Consecutive failed delivery reports
+    uint16_t delivery_pm_le;             // Delivery ratio in permille (EWMA), little-endian
+    uint32_t rtt_us_le;                  // Send -> delivery report time (EWMA, us), little-endian
+    uint16_t rescans_le;                 // Channel rescans started, little-endian
+    uint16_t rescan_found_le;            // Rescans that found the master, little-endian
+    uint16_t rtt_hist_le[6];             // RTT buckets <1,<2,<5,<10,<20,>=20 ms (saturating), little-endian
+};
+
+// Pairing/init frame (fixed-size; may be followed by one wire-caps byte)
 struct PairInit {                        // Frame layout used to start pairing/handshake
     uint8_t  frameType;                  // Must be NOW_FRAME_PAIR_INIT so receiver can parse as PairInit
     uint8_t  caps;                       // Capability bitfield: bit0=Open, bit1=Shock, bit2=Reed, bit3=Fingerprint
@@ -178,6 +203,9 @@ struct PairInit {                        // Frame layout used to start pairing/h
 #define CMD_SET_SHOCK_SENS_THRESHOLD   0x2D  // Set shock sensitivity threshold (payload: threshold u8)
 #define CMD_SET_SHOCK_L2D_CFG          0x2E  // Set LIS2DHTR config (payload: odr,scale,res,evt,dur,axis,hpf_mode,hpf_cut,hpf_en,latch,int_lvl)
 
+// Link diagnostics [BACKGROUND]
+#define CMD_LINK_STATS          0x2F  // Request link stats (RSSI, delivery ratio, RTT, channel)
+
 
 // ============================================================================
 // Acknowledgment Messages (slave -> master)
@@ -256,6 +284,7 @@ struct PairInit {                        // Frame layout used to start pairing/h
 #define ACK_TMR_CANCELLED       0x94  // Timers cancelled
 #define ACK_ARMED               0x95  // System armed
 #define ACK_DISARMED            0x96  // System disarmed
+#define ACK_LINK_STATS          0x99  // Link stats (payload: AckLinkStatsPayload)
 #define ACK_ERR_TOKEN           0x9A  // Bad / foreign FP sensor token (tamper)
 #define ACK_ERR_MAC             0x9B  // MAC check failed (not allowed sender)
 #define ACK_ERR_POLICY          0x9C  // Policy / ruleset denies request
@@ -303,4 +332,16 @@ struct PairInit {                        // Frame layout used to start pairing/h
 // ---------------------- Generic event marker ----------------------
 #define EVT_GENERIC             0x9E  // Generic event / log marker (e.g., open button pressed)
 
+// ---------------------- Offline journal replay ----------------------
+// Only to masters that negotiated NOW_WIRE_JOURNAL_BIN; others get one NDJSON
+// line per EVT_GENERIC. Payload: [count u8][base seq varint] then count x
+// [type u8][seq delta varint][len u8][fields] (see src/radio/JournalCodec.hpp).
+#define EVT_JOURNAL             0xAC  // Batch of binary journal records
+
+// ---------------------- Wake report ----------------------
+// Device WakeReport (0x1B) on the legacy wire. Payload: cause u8
+// (esp_sleep_wakeup_cause_t), sources u8 (bit0 reed, bit1 open, bit2 shock),
+// warm u8 (1 = state restored from RTC memory).
+#define EVT_WAKE                0xDA  // Woke from deep sleep
+
 #endif // COMMAND_API_H
@@ -86,6 +86,9 @@
 #ifndef POWER_MODE_UPDATE
 #define POWER_MODE_UPDATE       30000       // ms between power mode eval (30)
 #endif
+#ifndef STATE_REPORT_DEADLINE_MS
+#define STATE_REPORT_DEADLINE_MS 2000       // queued StateReport older than this is dropped
+#endif
 
 // ============================================================================
 //  Hardware Pin Map (grouped by function for quick audits)
@@ -36,6 +36,17 @@
 #define MASTER_CHANNEL_KEY          "MCH"
 #define MASTER_CHANNEL_DEFAULT      0
 
+// Standby (redundant) master: reports fail over to it when the primary stops
+// acknowledging. Empty/zero MAC = no standby.
+#define MASTER_STANDBY_ID           "MSBID"   // string : MAC of standby master
+#define MASTER_STANDBY_LMK          "MSLMK"   // string : standby link key (hex)
+#define MASTER_STANDBY_ID_DEFAULT   "00:00:00:00:00:00"
+#define MASTER_STANDBY_LMK_DEFAULT  ""
+
+// Wire mode agreed at pairing (NOW_WIRE_* bits); 0 = CommandAPI frames only.
+#define MASTER_WIRE_KEY             "MWIRE"   // int    : negotiated wire caps
+#define MASTER_WIRE_DEFAULT         0
+
 // ---------------------------
 // Runtime lock / security state
 // ---------------------------
@@ -129,6 +140,57 @@
 #define FP_DEVICE_CONFIGURED_KEY     "FPDEV"
 #define FP_DEVICE_CONFIGURED_DEFAULT false
 
+// ============================================================================
+//  Typed registry (ConfigRegistry.hpp): one row per key above.
+//  X(Id, KEY, Kind, DEFAULT, Policy)
+//    Kind   : Bool / Int / UInt / U64 / Float / Str
+//    Policy : Deferred = batched by the NVS flusher, Critical = committed at once
+// ============================================================================
+#define CONFIG_KEY_TABLE(X) \
+  /* Identity / pairing */ \
+  X(DeviceName,         DEVICE_NAME,              Str,  DEVICE_NAME_DEFAULT,          Deferred) \
+  X(DeviceId,           DEVICE_ID,                Str,  DEVICE_ID_DEFAULT,            Deferred) \
+  X(MasterMac,          MASTER_ESPNOW_ID,         Str,  MASTER_ESPNOW_ID_DEFAULT,     Deferred) \
+  X(DeviceConfigured,   DEVICE_CONFIGURED,        Bool, DEVICE_CONFIGURED_DEFAULT,    Critical) \
+  X(ResetFlag,          RESET_FLAG,               Bool, RESET_FLAG_DEFAULT,           Critical) \
+  X(MasterLmk,          MASTER_LMK_KEY,           Str,  MASTER_LMK_DEFAULT,           Deferred) \
+  X(MasterChannel,      MASTER_CHANNEL_KEY,       Int,  MASTER_CHANNEL_DEFAULT,       Deferred) \
+  X(StandbyMac,         MASTER_STANDBY_ID,        Str,  MASTER_STANDBY_ID_DEFAULT,    Deferred) \
+  X(StandbyLmk,         MASTER_STANDBY_LMK,       Str,  MASTER_STANDBY_LMK_DEFAULT,   Deferred) \
+  X(MasterWire,         MASTER_WIRE_KEY,          Int,  MASTER_WIRE_DEFAULT,          Deferred) \
+  /* Runtime state */ \
+  X(LockState,          LOCK_STATE,               Bool, LOCK_STATE_DEFAULT,           Critical) \
+  X(DirState,           DIR_STATE,                Bool, DIR_STATE_DEFAULT,            Deferred) \
+  X(ArmedState,         ARMED_STATE,              Bool, ARMED_STATE_DEFAULT,          Critical) \
+  X(BreachState,        BREACH_STATE,             Bool, BREACH_STATE_DEFAULT,         Critical) \
+  X(FingerprintEnabled, FINGERPRINT_ENABLED,      Bool, FINGERPRINT_ENABLED_DEFAULT,  Deferred) \
+  X(MotionTrigAlarm,    MOTION_TRIG_ALARM,        Bool, MOTION_TRIG_ALARM_DEFAULT,    Deferred) \
+  X(CurrentTimeSaved,   CURRENT_TIME_SAVED,       U64,  DEFAULT_CURRENT_TIME_SAVED,   Deferred) \
+  X(LastTimeSaved,      LAST_TIME_SAVED,          U64,  DEFAULT_LAST_TIME_SAVED,      Deferred) \
+  /* Shock sensor */ \
+  X(ShockType,          SHOCK_SENSOR_TYPE_KEY,    Int,  SHOCK_SENSOR_TYPE_DEFAULT,    Deferred) \
+  X(ShockThreshold,     SHOCK_SENS_THRESHOLD_KEY, Int,  SHOCK_SENS_THRESHOLD_DEFAULT, Deferred) \
+  X(ShockOdr,           SHOCK_L2D_ODR_KEY,        Int,  SHOCK_L2D_ODR_DEFAULT,        Deferred) \
+  X(ShockScale,         SHOCK_L2D_SCALE_KEY,      Int,  SHOCK_L2D_SCALE_DEFAULT,      Deferred) \
+  X(ShockRes,           SHOCK_L2D_RES_KEY,        Int,  SHOCK_L2D_RES_DEFAULT,        Deferred) \
+  X(ShockEvtMode,       SHOCK_L2D_EVT_MODE_KEY,   Int,  SHOCK_L2D_EVT_MODE_DEFAULT,   Deferred) \
+  X(ShockDur,           SHOCK_L2D_DUR_KEY,        Int,  SHOCK_L2D_DUR_DEFAULT,        Deferred) \
+  X(ShockAxis,          SHOCK_L2D_AXIS_KEY,       Int,  SHOCK_L2D_AXIS_DEFAULT,       Deferred) \
+  X(ShockHpfMode,       SHOCK_L2D_HPF_MODE_KEY,   Int,  SHOCK_L2D_HPF_MODE_DEFAULT,   Deferred) \
+  X(ShockHpfCut,        SHOCK_L2D_HPF_CUT_KEY,    Int,  SHOCK_L2D_HPF_CUT_DEFAULT,    Deferred) \
+  X(ShockHpfEn,         SHOCK_L2D_HPF_EN_KEY,     Bool, SHOCK_L2D_HPF_EN_DEFAULT,     Deferred) \
+  X(ShockLatch,         SHOCK_L2D_LATCH_KEY,      Bool, SHOCK_L2D_LATCH_DEFAULT,      Deferred) \
+  X(ShockIntLevel,      SHOCK_L2D_INT_LVL_KEY,    Int,  SHOCK_L2D_INT_LVL_DEFAULT,    Deferred) \
+  /* Lock driver */ \
+  X(LockTimeout,        LOCK_TIMEOUT_KEY,         U64,  LOCK_TIMEOUT_DEFAULT,         Deferred) \
+  X(LockEmag,           LOCK_EMAG_KEY,            Bool, LOCK_EMAG_DEFAULT,            Deferred) \
+  /* Hardware presence */ \
+  X(HasOpenSwitch,      HAS_OPEN_SWITCH_KEY,      Bool, HAS_OPEN_SWITCH_DEFAULT,      Deferred) \
+  X(HasShockSensor,     HAS_SHOCK_SENSOR_KEY,     Bool, HAS_SHOCK_SENSOR_DEFAULT,     Deferred) \
+  X(HasReedSwitch,      HAS_REED_SWITCH_KEY,      Bool, HAS_REED_SWITCH_DEFAULT,      Deferred) \
+  X(HasFingerprint,     HAS_FINGERPRINT_KEY,      Bool, HAS_FINGERPRINT_DEFAULT,      Deferred) \
+  X(FpDeviceConfigured, FP_DEVICE_CONFIGURED_KEY, Bool, FP_DEVICE_CONFIGURED_DEFAULT, Deferred)
+
 // ============================================================================
 //  (Optional) Compile-time sanity checks for NVS key lengths
 // ============================================================================
@@ -141,6 +203,9 @@
   NVS_KEYLEN_OK(RESET_FLAG);
   NVS_KEYLEN_OK(MASTER_LMK_KEY);
   NVS_KEYLEN_OK(MASTER_CHANNEL_KEY);
+  NVS_KEYLEN_OK(MASTER_STANDBY_ID);
+  NVS_KEYLEN_OK(MASTER_STANDBY_LMK);
+  NVS_KEYLEN_OK(MASTER_WIRE_KEY);
 
   NVS_KEYLEN_OK(LOCK_STATE);
   NVS_KEYLEN_OK(DIR_STATE);
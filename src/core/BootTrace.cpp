@@ -0,0 +1,84 @@
+#include <BootTrace.hpp>
+#include <Config.hpp>
+#include <SleepTimer.hpp>
+#include <Utils.hpp>
+#include <esp_timer.h>
+
+namespace {
+
+constexpr size_t kPhases = static_cast<size_t>(BootTrace::Phase::Count);
+
+const char* const kNames[kPhases] = {
+  "config", "radio", "transport", "wake-report", "first-frame", "loop",
+  "gauge", "fingerprint", "led", "storage", "ready",
+};
+
+volatile uint32_t         s_at[kPhases] = {};
+esp_sleep_wakeup_cause_t  s_cause   = ESP_SLEEP_WAKEUP_UNDEFINED;
+uint8_t                   s_sources = 0;
+
+}  // namespace
+
+// =========================
+// Wake cause
+// =========================
+void BootTrace::begin() {
+  s_cause   = esp_sleep_get_wakeup_cause();
+  s_sources = 0;
+  if (s_cause == ESP_SLEEP_WAKEUP_EXT0) {
+    s_sources |= kWakeReed;   // SleepTimer arms EXT0 on the reed only
+  } else if (s_cause == ESP_SLEEP_WAKEUP_EXT1) {
+    const uint64_t pins = esp_sleep_get_ext1_wakeup_status();
+    if (pins & BUTTON_PIN_BITMASK(WAKE_UP_GPIO_OPEN_SWITCH))   s_sources |= kWakeOpen;
+    if (pins & BUTTON_PIN_BITMASK(WAKE_UP_GPIO_SHOCK_SENSOR1)) s_sources |= kWakeShock;
+  }
+}
+
+esp_sleep_wakeup_cause_t BootTrace::wakeCause() { return s_cause; }
+uint8_t BootTrace::wakeSources()                 { return s_sources; }
+
+// SleepTimer only arms EXT0/EXT1. A timer wake is NVS::simulatePowerDown()
+// rebooting through a 1 s deep sleep, so it boots like a reset.
+bool BootTrace::isSleepWake() {
+  return s_cause == ESP_SLEEP_WAKEUP_EXT0 || s_cause == ESP_SLEEP_WAKEUP_EXT1;
+}
+
+// =========================
+// Phases
+// =========================
+void BootTrace::mark(Phase p) {
+  const size_t i = static_cast<size_t>(p);
+  if (i >= kPhases || s_at[i]) return;
+  const uint32_t us = static_cast<uint32_t>(esp_timer_get_time());
+  s_at[i] = us ? us : 1;
+}
+
+uint32_t BootTrace::at(Phase p) {
+  const size_t i = static_cast<size_t>(p);
+  return i < kPhases ? s_at[i] : 0;
+}
+
+size_t BootTrace::payload(uint8_t* out, size_t max) {
+  const size_t need = 1 + kPhases * 4;
+  if (!out || max < need) return 0;
+  out[0] = static_cast<uint8_t>(kPhases);
+  for (size_t i = 0; i < kPhases; ++i) {
+    const uint32_t v = s_at[i];
+    uint8_t* p = out + 1 + i * 4;
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+    p[2] = uint8_t(v >> 16);
+    p[3] = uint8_t(v >> 24);
+  }
+  return need;
+}
+
+void BootTrace::print() {
+  DBGSTR();
+  DBG_PRINTF("[Boot] wake cause=%d sources=0x%02X\n", (int)s_cause, (unsigned)s_sources);
+  for (size_t i = 0; i < kPhases; ++i) {
+    if (!s_at[i]) continue;
+    DBG_PRINTF("[Boot] %-12s %8lu us\n", kNames[i], (unsigned long)s_at[i]);
+  }
+  DBGSTP();
+}
@@ -0,0 +1,59 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#pragma once
+/**
+ * @file BootTrace.h
+ * @brief Boot-phase timestamps (microseconds since reset).
+ *
+ * Each phase is stamped the first time it is reached; later marks are
+ * ignored. The master reads them with Device BootTimes (0x1C) to measure
+ * time-to-first-frame after a wake.
+ */
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+
+namespace BootTrace {
+
+// Wire order: append only.
+enum class Phase : uint8_t {
+  Config,        // NVS + warm state + CONF->begin()
+  Radio,         // ESP-NOW up
+  Transport,     // transport task running
+  WakeReport,    // wake event queued
+  FirstFrame,    // first ESP-NOW frame accepted by the driver
+  Loop,          // first Device::loop()
+  Gauge,         // deferred: fuel gauge configured
+  Fingerprint,   // deferred: sensor probed
+  Led,           // deferred: RGB task running
+  Storage,       // deferred: SPIFFS mounted, logger up
+  Ready,         // all deferred stages done
+  Count
+};
+
+// Wake sources (WakeReport payload bits).
+constexpr uint8_t kWakeReed  = 0x01;
+constexpr uint8_t kWakeOpen  = 0x02;
+constexpr uint8_t kWakeShock = 0x04;
+
+// Once, first thing in setup(): latches the wake cause and EXT1 pins.
+void begin();
+
+void     mark(Phase p);
+uint32_t at(Phase p);            // 0 = not reached
+
+esp_sleep_wakeup_cause_t wakeCause();
+uint8_t  wakeSources();          // kWake* bits (EXT0/EXT1 wakes)
+bool     isSleepWake();          // EXT0/EXT1 wake (not a software reboot)
+
+// [count u8] + count x u32 LE; returns bytes written (0 = too small).
+size_t payload(uint8_t* out, size_t max);
+void   print();
+
+}  // namespace BootTrace
@@ -13,6 +13,7 @@
 #include <vector>
 #include <Config.hpp>
 #include <Transport.hpp>
+#include <freertos/semphr.h>
 
 class EspNowManager;
 class RTCManager;
@@ -49,6 +50,13 @@ class StubHandler;
 #ifndef LOW_CRIT_GRACE_MS
 #define LOW_CRIT_GRACE_MS             60000UL   // ~60s grace before enforcing sleep
 #endif
+// Boot pauses, cold boots only (a deep-sleep wake skips them)
+#ifndef BOOT_SERIAL_WAIT_MS
+#define BOOT_SERIAL_WAIT_MS           3000      // time to attach the serial monitor
+#endif
+#ifndef BOOT_WIFI_SETTLE_MS
+#define BOOT_WIFI_SETTLE_MS           1000      // after WiFi.mode(), before ESP-NOW
+#endif
 
 class Device {
 public:
@@ -83,6 +91,7 @@ private:
   bool prevLocked       = true;
   bool prevDoorOpen     = false;
   bool prevMotorMoving  = false;
+  bool reedWakeMissedOpen_ = false;  // reed wake, door shut again before begin() ended
 
   bool prevCriticalOverlay = false;
   bool lowPowerCancelLatched_ = false;
@@ -110,6 +119,13 @@ private:
   uint32_t lastOpenBtnEdgeMs = 0;
   uint32_t lastDriverFarMs   = 0;
 
+  // ==== Handler serialisation ====
+  // Recursive mutex held by begin() and by loop()'s state sections (not
+  // the boot stage or service calls). The transport task takes it around
+  // every module handler callback, so handlers never run while loop() is
+  // touching the same state.
+  SemaphoreHandle_t stateMtx_ = nullptr;
+
   // ==== Reset handling ====
   bool     resetRequested_        = false;
   bool     resetInProgress_       = false;
@@ -128,7 +144,7 @@ private:
                                bool doorOpen, bool motorMoving);
   void cmd_LockIfSafeAndAck_(const char* src);
   void cmd_RequestUnlockIfAllowed_(const char* src);
-  void raiseBreachIfNeeded_();
+  void raiseBreachIfNeeded_(bool doorOpenHw);
   void processResetIfNeeded_();
   void performSafeReset_();
   bool canSleepNow_() const;
@@ -156,6 +172,19 @@ private:
   std::vector<uint8_t> buildStatePayload_() const;
   void enterCriticalSleepUnpaired_();
 
+  // ==== Staged boot (BootTrace.hpp) ====
+  // begin() brings up config, radio and transport and reports the wake;
+  // loop() then starts one deferred subsystem per pass.
+  uint8_t bootStage_     = 0;
+  bool    gaugeDeferred_ = false;   // warm wake: seeded reading until the gauge starts
+  void runBootStage_();
+  void reportWake_();
+
+  // ==== Warm sleep (WarmState.hpp) ====
+  void restoreWarmBand_();
+  void captureWarmState_();
+  static void onPreSleep_(void* ctx);
+
   friend class DeviceHandler;
 };
 
@@ -9,6 +9,23 @@
 #include <SwitchManager.hpp>
 #include <TransportManager.hpp>
 #include <Utils.hpp>
+#include <BootTrace.hpp>
+#include <WarmState.hpp>
+
+namespace {
+
+// Holds Device::stateMtx_ for begin() or one state section of loop().
+struct StateLock {
+  SemaphoreHandle_t m;
+  explicit StateLock(SemaphoreHandle_t mtx) : m(mtx) {
+    if (m) xSemaphoreTakeRecursive(m, portMAX_DELAY);
+  }
+  ~StateLock() {
+    if (m) xSemaphoreGiveRecursive(m);
+  }
+};
+
+}  // namespace
 
 // =========================
 // Construction / teardown
@@ -20,15 +37,18 @@ Device::~Device() {}
 // begin()
 // =========================
 void Device::begin() {
+  if (!stateMtx_) stateMtx_ = xSemaphoreCreateRecursiveMutex();
+  StateLock lock(stateMtx_);   // handlers wait until begin() is done
   initManagers_();
   ResetManager::Init(this);
+  restoreWarmBand_();
 
   // Early battery policy before entering main loop.
   guardLowPowerEarly_();
-  if (RGB) RGB->setDeviceState(DeviceState::INIT);
 
   // Snapshot HAS_* (loop() will use these gates)
   refreshCapabilities_();
+  reportWake_();
   DBG_PRINTF("[Caps] role=%s O%d S%d R%d F%d\n",
                isAlarmRole_ ? "ALARM" : "LOCK",
                hasOpenSwitch_ ? 1 : 0,
@@ -38,7 +58,7 @@ void Device::begin() {
 
   // Pairing banner (local log)
   if (CONF) {
-    const bool configured = CONF->GetBool(DEVICE_CONFIGURED, false);
+    const bool configured = CONF->get<Cfg::DeviceConfigured>();
     DBGSTR();
     DBG_PRINTLN("###########################################################");
     if (configured) {
@@ -55,12 +75,8 @@ void Device::begin() {
     }
     DBG_PRINTLN("###########################################################");
     DBGSTP();
-    // Initial LED state by pairing
-    if (RGB && !configured) {
-      RGB->setDeviceState( DeviceState::PAIRING);
-    }else if(RGB && configured){
-      RGB->setDeviceState( DeviceState::READY_ONLINE);
-    }
+    // Queued ahead of any early overlay; the LED task starts in runBootStage_.
+    if (RGB) RGB->setDeviceState(configured ? DeviceState::READY_ONLINE : DeviceState::PAIRING);
   }
 
   // Initialize cached states for transitions
@@ -70,6 +86,13 @@ void Device::begin() {
   prevDoorOpen         = hasReed_ ? isDoorOpen_() : false;
   prevMotorMoving      = isMotorMoving_();
   prevCriticalOverlay  = false;
+  // Reed wake: the opening is the edge that woke us, so the first loop()
+  // reports it (DoorEdge, StateReport, breach) like any other. If the door
+  // is already shut again, it reports the open edge and then the close.
+  if (hasReed_ && (BootTrace::wakeSources() & BootTrace::kWakeReed)) {
+    prevDoorOpen        = false;
+    reedWakeMissedOpen_ = !isDoorOpen_();
+  }
 
   DBG_PRINTLN("[Device] begin() complete");
 }
@@ -78,17 +101,30 @@ void Device::begin() {
 // loop()
 // =========================
 void Device::loop() {
-  processResetIfNeeded_();
-  if (resetInProgress_) return;
+  BootTrace::mark(BootTrace::Phase::Loop);
+  {
+    StateLock lock(stateMtx_);
+    processResetIfNeeded_();
+    if (resetInProgress_) return;
+  }
+
+  // 0) Deferred boot stages (gauge first: the power policy below reads it).
+  // Unlocked: a stage can block for a while on I2C/UART bring-up, and the
+  // peripherals it starts guard themselves.
+  runBootStage_();
 
-  updateConfigMode_();
+  // Only the Device state the transport handlers also touch is locked.
+  {
+    StateLock lock(stateMtx_);
+    updateConfigMode_();
 
-  // 1) Handle power policy (critical/low -> may sleep immediately).
-  enforcePowerPolicy_();
+    // 1) Handle power policy (critical/low -> may sleep immediately).
+    enforcePowerPolicy_();
 
-  // 2) Poll inputs and forward events to master.
-  const bool securityEnabled = !configModeActive_;
-  pollInputsAndEdges_(securityEnabled);
+    // 2) Poll inputs and forward events to master.
+    const bool securityEnabled = !configModeActive_;
+    pollInputsAndEdges_(securityEnabled);
+  }
 
   // 3) Debug MAC print (button-held).
   printMACIfUserButton_();
@@ -100,9 +136,26 @@ void Device::loop() {
     sleepTimer->service();
   }
   if (Sw)         Sw->service();
-  if (Transport)  Transport->tick();
+  if (Transport)  Transport->tick();   // no-op while the transport task runs
 
   if (resetRequested_) {
+    StateLock lock(stateMtx_);
     processResetIfNeeded_();
   }
 }
+
+// =========================
+// reportWake_()
+// =========================
+// Sent as soon as the transport runs; payload: wake cause
+// (esp_sleep_wakeup_cause_t), source bits (BootTrace::kWake*), warm flag.
+void Device::reportWake_() {
+  if (!BootTrace::isSleepWake() || !isConfigured_()) return;
+  const uint8_t cause = static_cast<uint8_t>(BootTrace::wakeCause());
+  const uint8_t warm  = WarmState::get() ? 1 : 0;
+  sendTransportEvent_(transport::Module::Device, /*op*/0x1B,
+                      {cause, BootTrace::wakeSources(), warm});
+  BootTrace::mark(BootTrace::Phase::WakeReport);
+  DBG_PRINTF("[Boot] wake report cause=%u sources=0x%02X warm=%u\n",
+             (unsigned)cause, (unsigned)BootTrace::wakeSources(), (unsigned)warm);
+}
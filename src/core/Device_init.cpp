@@ -13,6 +13,9 @@
 #include <SwitchManager.hpp>
 #include <TransportManager.hpp>
 #include <Utils.hpp>
+#include <BootTrace.hpp>
+#include <RGBLed.hpp>
+#include <WarmState.hpp>
 
 #include <DeviceHandler.hpp>
 #include <FingerprintHandler.hpp>
@@ -26,22 +29,26 @@
 // =========================
 void Device::initManagers_() {
   WiFi.mode(WIFI_STA);
-   delay(1000);
+  if (!BootTrace::isSleepWake()) delay(BOOT_WIFI_SETTLE_MS);
   // Time / RTC
-  struct tm timeInfo{};
+  static struct tm timeInfo{};   // RTCManager keeps the pointer
   RTCManager::Init(&timeInfo);
   RTC = RTCM;
   if (!RTC) return;
 
-  // Logger uses RTC
+  // Logger uses RTC (SPIFFS mount is a deferred boot stage)
   Logger::Init(RTC);
-  LOGG->Begin();
 
   // Power / fuel gauge
   PowerManager::Init();
   PowerMgr = POWERMGR;
   if (!PowerMgr) return;
-  PowerMgr->begin();
+  const WarmState::Block* warm = WarmState::get();
+  if (warm) PowerMgr->seedSnapshot(warm->gauge);
+  // Cold boot: the first report needs a live reading. Warm wake: report the
+  // seeded one and configure the gauge afterwards.
+  gaugeDeferred_ = warm != nullptr;
+  if (!gaugeDeferred_) PowerMgr->begin();
 
   // Motor control (skipped in alarm-only role)
   if (!isAlarmRole_) {
@@ -60,6 +67,7 @@ void Device::initManagers_() {
   sleepTimer = SleepTimer::Get();
   if (sleepTimer) {
     sleepTimer->reset();
+    sleepTimer->setPreSleepHook(&Device::onPreSleep_, this);
   }
 
   // Snapshot HAS_* before bringing up FP/radio so we can gate FP begin()
@@ -93,11 +101,13 @@ void Device::initManagers_() {
 
   // 4) Init radio AFTER wiring
   Now->init();
+  BootTrace::mark(BootTrace::Phase::Radio);
 
   // 4b) Init transport manager (self logical ID = 2 by default)
   Transport = new TransportManager(/*selfId=*/2, Now, CONF);
   if (Transport) {
     Now->attachTransport(Transport);
+    Transport->setHandlerLock(stateMtx_);
     DevHandler = new DeviceHandler(this, &Transport->port());
     if (DevHandler) {
       Transport->port().registerHandler(transport::Module::Device, DevHandler);
@@ -123,12 +133,54 @@ void Device::initManagers_() {
     if (ShockH) {
       Transport->port().registerHandler(transport::Module::Shock, ShockH);
     }
+    if (warm && warm->hasTransport) Transport->port().importResume(warm->transport);
+    // Start the transport task last: handlers must be registered before RX dispatch begins.
+    Transport->begin();
+    BootTrace::mark(BootTrace::Phase::Transport);
   }
 
-  // 5) Start FP only if present
-  if (Fing && hasFingerprint_) {
-    Fing->begin();
-  } else {
-    DBG_PRINTLN("[Device] Fingerprint disabled or alarm-only role");
+  // 5) Fingerprint, LED and SPIFFS start from runBootStage_()
+}
+
+// =========================
+// runBootStage_()
+// =========================
+// One deferred subsystem per loop() pass, after the wake is reported.
+void Device::runBootStage_() {
+  enum : uint8_t { kGauge, kFingerprint, kLed, kStorage, kDone };
+  using BootTrace::Phase;
+
+  switch (bootStage_) {
+    case kGauge:
+      if (gaugeDeferred_ && PowerMgr) PowerMgr->begin();
+      gaugeDeferred_ = false;
+      BootTrace::mark(Phase::Gauge);
+      break;
+
+    case kFingerprint:
+      if (Fing && hasFingerprint_) {
+        Fing->begin();
+      } else {
+        DBG_PRINTLN("[Device] Fingerprint disabled or alarm-only role");
+      }
+      BootTrace::mark(Phase::Fingerprint);
+      break;
+
+    case kLed:
+      // Plays what begin() queued and anything posted since (door, battery).
+      if (RGB) RGB->begin();
+      BootTrace::mark(Phase::Led);
+      break;
+
+    case kStorage:
+      LOGG->Begin();
+      BootTrace::mark(Phase::Storage);
+      BootTrace::mark(Phase::Ready);
+      BootTrace::print();
+      break;
+
+    default:
+      return;
   }
+  bootStage_++;
 }
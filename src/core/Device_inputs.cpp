@@ -27,6 +27,13 @@ void Device::pollInputsAndEdges_(bool securityEnabled) {
 
   const bool motorMoving = isMotorMoving_();
 
+  // Reed wake with the door already shut: the opening that woke us first.
+  if (reedWakeMissedOpen_) {
+    reedWakeMissedOpen_ = false;
+    handleStateTransitions_(configured, armed, locked, /*doorOpen*/true, motorMoving);
+    if (configured && armed) raiseBreachIfNeeded_(true);
+  }
+
   // Handle edges -> LEDs + master ACKs + flow tracking
   handleStateTransitions_(configured, armed, locked, doorOpen, motorMoving);
 
@@ -144,7 +151,7 @@ void Device::pollInputsAndEdges_(bool securityEnabled) {
 
   // Breach handling (paired+armed)
   if (configured && armed) {
-    raiseBreachIfNeeded_();
+    raiseBreachIfNeeded_(doorOpenHw);
   }
 }
 
@@ -251,14 +258,15 @@ void Device::cmd_RequestUnlockIfAllowed_(const char* src) {
 // =========================
 // Breach handling
 // =========================
-void Device::raiseBreachIfNeeded_() {
+// doorOpenHw: the reed as sampled by the caller (a missed reed-wake opening
+// passes true after the door has shut again).
+void Device::raiseBreachIfNeeded_(bool doorOpenHw) {
   if (configModeActive_) return;
   if (!isConfigured_() || !Now) return;
   if (!isArmed_())   return;
   if (effectiveBand_ != 0) return;
 
   // Effective door state (respect hasReed_ gating used elsewhere)
-  const bool doorOpenHw = isDoorOpen_();
   const bool doorOpen   = hasReed_ ? doorOpenHw : false;
 
   // Breach rule: Lock role requires LOCK_STATE=locked; Alarm role ignores lock state.
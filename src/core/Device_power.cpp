@@ -1,11 +1,14 @@
 #include <Device.hpp>
 #include <CommandAPI.hpp>
 #include <ConfigNvs.hpp>
+#include <ESPNOWManager.hpp>
 #include <FingerprintScanner.hpp>
 #include <NVSManager.hpp>
 #include <PowerManager.hpp>
 #include <SleepTimer.hpp>
+#include <TransportManager.hpp>
 #include <Utils.hpp>
+#include <WarmState.hpp>
 #include <esp_sleep.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -244,7 +247,56 @@ bool Device::canSleepNow_() const {
 // =========================
 void Device::enterCriticalSleepUnpaired_() {
  DBG_PRINTLN("[Power] entering deep sleep (unpaired, critical battery)");
+  CONF->Flush();
+  captureWarmState_();
   delay(50);
   esp_deep_sleep_start();
   while (true) { vTaskDelay(pdMS_TO_TICKS(1000)); }
 }
+
+
+// =========================
+// Warm sleep state
+// =========================
+// Grace/confirm timers resume with the awake time they had already run.
+void Device::restoreWarmBand_() {
+  const WarmState::Block* warm = WarmState::get();
+  if (!warm) return;
+  const WarmState::PowerBand& b = warm->band;
+  if (b.effective > 2 || b.pending > 2) return;
+  const uint32_t nowMs = ms_();
+  effectiveBand_         = b.effective;
+  pendingBand_           = b.pending;
+  lowPowerCancelLatched_ = b.cancelLatched;
+  bandChangeStartMs_     = b.bandTiming  ? ((nowMs - b.bandAgeMs)  | 1u) : 0;
+  lowCritGraceStartMs_   = b.graceTiming ? ((nowMs - b.graceAgeMs) | 1u) : 0;
+  // prevCriticalOverlay stays clear: each wake in Critical announces once.
+  if (Fing && effectiveBand_ != 0) Fing->setEnabled(false);
+  DBG_PRINTF("[Power] warm band=%u pending=%u\n", (unsigned)effectiveBand_, (unsigned)pendingBand_);
+}
+
+void Device::captureWarmState_() {
+  WarmState::Block& b = WarmState::stage();
+  if (CONF) CONF->exportSnapshot(b.cfg);
+
+  const uint32_t nowMs = ms_();
+  b.band.effective     = effectiveBand_;
+  b.band.pending       = pendingBand_;
+  b.band.cancelLatched = lowPowerCancelLatched_;
+  b.band.bandTiming    = bandChangeStartMs_ != 0;
+  b.band.graceTiming   = lowCritGraceStartMs_ != 0;
+  b.band.bandAgeMs     = b.band.bandTiming  ? nowMs - bandChangeStartMs_   : 0;
+  b.band.graceAgeMs    = b.band.graceTiming ? nowMs - lowCritGraceStartMs_ : 0;
+
+  if (Transport) {
+    Transport->port().exportResume(b.transport);
+    b.hasTransport = true;
+  }
+  if (Now) b.hasJournal = Now->journalCursor(b.journal, b.journalSeq);
+  if (PowerMgr) PowerMgr->exportSnapshot(b.gauge);
+  WarmState::capture();
+}
+
+void Device::onPreSleep_(void* ctx) {
+  static_cast<Device*>(ctx)->captureWarmState_();
+}
@@ -7,6 +7,7 @@
 #include <NVSManager.hpp>
 #include <RGBLed.hpp>
 #include <SleepTimer.hpp>
+#include <TransportManager.hpp>
 #include <Utils.hpp>
 #include <WiFi.h>
 #include <freertos/FreeRTOS.h>
@@ -93,5 +94,5 @@ void Device::stopFingerprint_() {
 
 void Device::stopTransport_() {
   if (!Transport) return;
-  // TransportManager currently has no explicit stop; placeholder for future.
+  Transport->stop();
 }
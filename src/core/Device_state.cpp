@@ -12,10 +12,10 @@
 // =========================
 void Device::refreshCapabilities_() {
   if (!CONF) return;
-  hasOpenSwitch_  = CONF->GetBool(HAS_OPEN_SWITCH_KEY,   HAS_OPEN_SWITCH_DEFAULT);
-  hasShock_       = CONF->GetBool(HAS_SHOCK_SENSOR_KEY,  HAS_SHOCK_SENSOR_DEFAULT);
-  hasReed_        = CONF->GetBool(HAS_REED_SWITCH_KEY,   HAS_REED_SWITCH_DEFAULT);
-  hasFingerprint_ = CONF->GetBool(HAS_FINGERPRINT_KEY,   HAS_FINGERPRINT_DEFAULT);
+  hasOpenSwitch_  = CONF->get<Cfg::HasOpenSwitch>();
+  hasShock_       = CONF->get<Cfg::HasShockSensor>();
+  hasReed_        = CONF->get<Cfg::HasReedSwitch>();
+  hasFingerprint_ = CONF->get<Cfg::HasFingerprint>();
 
   if (!isAlarmRole_ && !isConfigured_()) {
     hasOpenSwitch_ = true;
@@ -28,19 +28,19 @@ void Device::refreshCapabilities_() {
     hasShock_         = true;
     hasReed_          = true;
     bool capsDirty = false;
-    if (CONF->GetBool(HAS_OPEN_SWITCH_KEY, HAS_OPEN_SWITCH_DEFAULT) != false) {
+    if (CONF->get<Cfg::HasOpenSwitch>() != false) {
       CONF->PutBool(HAS_OPEN_SWITCH_KEY, false);
       capsDirty = true;
     }
-    if (CONF->GetBool(HAS_FINGERPRINT_KEY, HAS_FINGERPRINT_DEFAULT) != false) {
+    if (CONF->get<Cfg::HasFingerprint>() != false) {
       CONF->PutBool(HAS_FINGERPRINT_KEY, false);
       capsDirty = true;
     }
-    if (CONF->GetBool(HAS_SHOCK_SENSOR_KEY, HAS_SHOCK_SENSOR_DEFAULT) != true) {
+    if (CONF->get<Cfg::HasShockSensor>() != true) {
       CONF->PutBool(HAS_SHOCK_SENSOR_KEY, true);
       capsDirty = true;
     }
-    if (CONF->GetBool(HAS_REED_SWITCH_KEY, HAS_REED_SWITCH_DEFAULT) != true) {
+    if (CONF->get<Cfg::HasReedSwitch>() != true) {
       CONF->PutBool(HAS_REED_SWITCH_KEY, true);
       capsDirty = true;
     }
@@ -3,6 +3,48 @@
 #include <PowerManager.hpp>
 #include <TransportManager.hpp>
 
+namespace {
+// TX class per outgoing event. Alarm-path events must never wait behind
+// telemetry; StateReports are last-value-wins with a short deadline.
+transport::TransportPort::TxOptions txOptionsFor(transport::Module mod, uint8_t op) {
+  using transport::Module;
+  using transport::TxClass;
+  transport::TransportPort::TxOptions opt;
+  opt.cls = TxClass::Control;
+  switch (mod) {
+    case Module::Device:
+      switch (op) {
+        case 0x09: // StateReport
+          opt.cls        = TxClass::Telemetry;
+          opt.deadlineMs = STATE_REPORT_DEADLINE_MS;
+          opt.supersede  = true;
+          break;
+        case 0x0F: // AlarmRequest
+        case 0x11: // LockCanceled
+        case 0x12: // AlarmOnlyMode
+        case 0x13: // Breach
+        case 0x14: // CriticalPower
+        case 0x1B: // WakeReport
+          opt.cls = TxClass::Critical;
+          break;
+        default: break;
+      }
+      break;
+    case Module::Shock:
+      if (op == 0x03) opt.cls = TxClass::Critical;        // Trigger
+      break;
+    case Module::Motor:
+      if (op == 0x05) opt.cls = TxClass::Critical;        // MotorDone
+      break;
+    case Module::Power:
+      if (op == 0x03) opt.cls = TxClass::Critical;        // CriticalBatt
+      break;
+    default: break;
+  }
+  return opt;
+}
+} // namespace
+
 // =========================
 // Master comms (gated)
 // =========================
@@ -41,12 +83,12 @@ void Device::sendTransportEvent_(transport::Module mod, uint8_t op,
   msg.header.flags  = 0;
   msg.payload       = payload;
   msg.header.payloadLen = static_cast<uint8_t>(payload.size());
-  Transport->port().send(msg, true);
+  Transport->port().send(msg, txOptionsFor(mod, op));
 }
 
 std::vector<uint8_t> Device::buildStatePayload_() const {
   std::vector<uint8_t> pl;
-  pl.reserve(17);
+  pl.reserve(transport::kStateRecordSize);
   const bool armed     = isArmed_();
   const bool motion    = isMotionEnabled_();
   const bool locked    = isAlarmRole_ ? false : isLocked_();
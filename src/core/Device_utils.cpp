@@ -14,13 +14,13 @@
 uint32_t Device::ms_(){ return millis(); }
 
 // Persisted / manager states
-bool Device::isConfigured_() const { return CONF && CONF->GetBool(DEVICE_CONFIGURED, false); }
-bool Device::isArmed_() const      { return CONF && CONF->GetBool(ARMED_STATE, false); }
+bool Device::isConfigured_() const { return CONF && CONF->get<Cfg::DeviceConfigured>(); }
+bool Device::isArmed_() const      { return CONF && CONF->get<Cfg::ArmedState>(); }
 bool Device::isMotionEnabled_() const {
   if (configModeActive_) return true;
-  return CONF && CONF->GetBool(MOTION_TRIG_ALARM, false);
+  return CONF && CONF->get<Cfg::MotionTrigAlarm>();
 }
-bool Device::isLocked_() const     { return CONF && CONF->GetBool(LOCK_STATE, true); }
+bool Device::isLocked_() const     { return CONF && CONF->get<Cfg::LockState>(); }
 bool Device::isDoorOpen_() const   { return hasReed_ && Sw && Sw->isDoorOpen(); }
 bool Device::isMotorMoving_() const{ return motorDriver && motorDriver->isMovingOrSettling(MOTOR_SETTLE_MS); }
 
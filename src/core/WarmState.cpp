@@ -0,0 +1,85 @@
+#include <WarmState.hpp>
+#include <BootTrace.hpp>
+#include <TransportCrc.hpp>
+#include <Utils.hpp>
+#include <esp_attr.h>
+#include <string.h>
+
+// =========================
+// RTC block
+// =========================
+namespace {
+
+constexpr uint32_t kMagic = 0x574D5354;   // "WMST"
+
+struct Sealed {
+  uint32_t         magic;
+  uint16_t         version;
+  uint16_t         size;
+  WarmState::Block block;
+  uint16_t         crc;   // CRC-16 over block
+};
+
+RTC_DATA_ATTR Sealed s_rtc;
+bool s_warm = false;
+
+uint16_t crcOf_(const WarmState::Block& b) {
+  return transport::crc::crc16(reinterpret_cast<const uint8_t*>(&b), sizeof(b));
+}
+
+const char* rejectReason_() {
+  if (!BootTrace::isSleepWake())                  return "not a sleep wake";
+  if (s_rtc.magic != kMagic)                      return "no block";
+  if (s_rtc.version != WarmState::kVersion ||
+      s_rtc.size != sizeof(WarmState::Block))     return "layout changed";
+  if (s_rtc.crc != crcOf_(s_rtc.block))           return "crc";
+  return nullptr;
+}
+
+}  // namespace
+
+// =========================
+// Restore
+// =========================
+bool WarmState::begin() {
+#if WARM_STATE_ENABLED
+  const uint32_t t0 = micros();
+  const char* reject = rejectReason_();
+  s_rtc.magic = 0;   // consumed either way
+  if (reject) {
+    DBG_PRINTF("[Warm] cold boot (%s)\n", reject);
+    return false;
+  }
+  s_warm = true;
+  const size_t keys = CONF->importSnapshot(s_rtc.block.cfg);
+  DBG_PRINTF("[Warm] restored %u bytes, %u config keys in %luus\n",
+             (unsigned)sizeof(Block), (unsigned)keys, (unsigned long)(micros() - t0));
+  return true;
+#else
+  return false;
+#endif
+}
+
+const WarmState::Block* WarmState::get() {
+  return s_warm ? &s_rtc.block : nullptr;
+}
+
+// =========================
+// Capture
+// =========================
+WarmState::Block& WarmState::stage() {
+  s_warm = false;
+  s_rtc.magic = 0;
+  memset(&s_rtc.block, 0, sizeof(s_rtc.block));
+  return s_rtc.block;
+}
+
+void WarmState::capture() {
+#if WARM_STATE_ENABLED
+  s_rtc.version = kVersion;
+  s_rtc.size    = sizeof(Block);
+  s_rtc.crc     = crcOf_(s_rtc.block);
+  s_rtc.magic   = kMagic;
+  DBG_PRINTF("[Warm] captured %u bytes\n", (unsigned)sizeof(Block));
+#endif
+}
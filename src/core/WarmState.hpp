@@ -0,0 +1,76 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#pragma once
+/**
+ * @file WarmState.h
+ * @brief Device state kept in RTC slow memory across deep sleep.
+ *
+ * Right before esp_deep_sleep_start() the device fills stage() and calls
+ * capture(): config cache, battery band/grace timers, transport msgId and
+ * dedup window, flash journal cursor and the last gauge reading, sealed
+ * with a version, size and CRC-16.
+ *
+ * On the next boot begin() accepts the block only after a deep-sleep wake
+ * (BootTrace::isSleepWake(): reed/button/shock, not a software reboot)
+ * with everything matching, seeds the NVS cache at once, and leaves the
+ * rest in get() for the modules to pick up while they start. The block is
+ * consumed by begin(): a later sleep that does not capture wakes cold.
+ */
+
+#include <Arduino.h>
+#include <FlashJournal.hpp>
+#include <NVSManager.hpp>
+#include <PowerManager.hpp>
+#include <Transport.hpp>
+
+#ifndef WARM_STATE_ENABLED
+#define WARM_STATE_ENABLED  1
+#endif
+
+namespace WarmState {
+
+constexpr uint16_t kVersion = 1;   // bump when Block changes
+
+// Device battery band tracking. Timers are kept as awake-time ages
+// (millis() stops counting in deep sleep).
+struct PowerBand {
+  uint8_t  effective;
+  uint8_t  pending;
+  bool     cancelLatched;
+  bool     bandTiming;       // band change being confirmed
+  bool     graceTiming;      // Low/Critical grace running
+  uint32_t bandAgeMs;
+  uint32_t graceAgeMs;
+};
+
+struct Block {
+  NVS::Snapshot                          cfg;
+  PowerBand                              band;
+  transport::TransportPort::ResumeState  transport;
+  bool                                   hasTransport;
+  bool                                   hasJournal;
+  FlashJournal::Cursor                   journal;
+  uint32_t                               journalSeq;   // EspNowManager seq_
+  PowerManager::GaugeSnapshot            gauge;
+};
+
+// Once, after BootTrace::begin() and NVS::Init(), before CONF->begin().
+// true = warm wake.
+bool begin();
+
+// Restored block, nullptr after a cold boot (or once stage() was called).
+const Block* get();
+
+// Zeroed RTC block to fill before capture(); invalidates the old one.
+Block& stage();
+
+// Seal stage(); call last before esp_deep_sleep_start().
+void capture();
+
+}  // namespace WarmState
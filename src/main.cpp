@@ -1,29 +1,31 @@
 #include <Device.hpp>
-#include <Logger.hpp>
+#include <BootTrace.hpp>
 #include <NVSManager.hpp>
-#include <RTCManager.hpp>
 #include <RGBLed.hpp>
 #include <Utils.hpp>
+#include <WarmState.hpp>
 #include <FreeRTOS.h>
 #include <task.h>
 
 Device device;
 
+// Stage 0 only: config, radio, transport and the wake report. SPIFFS/logger,
+// fingerprint, LED task (and the gauge on a warm wake) start from
+// Device::loop(), one per pass (BootTrace.hpp).
 void setup() {
+    BootTrace::begin();  // latch the wake cause first
     Debug::begin(SERIAL_BAUD_RATE);
-    delay(3000);
+    if (!BootTrace::isSleepWake()) delay(BOOT_SERIAL_WAIT_MS);
     NVS::Init();         // guarantees singleton exists
+    WarmState::begin();  // deep-sleep wake: seeds the config cache from RTC memory
     CONF->begin();       // safe: Get() always returns a valid pointer
+    BootTrace::mark(BootTrace::Phase::Config);
+#if NVS_BENCH
+    CONF->benchReads();
+#endif
 
-    // RTC + Logger come up after config, before RGB
-    static struct tm timeInfo{};
-    RTCManager::Init(&timeInfo);
-    Logger::Init(RTCM);
-    LOGG->Begin();
-
+    // Pins only; the LED task starts with the deferred stages
     RGBLed::Init(LOWBAT_LED_PIN, DATA_FLAG_LED_PIN, BLE_FLAG_LED_PIN, false);
-    RGB->begin();
-    RGB->setDeviceState(DeviceState::BOOT);
 
     device.begin();
 }
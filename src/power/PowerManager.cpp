@@ -314,6 +314,27 @@ float PowerManager::getBatteryPercentage() {
     return out;
 }
 
+void PowerManager::exportSnapshot(GaugeSnapshot& out) const {
+    lock_();
+    out.pct      = batteryPercentage;
+    out.voltage  = batteryVoltage;
+    out.mode     = static_cast<uint8_t>(currentMode);
+    out.charging = isCharging;
+    unlock_();
+}
+
+// Only the "last known" fields: getBatteryPercentage() keeps them until a
+// gauge read succeeds, and BattInfo still comes from the gauge itself.
+void PowerManager::seedSnapshot(const GaugeSnapshot& in) {
+    if (isnan(in.pct) || in.pct < 0.0f || in.pct > 100.0f) return;
+    lock_();
+    batteryPercentage = in.pct;
+    batteryVoltage    = in.voltage;
+    currentMode       = static_cast<PowerMode>(in.mode);
+    isCharging        = in.charging;
+    unlock_();
+}
+
 PowerMode PowerManager::getPowerMode() {
     lock_(); PowerMode m = currentMode; unlock_(); return m;
 }
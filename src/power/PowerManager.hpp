@@ -82,6 +82,17 @@ public:
     // NO I2C: returns latest cached gauge snapshot, also caches it locally.
     bool getBatteryInfo(MAX17055::BattInfo& infoOut) const;
 
+    // Last reading kept across deep sleep (WarmState). Seeded before begin(),
+    // it is what a warm wake reports until the gauge delivers a fresh sample.
+    struct GaugeSnapshot {
+        float   pct;
+        float   voltage;
+        uint8_t mode;        // PowerMode
+        bool    charging;
+    };
+    void exportSnapshot(GaugeSnapshot& out) const;
+    void seedSnapshot(const GaugeSnapshot& in);
+
     // State (public for quick access/telemetry)
     PowerMode   currentMode;
     float       batteryVoltage;     // FYI only (display), not used for % mode logic
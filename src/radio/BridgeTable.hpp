@@ -0,0 +1,129 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#pragma once
+/**
+ * @file BridgeTable.h
+ * @brief Transport -> CommandAPI translation table (legacy wire).
+ *
+ * One row per (module, op) the slave sends toward the master; the bridge in
+ * ESPNOWManager_events.cpp turns it into the ACK_* / EVT_* response. Shared
+ * with ESPNOWManager_cmd.cpp so the command table can check at compile time
+ * that every forwarded command has an answer here.
+ */
+
+#include <Arduino.h>
+#include <CommandAPI.hpp>
+#include <Transport.hpp>
+
+namespace bridge {
+using transport::Module;
+
+// How a (module, op) pair becomes a CommandAPI response.
+enum class Xlate : uint8_t {
+  Status,       // ack, ok = status byte
+  StatusPick,   // status OK ? ack : alt
+  EventOk,      // ack, ok = true
+  EventFail,    // ack, ok = false
+  Flag,         // pl[1] != 0 ? ack : alt, ok = flag
+  ReasonOk,     // ack, ok = (no payload || pl[0] == 0)
+  Byte0Event,   // ack carrying pl[0] when present, ok = false
+  Copy,         // ack carrying pl[off .. off+len), ok = status
+  CopyEvent,    // ack carrying pl[off .. off+len), ok = false
+  Special,      // needs manager state or reshaping (see translateSpecial_)
+};
+
+struct XlateEntry {
+  uint16_t key;    // module << 8 | op
+  Xlate    kind;
+  uint16_t ack;
+  uint16_t alt;
+  uint8_t  off;
+  uint8_t  len;
+};
+
+constexpr uint16_t xkey(Module m, uint8_t op) {
+  return static_cast<uint16_t>((static_cast<uint16_t>(m) << 8) | op);
+}
+
+// Sorted by key (checked below); looked up by binary search.
+inline constexpr XlateEntry kXlate[] = {
+  // ---------- Device ----------
+  {xkey(Module::Device, 0x01), Xlate::Status,     ACK_TEST_MODE,       0, 0, 0}, // ConfigMode
+  {xkey(Module::Device, 0x02), Xlate::Special,    ACK_STATE,           0, 0, 0}, // StateQuery resp
+  {xkey(Module::Device, 0x03), Xlate::Flag,       ACK_CONFIGURED, ACK_NOT_CONFIGURED, 0, 0}, // ConfigStatus
+  {xkey(Module::Device, 0x04), Xlate::Status,     ACK_ARMED,           0, 0, 0},
+  {xkey(Module::Device, 0x05), Xlate::Status,     ACK_DISARMED,        0, 0, 0},
+  {xkey(Module::Device, 0x07), Xlate::Status,     ACK_CAP_SET,         0, 0, 0}, // CapsSet
+  {xkey(Module::Device, 0x08), Xlate::Special,    ACK_CAPS,            0, 0, 0}, // CapsQuery
+  {xkey(Module::Device, 0x09), Xlate::Special,    ACK_STATE,           0, 0, 0}, // StateReport event
+  {xkey(Module::Device, 0x0B), Xlate::Flag,       ACK_CONFIGURED, ACK_NOT_CONFIGURED, 0, 0}, // PairingStatus
+  {xkey(Module::Device, 0x0C), Xlate::Special,    ACK_CAP_SET,         0, 0, 0}, // NvsWrite
+  {xkey(Module::Device, 0x0D), Xlate::Special,    ACK_HEARTBEAT,       0, 0, 0}, // Heartbeat
+  {xkey(Module::Device, 0x0E), Xlate::EventFail,  EVT_GENERIC,         0, 0, 0}, // UnlockRequest
+  {xkey(Module::Device, 0x0F), Xlate::Special,    EVT_BREACH,  EVT_MTRTTRG, 0, 0}, // AlarmRequest
+  {xkey(Module::Device, 0x10), Xlate::EventOk,    ACK_DRIVER_FAR,      0, 0, 0},
+  {xkey(Module::Device, 0x11), Xlate::ReasonOk,   ACK_LOCK_CANCELED,   0, 0, 0},
+  {xkey(Module::Device, 0x12), Xlate::ReasonOk,   ACK_ALARM_ONLY_MODE, 0, 0, 0},
+  {xkey(Module::Device, 0x14), Xlate::EventFail,  EVT_CRITICAL,        0, 0, 0}, // CriticalPower
+  {xkey(Module::Device, 0x15), Xlate::Status,     ACK_TMR_CANCELLED,   0, 0, 0},
+  {xkey(Module::Device, 0x16), Xlate::Status,     ACK_ROLE,            0, 0, 0},
+  {xkey(Module::Device, 0x17), Xlate::Special,    ACK_HEARTBEAT,       0, 0, 0}, // Ping
+  {xkey(Module::Device, 0x19), Xlate::Copy,       ACK_LINK_STATS,      0, 1,
+                                                  sizeof(AckLinkStatsPayload)},
+  {xkey(Module::Device, 0x1B), Xlate::CopyEvent,  EVT_WAKE,            0, 0, 3}, // WakeReport
+  // ---------- Motor ----------
+  {xkey(Module::Motor, 0x01),  Xlate::Special,    ACK_LOCK_CANCELED,   0, 0, 0}, // Lock resp
+  {xkey(Module::Motor, 0x02),  Xlate::Special,    ACK_LOCK_CANCELED,   0, 0, 0}, // Unlock resp
+  {xkey(Module::Motor, 0x05),  Xlate::Special,    ACK_LOCKED, ACK_UNLOCKED, 0, 0}, // MotorDone
+  // ---------- Shock ----------
+  {xkey(Module::Shock, 0x03),  Xlate::EventFail,  EVT_MTRTTRG,         0, 0, 0}, // Trigger
+  {xkey(Module::Shock, 0x10),  Xlate::Special,    ACK_SHOCK_SENSOR_TYPE_SET, ACK_SHOCK_INT_MISSING, 0, 0},
+  {xkey(Module::Shock, 0x11),  Xlate::Status,     ACK_SHOCK_SENS_THRESHOLD_SET, 0, 0, 0},
+  {xkey(Module::Shock, 0x12),  Xlate::Status,     ACK_SHOCK_L2D_CFG_SET, 0, 0, 0},
+  // ---------- Switch/Reed ----------
+  {xkey(Module::SwitchReed, 0x01), Xlate::Special, EVT_REED,           0, 0, 0}, // DoorEdge
+  {xkey(Module::SwitchReed, 0x02), Xlate::EventFail, EVT_GENERIC,      0, 0, 0}, // OpenRequest
+  // ---------- Fingerprint ----------
+  {xkey(Module::Fingerprint, 0x01), Xlate::Status,     ACK_FP_VERIFY_ON,  0, 0, 0},
+  {xkey(Module::Fingerprint, 0x02), Xlate::Status,     ACK_FP_VERIFY_OFF, 0, 0, 0},
+  {xkey(Module::Fingerprint, 0x04), Xlate::Copy,       ACK_FP_ID_DELETED, 0, 1, 2},
+  {xkey(Module::Fingerprint, 0x05), Xlate::Status,     ACK_FP_DB_CLEARED, 0, 0, 0},
+  {xkey(Module::Fingerprint, 0x06), Xlate::Copy,       ACK_FP_DB_INFO,    0, 1, 4},
+  {xkey(Module::Fingerprint, 0x07), Xlate::Copy,       ACK_FP_NEXT_ID,    0, 1, 2},
+  {xkey(Module::Fingerprint, 0x08), Xlate::StatusPick, ACK_FP_ADOPT_OK,   ACK_FP_ADOPT_FAIL,   0, 0},
+  {xkey(Module::Fingerprint, 0x09), Xlate::StatusPick, ACK_FP_RELEASE_OK, ACK_FP_RELEASE_FAIL, 0, 0},
+  {xkey(Module::Fingerprint, 0x0A), Xlate::CopyEvent,  EVT_FP_MATCH,      0, 0, 3},
+  {xkey(Module::Fingerprint, 0x0B), Xlate::Special,    EVT_FP_FAIL,       0, 0, 0}, // Fail/busy/...
+  {xkey(Module::Fingerprint, 0x0C), Xlate::Special,    0,                 0, 0, 0}, // EnrollProgress
+  // ---------- Power ----------
+  {xkey(Module::Power, 0x02),  Xlate::Byte0Event, EVT_LWBT,            0, 0, 0}, // LowBatt
+  {xkey(Module::Power, 0x03),  Xlate::Byte0Event, EVT_CRITICAL,        0, 0, 0}, // CriticalBatt
+};
+inline constexpr size_t kXlateCount = sizeof(kXlate) / sizeof(kXlate[0]);
+
+constexpr bool xlateSorted() {
+  for (size_t i = 1; i < kXlateCount; ++i) {
+    if (kXlate[i - 1].key >= kXlate[i].key) return false;
+  }
+  return true;
+}
+static_assert(xlateSorted(), "kXlate must be sorted by key without duplicates");
+
+constexpr const XlateEntry* findXlate(uint16_t key) {
+  size_t lo = 0;
+  size_t hi = kXlateCount;
+  while (lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    if (kXlate[mid].key < key) lo = mid + 1;
+    else                       hi = mid;
+  }
+  return (lo < kXlateCount && kXlate[lo].key == key) ? &kXlate[lo] : nullptr;
+}
+
+}  // namespace bridge
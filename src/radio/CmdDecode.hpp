@@ -0,0 +1,270 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#pragma once
+/**
+ * @file CmdDecode.h
+ * @brief CommandAPI opcode descriptors and the pure CMD decoder.
+ *
+ * One row per CommandAPI opcode; decodeCmd() looks the opcode up, checks
+ * role and length and builds the transport payload, touching no manager
+ * state. EspNowManager::ProcessComand() applies the result (hooks, inject,
+ * local handler, ACK). Header-only so host tests can fuzz it.
+ */
+
+#include <Arduino.h>
+#include <BridgeTable.hpp>
+#include <CommandAPI.hpp>
+#include <Transport.hpp>
+
+#ifndef ESPNOW_CMD_STRICT_LEN
+#define ESPNOW_CMD_STRICT_LEN        0         // 1 = reject CMD payloads longer than the descriptor allows
+#endif
+#define ESPNOW_CMD_MAX_ARGS          16        // largest transport payload built from a CMD (L2D cfg = 11)
+
+namespace cmd {
+using transport::Module;
+
+// Transport rows are forwarded to the module handler and answered by the
+// bridge table (BridgeTable.hpp), so they carry no ACK here; Local rows are
+// answered on the ESP-NOW edge by runLocalCmd_() with `ack`.
+enum class CmdRoute : uint8_t { Transport, Local };
+
+// How the CMD payload becomes the transport payload.
+enum class CmdArgs : uint8_t {
+  None,        // nothing forwarded
+  Copy,        // payload[0 .. minLen) as is
+  ByteOrZero,  // one byte, 0 when absent
+  CapBits,     // CMD_CAP_* edit of the current capability bits
+  EmagKey,     // NvsWrite {keyId 7 = LOCK_EMAG_KEY, arg}
+};
+
+// Side effect before forwarding (state the bridge needs for the answer).
+enum class CmdHook : uint8_t {
+  None,
+  ForceAck,    // pendingForceAck_ = arg (0 plain, 1 force lock, 2 force unlock)
+  LockEmag,    // pendingLockEmag_ = arg
+  TestMode,    // setConfigMode(true)
+};
+
+constexpr uint8_t kCmdLockRole   = 0x01;   // lock role only: alarm role gets ACK_ERR_POLICY
+constexpr uint8_t kCmdEventReply = 0x02;   // answered by a later event (StateReport, EnrollProgress)
+
+struct CmdDesc {
+  uint16_t opcode;
+  CmdRoute route;
+  Module   module;
+  uint8_t  op;
+  CmdArgs  args;
+  uint8_t  minLen;
+  uint8_t  maxLen;
+  uint16_t ack;     // Local rows only
+  uint8_t  flags;
+  CmdHook  hook;
+  uint8_t  arg;
+};
+
+#define CMD_T(opc, mod, o, a, mn, mx, fl, hk, ag) \
+  {opc, CmdRoute::Transport, Module::mod, o, CmdArgs::a, mn, mx, 0, fl, CmdHook::hk, ag}
+#define CMD_L(opc, mn, mx, ak, fl) \
+  {opc, CmdRoute::Local, Module::Device, 0, CmdArgs::None, mn, mx, ak, fl, CmdHook::None, 0}
+
+constexpr CmdDesc kCmds[] = {
+  // ---------- Motor (lock role) ----------
+  CMD_T(CMD_LOCK_SCREW,   Motor, 0x01, None, 0, 0, kCmdLockRole, ForceAck, 0),
+  CMD_T(CMD_UNLOCK_SCREW, Motor, 0x02, None, 0, 0, kCmdLockRole, ForceAck, 0),
+  CMD_T(CMD_FORCE_LOCK,   Motor, 0x01, None, 0, 0, kCmdLockRole, ForceAck, 1),
+  CMD_T(CMD_FORCE_UNLOCK, Motor, 0x02, None, 0, 0, kCmdLockRole, ForceAck, 2),
+  // ---------- Device ----------
+  CMD_T(CMD_ARM_SYSTEM,      Device, 0x04, None,       0, 0, 0,            None,     0),
+  CMD_T(CMD_DISARM_SYSTEM,   Device, 0x05, None,       0, 0, 0,            None,     0),
+  CMD_T(CMD_ENTER_TEST_MODE, Device, 0x01, None,       0, 0, 0,            TestMode, 0),
+  CMD_T(CMD_SET_ROLE,        Device, 0x16, ByteOrZero, 0, 1, 0,            None,     0),
+  CMD_T(CMD_CANCEL_TIMERS,   Device, 0x15, None,       0, 0, 0,            None,     0),
+  CMD_T(CMD_LINK_STATS,      Device, 0x19, None,       0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_OPEN_ON,     Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_OPEN_OFF,    Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_SHOCK_ON,    Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_SHOCK_OFF,   Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_REED_ON,     Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_REED_OFF,    Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_FP_ON,       Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_CAP_FP_OFF,      Device, 0x07, CapBits,    0, 0, 0,            None,     0),
+  CMD_T(CMD_LOCK_EMAG_ON,    Device, 0x0C, EmagKey,    0, 0, kCmdLockRole, LockEmag, 1),
+  CMD_T(CMD_LOCK_EMAG_OFF,   Device, 0x0C, EmagKey,    0, 0, kCmdLockRole, LockEmag, 0),
+  // ---------- Shock ----------
+  CMD_T(CMD_ENABLE_MOTION,            Shock, 0x01, None, 0,  0,  kCmdEventReply, None, 0),
+  CMD_T(CMD_DISABLE_MOTION,           Shock, 0x02, None, 0,  0,  kCmdEventReply, None, 0),
+  CMD_T(CMD_SET_SHOCK_SENSOR_TYPE,    Shock, 0x10, Copy, 1,  1,  0,              None, 0),
+  CMD_T(CMD_SET_SHOCK_SENS_THRESHOLD, Shock, 0x11, Copy, 1,  1,  0,              None, 0),
+  CMD_T(CMD_SET_SHOCK_L2D_CFG,        Shock, 0x12, Copy, 11, 11, 0,              None, 0),
+  // ---------- Fingerprint (lock role) ----------
+  CMD_T(CMD_FP_VERIFY_ON,       Fingerprint, 0x01, None, 0, 0, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_FP_VERIFY_OFF,      Fingerprint, 0x02, None, 0, 0, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_ENROLL_FINGERPRINT, Fingerprint, 0x03, Copy, 2, 2, kCmdLockRole | kCmdEventReply, None, 0),
+  CMD_T(CMD_FP_DELETE_ID,       Fingerprint, 0x04, Copy, 2, 2, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_FP_CLEAR_DB,        Fingerprint, 0x05, None, 0, 0, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_FP_QUERY_DB,        Fingerprint, 0x06, None, 0, 0, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_FP_NEXT_ID,         Fingerprint, 0x07, None, 0, 0, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_FP_ADOPT_SENSOR,    Fingerprint, 0x08, None, 0, 0, kCmdLockRole,                  None, 0),
+  CMD_T(CMD_FP_RELEASE_SENSOR,  Fingerprint, 0x09, None, 0, 0, kCmdLockRole,                  None, 0),
+  // ---------- Local (ESP-NOW edge) ----------
+  CMD_L(CMD_REBOOT,          0, 0, ACK_REBOOT,         0),
+  CMD_L(CMD_SET_CHANNEL,     1, 1, ACK_SET_CHANNEL,    0),
+  CMD_L(CMD_REMOVE_SLAVE,    0, 0, ACK_REMOVED,        0),
+  CMD_L(CMD_FACTORY_RESET,   0, 0, ACK_FACTORY_RESET,  0),
+  CMD_L(CMD_STATE_QUERY,     0, 0, ACK_STATE,          0),
+  CMD_L(CMD_HEARTBEAT_REQ,   0, 0, ACK_HEARTBEAT,      0),
+  CMD_L(CMD_CONFIG_STATUS,   0, 0, ACK_CONFIGURED,     0),
+  CMD_L(CMD_BATTERY_LEVEL,   0, 0, EVT_BATTERY_PREFIX, 0),
+  CMD_L(CMD_CLEAR_ALARM,     0, 0, ACK_ALARM_CLEARED,  0),
+  CMD_L(CMD_CAPS_QUERY,      0, 0, ACK_CAPS,           0),
+  CMD_L(CMD_SYNC_REQ,        0, 0, ACK_SYNCED,         0),
+};
+#undef CMD_T
+#undef CMD_L
+constexpr size_t kCmdCount = sizeof(kCmds) / sizeof(kCmds[0]);
+
+// opcode -> kCmds index + 1 (0 = unknown), built at compile time.
+struct CmdIndex {
+  uint8_t slot[256] = {};
+};
+
+constexpr CmdIndex makeCmdIndex() {
+  CmdIndex out{};
+  for (size_t i = 0; i < kCmdCount; ++i) out.slot[kCmds[i].opcode & 0xFF] = uint8_t(i + 1);
+  return out;
+}
+inline constexpr CmdIndex kCmdIndex = makeCmdIndex();
+
+static_assert(kCmdCount < 255, "kCmdIndex stores uint8_t indices");
+
+constexpr bool cmdTableValid() {
+  for (size_t i = 0; i < kCmdCount; ++i) {
+    const CmdDesc& d = kCmds[i];
+    if (d.opcode > 0xFF) return false;                         // index is one byte wide
+    if (kCmdIndex.slot[d.opcode] != i + 1) return false;       // duplicate opcode
+    if (d.minLen > d.maxLen) return false;
+    if (d.args == CmdArgs::Copy && (d.minLen == 0 || d.minLen != d.maxLen)) return false;
+    if (d.args == CmdArgs::ByteOrZero && d.maxLen != 1) return false;
+    if (d.route == CmdRoute::Transport && d.maxLen > ESPNOW_CMD_MAX_ARGS) return false;
+  }
+  return true;
+}
+static_assert(cmdTableValid(), "kCmds: duplicate/out-of-range opcode or inconsistent length schema");
+
+// Every forwarded command has exactly one answer: a bridge row for its
+// (module, op), or the event named by kCmdEventReply.
+constexpr bool cmdRepliesBridged() {
+  for (size_t i = 0; i < kCmdCount; ++i) {
+    const CmdDesc& d = kCmds[i];
+    if (d.route != CmdRoute::Transport) continue;
+    const bool bridged = bridge::findXlate(bridge::xkey(d.module, d.op)) != nullptr;
+    if (bridged == ((d.flags & kCmdEventReply) != 0)) return false;
+  }
+  return true;
+}
+static_assert(cmdRepliesBridged(), "kCmds: transport row without a BridgeTable answer (or kCmdEventReply on a bridged one)");
+
+inline const CmdDesc* findCmd(uint16_t opcode) {
+  if (opcode > 0xFF) return nullptr;
+  const uint8_t s = kCmdIndex.slot[opcode];
+  return s ? &kCmds[s - 1] : nullptr;
+}
+
+// Capability bits mapping: bit0=Open, bit1=Shock, bit2=Reed, bit3=FP.
+inline uint8_t capBitsFromCmd(uint16_t opcode, uint8_t currentBits) {
+  uint8_t bits = currentBits;
+  auto setBit = [&bits](uint8_t b, bool on) {
+    if (on) bits |= (1u << b);
+    else    bits &= ~(1u << b);
+  };
+  if (opcode == CMD_CAP_OPEN_ON)  setBit(0, true);
+  if (opcode == CMD_CAP_OPEN_OFF) setBit(0, false);
+  if (opcode == CMD_CAP_SHOCK_ON) setBit(1, true);
+  if (opcode == CMD_CAP_SHOCK_OFF)setBit(1, false);
+  if (opcode == CMD_CAP_REED_ON)  setBit(2, true);
+  if (opcode == CMD_CAP_REED_OFF) setBit(2, false);
+  if (opcode == CMD_CAP_FP_ON)    setBit(3, true);
+  if (opcode == CMD_CAP_FP_OFF)   setBit(3, false);
+  return bits;
+}
+
+// ---------- Decoder ----------
+enum class CmdVerdict : uint8_t {
+  Ok,        // run it: forward args (Transport) or runLocalCmd_() (Local)
+  Unknown,   // no row: ACK_UNINTENDED
+  Policy,    // lock-role command on the alarm role: ACK_ERR_POLICY
+  BadLen,    // payload shorter than minLen (or longer, when strict): ACK_UNINTENDED
+};
+
+// What the decoder needs to know about the device; nothing else is read.
+struct CmdContext {
+  bool    alarmRole = false;   // IS_SLAVE_ALARM
+  uint8_t capBits   = 0;       // current CMD_CAP_* bits (CapBits rows)
+};
+
+struct CmdDecoded {
+  const CmdDesc* desc = nullptr;     // set unless Unknown
+  CmdVerdict     verdict = CmdVerdict::Unknown;
+  uint8_t        len = 0;            // payload bytes the command uses (trimmed to maxLen)
+  uint8_t        n   = 0;            // transport payload bytes in args
+  uint8_t        args[ESPNOW_CMD_MAX_ARGS];
+};
+
+// Reads at most min(len, desc->maxLen) bytes of payload; a null payload
+// counts as empty.
+inline CmdDecoded decodeCmd(uint16_t opcode, const uint8_t* payload, size_t len,
+                            const CmdContext& ctx) {
+  CmdDecoded out;
+  out.desc = findCmd(opcode);
+  const CmdDesc* d = out.desc;
+  if (!d) return out;
+  if ((d->flags & kCmdLockRole) && ctx.alarmRole) {
+    out.verdict = CmdVerdict::Policy;
+    return out;
+  }
+  if (!payload) len = 0;
+  if (len < d->minLen) {
+    out.verdict = CmdVerdict::BadLen;
+    return out;
+  }
+  if (len > d->maxLen) {
+#if ESPNOW_CMD_STRICT_LEN
+    out.verdict = CmdVerdict::BadLen;
+    return out;
+#else
+    len = d->maxLen;   // trailing bytes were always ignored
+#endif
+  }
+  out.len = static_cast<uint8_t>(len);
+  out.verdict = CmdVerdict::Ok;
+  if (d->route == CmdRoute::Local) return out;
+
+  switch (d->args) {
+    case CmdArgs::None:
+      break;
+    case CmdArgs::Copy:
+      memcpy(out.args, payload, d->minLen);
+      out.n = d->minLen;
+      break;
+    case CmdArgs::ByteOrZero:
+      out.args[out.n++] = len ? payload[0] : 0;
+      break;
+    case CmdArgs::CapBits:
+      out.args[out.n++] = capBitsFromCmd(opcode, ctx.capBits);
+      break;
+    case CmdArgs::EmagKey:
+      out.args[out.n++] = 7u;   // LOCK_EMAG_KEY
+      out.args[out.n++] = d->arg;
+      break;
+  }
+  return out;
+}
+
+} // namespace cmd
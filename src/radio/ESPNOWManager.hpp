@@ -13,9 +13,13 @@
 #include <CommandAPI.hpp>
 #include <Config.hpp>
 #include <ConfigNvs.hpp>
+#include <ConfigRegistry.hpp>
 #include <Transport.hpp>
+#include <JournalCodec.hpp>
+#include <FlashJournal.hpp>
 #include <esp_err.h>
 #include <esp_now.h>
+#include <esp_wifi.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/task.h>
@@ -36,17 +40,87 @@ class TransportManager;
 #define ESPNOW_MAX_DATA_LEN          250
 
 // ---------- Queues & Worker ----------
-#define ESPNOW_RX_QUEUE_SIZE         32
-#define ESPNOW_TX_QUEUE_SIZE         32
+#define ESPNOW_RX_QUEUE_SIZE         32        // RX slab slots (queues carry 1-byte indices)
+#ifndef ESPNOW_SLAB_IN_PSRAM
+#define ESPNOW_SLAB_IN_PSRAM         0         // 1 = RX slab in PSRAM when present (DRAM fallback)
+#endif
+#define ESPNOW_TX_QUEUE_SIZE         32        // TX slot pool (frames built in place)
+#ifndef ESPNOW_TX_MAX_INFLIGHT
+#define ESPNOW_TX_MAX_INFLIGHT       4         // frames handed to ESP-NOW awaiting onDataSent
+#endif
 #undef  ESPNOW_WORKER_STACK
 #define ESPNOW_WORKER_STACK          6144      // extra headroom for worker tasks
 #define ESPNOW_WORKER_PRIO           3
 #define ESPNOW_WORKER_CORE           APP_CPU_NUM
+#ifndef ESPNOW_WORKER_IDLE_MS
+#define ESPNOW_WORKER_IDLE_MS        1000      // longest block with no event/deadline
+#endif
+#ifndef ESPNOW_TX_RETRY_MS
+#define ESPNOW_TX_RETRY_MS           2         // re-pump after an immediate send failure
+#endif
+#ifndef ESPNOW_JOURNAL_MAX_BYTES
+#define ESPNOW_JOURNAL_MAX_BYTES     1024      // binary journal (RAM + NVS blob); oldest dropped when full
+#endif
+#ifndef ESPNOW_JOURNAL_FLASH
+#define ESPNOW_JOURNAL_FLASH         1         // 1 = persist to the "journal" partition when present
+#endif
+#ifndef ESPNOW_JOURNAL_QUEUE
+#define ESPNOW_JOURNAL_QUEUE         8         // offline events waiting for the worker to spool them
+#endif
+#ifndef ESPNOW_JOURNAL_SLOT_WAIT_MS
+#define ESPNOW_JOURNAL_SLOT_WAIT_MS  50        // replay: max wait for a free TX slot per frame
+#endif
+#ifndef ESPNOW_JOURNAL_DELIVERY_MS
+#define ESPNOW_JOURNAL_DELIVERY_MS   1000      // flash replay: max wait for delivery before the ack
+#endif
+// Airtime estimate for journal stats: 1 Mbps, long preamble, ~43 B of
+// 802.11 action-frame + vendor IE overhead around the ESP-NOW payload.
+#define ESPNOW_AIR_PREAMBLE_US       192
+#define ESPNOW_AIR_OVERHEAD_BYTES    43
+#ifndef ESPNOW_SLEEP_MIN_BLOCK_MS
+#define ESPNOW_SLEEP_MIN_BLOCK_MS    3         // blocks this long count as light-sleep capable
+#endif
 
 // ---------- Timing ----------
 #define HB_INTERVAL_MS               15000UL   // Heartbeat interval
 #define STATE_MIN_INTERVAL_MS        120000UL  // Min interval between state reports
-#define PING_INTERVAL_MS  30000UL   // one ping every 30s (no retry bursts)
+
+// ---------- Presence ----------
+// Any frame from a master or delivery report to one counts as presence, so a
+// busy link never needs a check; the worker only wakes once the link has been
+// quiet for PRESENCE_TIMEOUT_MS.
+#ifndef PRESENCE_TIMEOUT_MS
+#define PRESENCE_TIMEOUT_MS          60000UL   // quiet this long -> offline
+#endif
+#ifndef PRESENCE_FAIL_STREAK
+#define PRESENCE_FAIL_STREAK         5         // consecutive failed reports -> offline now
+#endif
+#ifndef PRESENCE_BACKOFF_MIN_MS
+#define PRESENCE_BACKOFF_MIN_MS      10000UL   // first offline probe
+#endif
+#ifndef PRESENCE_BACKOFF_MAX_MS
+#define PRESENCE_BACKOFF_MAX_MS      300000UL  // probe interval cap while offline
+#endif
+#ifndef PRESENCE_OFFLINE_PROBE
+#define PRESENCE_OFFLINE_PROBE       1         // 1 = send ACK_HEARTBEAT probes while offline
+#endif
+#define ESPNOW_RTT_BUCKETS           6         // <1, <2, <5, <10, <20, >=20 ms
+
+// ---------- Link Telemetry / Channel Rescan ----------
+#ifndef ESPNOW_RSSI_CAPTURE
+#define ESPNOW_RSSI_CAPTURE          1         // promiscuous (mgmt-only) RX for per-frame RSSI
+#endif
+#define ESPNOW_RSSI_WINDOW           16        // rolling RSSI samples
+#ifndef ESPNOW_RESCAN_FAIL_STREAK
+#define ESPNOW_RESCAN_FAIL_STREAK    12        // failed reports (offline) before re-discovery
+#endif
+#ifndef ESPNOW_RESCAN_DWELL_MS
+#define ESPNOW_RESCAN_DWELL_MS       80        // wait for a delivery report per channel
+#endif
+#ifndef ESPNOW_RESCAN_COOLDOWN_MS
+#define ESPNOW_RESCAN_COOLDOWN_MS    600000UL  // min gap between automatic rescans
+#endif
+#define ESPNOW_CHANNEL_MAX           13
 // ---------- Motor ACK Task ----------
 #undef  LOCK_ACK_TASK_STACK_SIZE
 #define LOCK_ACK_TASK_STACK_SIZE     4096      // ↑ extra stack for safety
@@ -90,11 +164,15 @@ public:
     esp_err_t deinit();
 
     // ---------- Peer Management ----------
-    esp_err_t registerPeer(const uint8_t* peer_addr, bool encrypt);
+    // lmk: link key for an encrypted peer; nullptr = the paired master's LMK.
+    esp_err_t registerPeer(const uint8_t* peer_addr, bool encrypt, const uint8_t* lmk = nullptr);
     esp_err_t unregisterPeer(const uint8_t* peer_addr);
 
     // ---------- Transmission ----------
     esp_err_t sendData(const uint8_t* peer_addr, const uint8_t* data, size_t len);
+    // One esp_now_send(NULL, ...) to every registered peer, queued in the TX
+    // slot pool so its per-peer delivery reports stay in order.
+    bool queueBroadcast(const uint8_t* data, size_t len);
 
     // ---------- Public API ----------
     void setInitMode(bool mode);
@@ -103,22 +181,157 @@ public:
     void storeMacAddress(const uint8_t* mac_addr);
     esp_err_t getMacAddress(uint8_t* mac_addr);
     bool compareMacAddress(const uint8_t* mac_addr);
+
+    // ---------- Master identity cache ----------
+    // Binary copy of the paired master's MAC/channel/LMK (and the standby
+    // master's), loaded from NVS on first use so the send/receive paths never
+    // parse NVS strings. Call invalidatePeerCache() after writing
+    // MASTER_ESPNOW_ID, MASTER_CHANNEL_KEY, MASTER_LMK_KEY or MASTER_STANDBY_*.
+    struct PeerIdentity {
+        bool    valid   = false;   // MAC present (paired)
+        uint8_t mac[6]  = {0};
+        uint8_t channel = 0;
+        bool    hasLmk  = false;
+        uint8_t lmk[16] = {0};
+        uint8_t wire    = 0;       // NOW_WIRE_* negotiated at pairing (MASTER_WIRE_KEY)
+    };
+    bool masterIdentity(PeerIdentity& out);
+    bool masterMac(uint8_t out[6]);          // false when no master is stored
+    bool standbyIdentity(PeerIdentity& out); // false when no standby is stored
+    void invalidatePeerCache();
     void ProcessComand(uint16_t opcode, const uint8_t* payload, size_t payloadLen);
 
     // ---------- TX Helpers ----------
-    void SendAck(uint16_t opcode, bool Status);
-    void SendAck(uint16_t opcode, const uint8_t* payload, size_t payloadLen, bool Status);
+    // false = not queued (unconfigured, no master MAC, TX pool full).
+    bool SendAck(uint16_t opcode, bool Status);
+    bool SendAck(uint16_t opcode, const uint8_t* payload, size_t payloadLen, bool Status);
     void RequestOff();
     void RequestUnlock();
     void SendMotionTrigg();
     void RequesAlarm();
 
-    // Bridge transport Responses/Events to CommandAPI response frames.
+    // Bridge transport Responses/Events to CommandAPI response frames
+    // (legacy masters; see nativeWire()).
     bool handleTransportTx(const transport::TransportMessage& msg);
+    // Journal a master-bound event sent while the master is offline
+    // (TransportPort TX tap). Any task; the worker does the spooling.
+    void journalOffline(const transport::TransportMessage& msg);
+    // NOW_WIRE_* bits agreed with the paired master (0 = CommandAPI only).
+    uint8_t wireCaps();
+    // True when the paired master accepts NOW_FRAME_TRANSPORT frames.
+    bool nativeWire();
+    // Queue a serialized transport frame for the master behind a
+    // NOW_FRAME_TRANSPORT byte (native wire mode).
+    bool queueTransport(const uint8_t* data, size_t len);
 
     // ---------- Utilities ----------
     bool parseMacToBytes(const String& macAddress, uint8_t out[6]);
 
+    // ---------- TX Stats ----------
+    struct TxStats {
+        uint32_t queued      = 0;  // responses placed in the slot pool
+        uint32_t sent        = 0;  // esp_now_send() accepted
+        uint32_t delivered   = 0;  // onDataSent success
+        uint32_t retries     = 0;  // callback or immediate failures requeued
+        uint32_t dropped     = 0;  // gave up after ESPNOW_TX_MAX_RETRY
+        uint32_t poolFull    = 0;  // SendAck() with no free slot
+        uint32_t inFlightMax = 0;  // high-water mark of outstanding frames
+        uint32_t peerLookupLastCycles = 0;  // destination resolve per pump pass
+        uint32_t peerLookupMaxCycles  = 0;
+        uint32_t peerCacheLoads       = 0;  // NVS reloads of the identity cache
+    };
+    const TxStats& txStats() const { return txStats_; }
+
+    // ---------- RX Stats ----------
+    struct RxStats {
+        uint32_t frames       = 0;  // frames handed to the worker
+        uint32_t drops        = 0;  // no free slab slot
+        uint32_t cbLastCycles = 0;  // onDataReceived cost (CPU cycles)
+        uint32_t cbMaxCycles  = 0;
+    };
+    const RxStats& rxStats() const { return rxStats_; }
+
+    // ---------- Command Decode Stats ----------
+    // ProcessComand(): descriptor lookup + validation + payload build, up to
+    // the hand-off to the transport stack or the local handler.
+    struct CmdStats {
+        uint32_t decoded          = 0;  // commands that passed validation
+        uint32_t unknown          = 0;  // opcode not in the descriptor table
+        uint32_t badLen           = 0;  // payload outside [minLen, maxLen]
+        uint32_t policy           = 0;  // lock-only command on the alarm role
+        uint32_t decodeLastCycles = 0;
+        uint32_t decodeMaxCycles  = 0;
+    };
+    const CmdStats& cmdStats() const { return cmdStats_; }
+
+    // ---------- Journal Replay Stats ----------
+    // What the last replays cost, next to what the one-NDJSON-line-per-
+    // EVT_GENERIC format would have cost for the same records.
+    struct JournalStats {
+        uint32_t records         = 0;  // records spooled
+        uint32_t dropped         = 0;  // oldest records evicted (buffer full)
+        uint32_t replayed        = 0;  // records replayed
+        uint32_t frames          = 0;  // frames actually sent
+        uint32_t bytes           = 0;  // ESP-NOW payload bytes actually sent
+        uint32_t airtimeUs       = 0;  // estimated
+        uint32_t ndjsonFrames    = 0;  // NDJSON equivalent
+        uint32_t ndjsonBytes     = 0;
+        uint32_t ndjsonAirtimeUs = 0;
+        uint32_t storeBytes      = 0;  // bytes written to flash/NVS for the journal
+        uint32_t nvsEquivBytes   = 0;  // what the coalesced NVS blob would have written
+    };
+    const JournalStats& journalStats() const { return journalStats_; }
+    const FlashJournal::Stats& flashJournalStats() const { return flashJournal_.stats(); }
+    // Ring cursor + seq for a warm-sleep snapshot (false = no flash journal).
+    bool journalCursor(FlashJournal::Cursor& out, uint32_t& seq);
+
+    // ---------- Worker Load ----------
+    // Updated once per ~1 s window. sleepPermille is the share of the window
+    // the worker spent blocked for >= ESPNOW_SLEEP_MIN_BLOCK_MS at a time,
+    // i.e. time in which it did not stand in the way of tickless light sleep.
+    struct WorkerStats {
+        uint32_t wakeups       = 0;  // loop passes
+        uint32_t timedWakes    = 0;  // passes woken by a deadline, not an event
+        uint32_t busyUsTotal   = 0;
+        uint16_t loadPermille  = 0;  // busy share of the last window
+        uint16_t sleepPermille = 0;  // sleep-capable share of the last window
+        uint32_t wakesLastWin  = 0;
+    };
+    const WorkerStats& workerStats() const { return workerStats_; }
+
+    // ---------- Link Quality ----------
+    // Master link as seen by the TX pool: delivery ratio and send -> delivery
+    // report time, plus RSSI of master frames over a rolling window.
+    // score = delivery% - 1 point per ms of RTT (max 20)
+    //                   - 1 point per dB of window RSSI below -80 dBm (max 20).
+    struct LinkQuality {
+        uint16_t deliveryPermille = 1000;  // EWMA (1/16) of delivery reports
+        uint32_t rttEwmaUs        = 0;     // EWMA (1/8) of send -> report
+        uint32_t rttHist[ESPNOW_RTT_BUCKETS] = {0};
+        uint8_t  score            = 100;   // 0..100
+        uint8_t  failStreak       = 0;     // consecutive failed reports (master RX resets it)
+        uint8_t  txFailStreak     = 0;     // failed reports since the last delivery (rescan)
+        uint32_t checks           = 0;     // presence deadlines reached
+        uint32_t probes           = 0;     // offline probes sent
+        uint32_t offlineEvents    = 0;
+        uint32_t onlineEvents     = 0;
+        int8_t   rssiLast         = 0;     // dBm, 0 = nothing captured yet
+        int8_t   rssiAvg          = 0;
+        int8_t   rssiMin          = 0;
+        int8_t   rssiMax          = 0;
+        uint32_t rssiSamples      = 0;
+        uint16_t rescans          = 0;     // channel re-discoveries started
+        uint16_t rescanFound      = 0;     // ... that found the master
+    };
+    const LinkQuality& linkQuality() const { return link_; }
+    void linkStatsPayload(AckLinkStatsPayload& out) const;
+
+    // Re-discover the master's channel: hop 1..13 (stored channel first),
+    // probe on each and keep the first one with a delivery report. Runs in
+    // the worker; false when one is already running or not configured.
+    bool requestChannelRescan();
+    bool rescanActive() const { return rescan_.active; }
+
     // ---------- ESPNOW Callbacks ----------
     static void onDataSent(const uint8_t* mac_addr, esp_now_send_status_t status);
     static void onDataReceived(const uint8_t* mac_addr, const uint8_t* data, int len);
@@ -141,29 +354,67 @@ public:
     // ---------- Master Requests ----------
     void sendHeartbeat(bool force = false);
     void sendState(const char* reason);
-    void attachTransport(TransportManager* mgr) { transport = mgr; }
+    // The worker builds the transport peer table on its next pass.
+    void attachTransport(TransportManager* mgr) { transport = mgr; wakeWorker_(); }
     inline bool isMasterOnline() const { return online_; }
 
 private:
     // ========================================================================
     //                         PRESENCE / WATCHDOG
     // ========================================================================
-    bool     online_ = true;
-    uint32_t nextPingDueMs_ = 0;
-    uint32_t pingBackoffMs_ = 10000;   // 10s -> doubled up to cap
+    volatile bool online_ = true;
+    volatile bool presenceRecovered_ = false;   // went online; worker flushes journal
+    uint32_t nextPingDueMs_ = 0;                // next presence check / offline probe
+    uint32_t pingBackoffMs_ = PRESENCE_BACKOFF_MIN_MS;   // doubled up to cap while offline
+    LinkQuality link_;
+
+    // RSSI window (written from the Wi-Fi task, guarded by linkMux_).
+    int8_t       rssiWin_[ESPNOW_RSSI_WINDOW] = {0};
+    uint8_t      rssiHead_  = 0;
+    uint8_t      rssiCount_ = 0;
+    portMUX_TYPE linkMux_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Channel re-discovery state machine (worker only, except `delivered`).
+    struct RescanState {
+        bool          active      = false;
+        volatile bool delivered   = false;   // set by a delivery report
+        bool          manual      = false;
+        uint8_t       order[ESPNOW_CHANNEL_MAX] = {0};
+        uint8_t       count       = 0;
+        uint8_t       idx         = 0;
+        uint8_t       origChannel = 0;
+        uint32_t      dwellStartMs = 0;
+        uint32_t      lastEndMs    = 0;
+        bool          everRan      = false;
+    };
+    RescanState rescan_;
 
     // ========================================================================
     //                             JOURNAL SYSTEM
     // ========================================================================
-    String   journalBuf_;
+    // Binary records (JournalCodec.hpp) after journalBaseSeq_; NVS keeps
+    // [base varint] + records as one blob.
+    uint8_t  journal_[ESPNOW_JOURNAL_MAX_BYTES];
+    uint16_t journalLen_     = 0;
+    uint32_t journalBaseSeq_ = 0;   // seq the first record's delta is relative to
+    uint32_t journalLastSeq_ = 0;   // seq of the newest record
+    JournalStats journalStats_;
     uint16_t journalCount_ = 0;
     uint32_t lastJournalSaveMs_ = 0;
     bool     needsFlush_ = false;
     bool     journalDegraded_ = false;
 
+    // Raw-partition ring; when ready() it is the store and journal_ only
+    // stages replays. nvsEquiv* emulate the NVS blob path for the stats.
+    FlashJournal flashJournal_;
+    uint32_t flashReadPos_  = FlashJournal::kFromOldest;   // staging cursor within a flush
+    uint32_t nvsEquivLen_   = 0;
+    uint16_t nvsEquivCount_ = 0;
+
     // NVS key names (must be short; keep ≤ 6 chars)
-    const char* nvsKeyBuf_ = "jb";   // journal buffer (NDJSON)
-    const char* nvsKeyCnt_ = "jc";   // journal line count (stringified int)
+    const char* nvsKeyBuf_ = "jr";   // journal blob (binary records)
+    const char* nvsKeyOld_ = "jb";   // pre-binary NDJSON buffer (removed on load)
+    const char* nvsKeyCnt_ = "jc";   // journal record count (stringified int)
     const char* nvsKeySeq_ = "js";   // last seq (stringified int)
 
     // Coalesce thresholds
@@ -179,17 +430,105 @@ private:
         uint8_t buf[ESPNOW_MAX_DATA_LEN];
     };
 
-    struct TxAckEvent {
+    // One outgoing frame. Built in place by SendAck() and moved between the
+    // index FIFOs below (free -> ready -> in flight -> free), never copied.
+    struct TxSlot {
         uint8_t  data[ESPNOW_MAX_DATA_LEN];
-        uint16_t len;
-        bool     status;
-        uint8_t  attempts;
+        uint16_t len      = 0;
+        bool     status   = false;
+        uint8_t  attempts = 0;
+        uint8_t  mac[6]   = {0};   // destination, matched in onDataSent
+        uint32_t sentUs   = 0;     // esp_now_send() time (RTT histogram)
+        bool     bcast    = false; // esp_now_send(NULL): one report per peer
+        bool     anyOk    = false; // broadcast reached at least one peer
+        uint16_t journalGen = 0;   // replay pass that queued it; 0 = not a journal frame
     };
 
-    QueueHandle_t rxQ    = nullptr;
-    QueueHandle_t txQ    = nullptr;
-    QueueHandle_t sendQ  = nullptr;
+    // Fixed FIFO of slot indices (guarded by sendMux_).
+    struct TxIndexFifo {
+        uint8_t idx[ESPNOW_TX_QUEUE_SIZE];
+        uint8_t head  = 0;
+        uint8_t count = 0;
+
+        bool push(uint8_t i) {
+            if (count >= ESPNOW_TX_QUEUE_SIZE) return false;
+            idx[(head + count) % ESPNOW_TX_QUEUE_SIZE] = i;
+            ++count;
+            return true;
+        }
+        bool pushFront(uint8_t i) {
+            if (count >= ESPNOW_TX_QUEUE_SIZE) return false;
+            head = (head + ESPNOW_TX_QUEUE_SIZE - 1) % ESPNOW_TX_QUEUE_SIZE;
+            idx[head] = i;
+            ++count;
+            return true;
+        }
+        bool pop(uint8_t& i) {
+            if (!count) return false;
+            i = idx[head];
+            head = (head + 1) % ESPNOW_TX_QUEUE_SIZE;
+            --count;
+            return true;
+        }
+        bool front(uint8_t& i) const {
+            if (!count) return false;
+            i = idx[head];
+            return true;
+        }
+        bool back(uint8_t& i) const {
+            if (!count) return false;
+            i = idx[(head + count - 1) % ESPNOW_TX_QUEUE_SIZE];
+            return true;
+        }
+        void popBack() { if (count) --count; }
+    };
+
+    // Offline event handed from journalOffline() to the worker.
+    struct JournalEvent {
+        uint8_t type;
+        uint8_t len;
+        uint8_t fields[FlashJournal::kFields];
+    };
+
+    // RX slab: onDataReceived copies the frame once into a free slot and
+    // passes its index to the worker, which returns it after processRx().
+    QueueHandle_t rxQ     = nullptr;   // ready slot indices (uint8_t)
+    QueueHandle_t rxFreeQ = nullptr;   // free slot indices (uint8_t)
+    QueueHandle_t journalQ_ = nullptr; // JournalEvent, drained by the worker
+    RxEvent*      rxSlab_ = nullptr;   // ESPNOW_RX_QUEUE_SIZE frames
+    bool          rxSlabPsram_ = false;
+    RxStats       rxStats_;
+    CmdStats      cmdStats_;
     TaskHandle_t  workerH = nullptr;
+    WorkerStats   workerStats_;
+    uint32_t      winStartUs_  = 0;   // WorkerStats window accumulators
+    uint32_t      winBusyUs_   = 0;
+    uint32_t      winSleepUs_  = 0;
+    uint32_t      winWakes_    = 0;
+
+    TxSlot      txSlots_[ESPNOW_TX_QUEUE_SIZE];
+    TxIndexFifo txFree_;
+    TxIndexFifo txReady_;
+    TxIndexFifo txInFlight_;      // oldest first; onDataSent completes the front
+    bool        txPumping_ = false;
+    // A failed frame being retried: the pipeline drops to one frame in
+    // flight until it completes, so nothing queued after it overtakes it.
+    bool        txHold_    = false;
+    uint8_t     txHoldIdx_ = 0;
+    uint8_t     txInFlightCap_() const { return txHold_ ? 1 : ESPNOW_TX_MAX_INFLIGHT; }
+    // The broadcast in flight (one at a time): the peers it went to and the
+    // ones whose report is still due. Reports from other MACs are not its own.
+    uint8_t     bcastPeers_[ESP_NOW_MAX_TOTAL_PEER_NUM][6] = {};
+    uint8_t     bcastPeerCount_ = 0;
+    uint32_t    bcastPending_   = 0;   // bit i = bcastPeers_[i] not reported yet
+    static_assert(ESP_NOW_MAX_TOTAL_PEER_NUM <= 32, "bcastPending_ is a 32-bit mask");
+    uint8_t     fetchPeers_(uint8_t (*out)[6]);
+    TxStats     txStats_;
+    // Journal frames of the current replay pass (journalGen_) still pending
+    // delivery, and whether one was dropped; the flash ack waits on them.
+    uint16_t    journalGen_      = 1;
+    uint8_t     journalInFlight_ = 0;
+    bool        journalLost_     = false;
 
     // ========================================================================
     //                              STATE TRACKING
@@ -197,29 +536,54 @@ private:
     uint32_t seq_           = 0;
     uint32_t lastHbMs_      = 0;
     uint32_t lastStateMs_   = 0;
-    bool     hasInFlight_   = false;
-    TxAckEvent inFlight_;
     uint8_t  capBitsShadow_ = 0;
     bool     capBitsShadowValid_ = false;
+    // DEVICE_CONFIGURED mirror, kept current by an NVS subscription (read per RX frame).
+    volatile bool configured_ = false;
     int8_t   pendingLockEmag_ = -1;
     uint8_t  pendingForceAck_ = 0;
 
     portMUX_TYPE sendMux_ = portMUX_INITIALIZER_UNLOCKED;
 
+    // Master identity cache (guarded by peerMux_; NVS is read outside it).
+    PeerIdentity peerCache_;
+    PeerIdentity standbyCache_;
+    bool         peerCacheLoaded_ = false;
+    uint32_t     peerCacheGen_    = 0;     // bumped by invalidatePeerCache()
+    portMUX_TYPE peerMux_ = portMUX_INITIALIZER_UNLOCKED;
+    void         loadPeerIdentity_(PeerIdentity& out, const char* macKey, const char* lmkKey);
+    bool         identity_(bool standby, PeerIdentity& out);
+
     // ========================================================================
     //                              INTERNAL HELPERS
     // ========================================================================
     static void workerTask(void* self);
+    void        wakeWorker_();
+    uint32_t    workerWaitMs_(uint32_t now);
+    uint32_t    pairingWaitMs_(uint32_t now) const;
+    void        noteWorkerPass_(uint32_t busyUs, uint32_t blockedUs, bool timed);
     void        processRx(const RxEvent& e);
-    void        doSendAck(const TxAckEvent& e);
 
+    bool        queueResponse_(uint16_t opcode, const uint8_t* payload, size_t payloadLen,
+                               bool status, bool urgent, bool journal = false);
+    bool        takeTxSlot_(uint8_t& idx);
+    void        readyTxSlot_(uint8_t idx, bool urgent);
     void        trySendNext_();
-    bool        sendAckNow_(const TxAckEvent& e);
+    bool        txIdle_();
 
     static uint8_t getDefaultChannel_();
     bool        isConfigured_() const;
+    static void onConfigChanged_(Cfg id, void* ctx);
     void        sendConfiguredBundle_(const char* reason);
     String      buildStateLine_(const char* reason);
+    void        sendStateRecord_(const uint8_t* rec, const char* reason);
+    void        runLocalCmd_(uint16_t opcode, const uint8_t* payload, size_t payloadLen,
+                             uint16_t ack);
+    void        noteCmdDecode_(uint32_t c0);
+    void        drainTxBeforeReset_();
+    void        clearPairing_();
+    bool        translateSpecial_(const transport::TransportMessage& msg,
+                                  uint16_t ack, uint16_t alt, bool statusOk);
     void        heartbeatTick_();
     uint8_t     getCapBits_();
     void        setCapBitsShadow_(uint8_t bits);
@@ -232,15 +596,43 @@ private:
                                  uint8_t* out, size_t* outLen);
 
     // Presence & Journal Helpers
-    bool        pingMaster(uint8_t tries);
+    void        presenceTick_(uint32_t now);
+    static void onPromiscRx_(void* buf, wifi_promiscuous_pkt_type_t type);
+    bool        isKnownMasterMac_(const uint8_t* mac);
+    void        noteRssi_(int8_t rssi);
+    void        updateLinkScore_();
+    void        startRescan_(bool manual);
+    void        rescanTick_(uint32_t now);
+    uint32_t    rescanWaitMs_(uint32_t now) const;
+    bool        applyChannel_(uint8_t channel);
+    void        markPresent_(uint32_t now);
+    void        noteDelivery_(bool ok, uint32_t rttUs);
     inline bool isOnline() const { return online_; }
-    inline void setOffline(bool v) { online_ = v; }
 
-    bool        spoolImportant_(const char* type, const String& json);
+    bool        spoolImportant_(journal::Type type, const uint8_t* fields = nullptr,
+                                uint8_t len = 0);
+    void        drainJournalQ_();
     void        nvLoadJournal_();
     bool        nvSaveJournal_(const char* reason);
     void        nvClearJournal_();
     size_t      flushJournalToMaster_();
+    size_t      replayJournalBinary_();
+    size_t      replayJournalNdjson_();
+    size_t      flushFlashJournal_();
+    bool        appendJournalRam_(uint32_t seq, uint8_t type, const uint8_t* fields,
+                                  uint8_t len, bool evict);
+    void        resetJournalRam_();
+    void        noteNvsEquiv_(uint32_t seq, uint8_t len);
+    static bool loadPendingJournal_(void* ctx, uint32_t seq, uint8_t type,
+                                    const uint8_t* fields, uint8_t len);
+    void        dropOldestJournal_();
+    void        consumeJournal_(size_t bytes, uint32_t seq, uint16_t count);
+    bool        waitTxSlot_(uint32_t timeoutMs);
+    bool        sendJournal_(uint16_t opcode, const uint8_t* payload, size_t payloadLen);
+    void        beginJournalPass_();
+    void        journalDone_(TxSlot& slot, bool delivered);
+    bool        awaitJournalDelivery_(uint32_t timeoutMs);
+    void        noteJournalFrame_(size_t payloadLen, bool ndjsonEquiv);
 
     // Config mode (master-requested; cleared on reboot)
     bool        configMode_ = false;
@@ -251,6 +643,7 @@ private:
     uint8_t     pendingPairInitMac_[6] = {0};
     uint8_t     pendingPairInitChannel_ = MASTER_CHANNEL_DEFAULT;
     uint8_t     pendingPairInitCaps_ = 0;
+    uint8_t     pendingPairInitWire_ = 0;
     uint32_t    pendingPairInitSeed_ = 0;
     bool        pendingPairInitShockExternal_ = true;
     bool        pendingPairInitAckInFlight_ = false;
@@ -1,4 +1,5 @@
 #include <ESPNOWManager.hpp>
+#include <CmdDecode.hpp>
 #include <CommandAPI.hpp>
 #include <ConfigNvs.hpp>
 #include <FingerprintScanner.hpp>
@@ -49,35 +50,10 @@ bool injectTransportRx(EspNowManager* mgr,
   mgr->transport->onRadioReceive(buf.data(), buf.size());
   return true;
 }
-
-bool parseU16Le_(const uint8_t* payload, size_t len, uint16_t& out) {
-  if (!payload || len < 2) return false;
-  out = static_cast<uint16_t>(payload[0]) |
-        (static_cast<uint16_t>(payload[1]) << 8);
-  return true;
-}
-
-// Capability bits mapping: bit0=Open, bit1=Shock, bit2=Reed, bit3=FP.
-uint8_t capBitsFromCmd(uint16_t opcode, uint8_t currentBits) {
-  uint8_t bits = currentBits;
-  auto setBit = [&bits](uint8_t b, bool on) {
-    if (on) bits |= (1u << b);
-    else    bits &= ~(1u << b);
-  };
-  if (opcode == CMD_CAP_OPEN_ON)  setBit(0, true);
-  if (opcode == CMD_CAP_OPEN_OFF) setBit(0, false);
-  if (opcode == CMD_CAP_SHOCK_ON) setBit(1, true);
-  if (opcode == CMD_CAP_SHOCK_OFF)setBit(1, false);
-  if (opcode == CMD_CAP_REED_ON)  setBit(2, true);
-  if (opcode == CMD_CAP_REED_OFF) setBit(2, false);
-  if (opcode == CMD_CAP_FP_ON)    setBit(3, true);
-  if (opcode == CMD_CAP_FP_OFF)   setBit(3, false);
-  return bits;
-}
 } // namespace
 
 // =============================================================
-//  Commands (bridged to transport)
+//  Commands (descriptor table -> transport / local)
 // =============================================================
 void EspNowManager::ProcessComand(uint16_t opcode, const uint8_t* payload, size_t payloadLen) {
   if (Slp) Slp->reset();
@@ -92,454 +68,176 @@ void EspNowManager::ProcessComand(uint16_t opcode, const uint8_t* payload, size_
     return;
   }
 
-  auto dispatchTransport = [this](Module module,
-                                  uint8_t op,
-                                  const std::vector<uint8_t>& payloadVec,
-                                  const char* tag) -> bool {
-    if (!transport) {
-      //DBG_PRINTLN(String("[ESPNOW][CMD] ") + (tag ? tag : "TRANSPORT") + " -> transport missing");
-      SendAck(ACK_UNINTENDED, false);
-      return false;
-    }
-    if (!injectTransportRx(this, module, op, payloadVec, false)) {
-      //DBG_PRINTLN(String("[ESPNOW][CMD] ") + (tag ? tag : "TRANSPORT") + " -> inject failed");
-      SendAck(ACK_UNINTENDED, false);
-      return false;
-    }
-    return true;
-  };
-
-  // Always honor reboot/reset per CommandAPI.
-  if (opcode == CMD_REBOOT) {
-    //DBG_PRINTLN("[ESPNOW][CMD] CMD_REBOOT -> Device Reboot");
-    SendAck(ACK_REBOOT, true);
-    ResetManager::RequestReboot("ESP-NOW CMD_REBOOT");
-    return;
-  }
-  if (opcode == CMD_SET_CHANNEL) {
-    if (!payload || payloadLen < 1) {
-     // DBG_PRINTLN("[ESPNOW][CMD] CMD_SET_CHANNEL -> missing payload");
+  const uint32_t c0 = ESP.getCycleCount();
+  cmd::CmdContext ctx;
+  ctx.alarmRole = IS_SLAVE_ALARM;
+  ctx.capBits   = getCapBits_();
+  const cmd::CmdDecoded dec = cmd::decodeCmd(opcode, payload, payloadLen, ctx);
+  switch (dec.verdict) {
+    case cmd::CmdVerdict::Ok:
+      break;
+    case cmd::CmdVerdict::Unknown:
+      cmdStats_.unknown++;
+    //  DBG_PRINTF("[ESPNOW][CMD] Unhandled opcode=0x%04X\n", (unsigned)opcode);
       SendAck(ACK_UNINTENDED, false);
       return;
-    }
-    const uint8_t channel = payload[0];
-    if (channel < 1 || channel > 13) {
-      //DBG_PRINTF("[ESPNOW][CMD] CMD_SET_CHANNEL -> invalid=%u\n",static_cast<unsigned>(channel));
+    case cmd::CmdVerdict::Policy:
+      cmdStats_.policy++;
       SendAck(ACK_ERR_POLICY, false);
       return;
-    }
-    if (!CONF) {
-     // DBG_PRINTLN("[ESPNOW][CMD] CMD_SET_CHANNEL -> conf missing");
-      SendAck(ACK_ERR_POLICY, false);
+    case cmd::CmdVerdict::BadLen:
+      cmdStats_.badLen++;
+      SendAck(ACK_UNINTENDED, false);
       return;
-    }
-   // DBG_PRINTF("[ESPNOW][CMD] CMD_SET_CHANNEL -> channel=%u (reboot)\n",static_cast<unsigned>(channel));
-
-    TxAckEvent ack{};
-    size_t frameLen = 0;
-    if (buildResponse_(ACK_SET_CHANNEL, nullptr, 0, ack.data, &frameLen)) {
-      ack.len = static_cast<uint16_t>(frameLen);
-      ack.status = true;
-      ack.attempts = 0;
-      if (!sendAckNow_(ack)) {
-        SendAck(ACK_SET_CHANNEL, true);
-      }
-    } else {
-      SendAck(ACK_SET_CHANNEL, true);
-    }
+  }
+  const cmd::CmdDesc* d = dec.desc;
 
-    const uint32_t start = millis();
-    while ((millis() - start) < 800) {
-      bool inflight = false;
-      bool pending = false;
-      taskENTER_CRITICAL(&sendMux_);
-      inflight = hasInFlight_;
-      taskEXIT_CRITICAL(&sendMux_);
-      if (sendQ && uxQueueMessagesWaiting(sendQ) > 0) pending = true;
-      if (txQ && uxQueueMessagesWaiting(txQ) > 0) pending = true;
-      if (!inflight && !pending) {
-        break;
-      }
-      vTaskDelay(pdMS_TO_TICKS(10));
-      esp_task_wdt_reset();
-    }
-    CONF->PutIntImmediate(MASTER_CHANNEL_KEY, static_cast<int>(channel));
-    ResetManager::RequestReboot("ESP-NOW CMD_SET_CHANNEL");
+  if (d->route == cmd::CmdRoute::Local) {
+    noteCmdDecode_(c0);
+    runLocalCmd_(opcode, payload, dec.len, d->ack);
     return;
   }
-  if (opcode == CMD_REMOVE_SLAVE) {
-    //DBG_PRINTLN("[ESPNOW][CMD] CMD_REMOVE_SLAVE -> Device Reset procedure (factory)");
-
-    TxAckEvent ack{};
-    size_t frameLen = 0;
-    if (buildResponse_(ACK_REMOVED, nullptr, 0, ack.data, &frameLen)) {
-      ack.len = static_cast<uint16_t>(frameLen);
-      ack.status = true;
-      ack.attempts = 0;
-      if (!sendAckNow_(ack)) {
-        SendAck(ACK_REMOVED, true);
-      }
-    } else {
-      SendAck(ACK_REMOVED, true);
-    }
-
-    const uint32_t start = millis();
-    while ((millis() - start) < 800) {
-      bool inflight = false;
-      bool pending = false;
-      taskENTER_CRITICAL(&sendMux_);
-      inflight = hasInFlight_;
-      taskEXIT_CRITICAL(&sendMux_);
-      if (sendQ && uxQueueMessagesWaiting(sendQ) > 0) pending = true;
-      if (txQ && uxQueueMessagesWaiting(txQ) > 0) pending = true;
-      if (!inflight && !pending) {
-        break;
-      }
-      vTaskDelay(pdMS_TO_TICKS(10));
-      esp_task_wdt_reset();
-    }
 
-    if (CONF) {
-      CONF->PutString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
-      CONF->PutString(MASTER_LMK_KEY, MASTER_LMK_DEFAULT);
-      CONF->PutBool(DEVICE_CONFIGURED, false);
-      CONF->PutBool(ARMED_STATE, false);
-      CONF->PutBool(MOTION_TRIG_ALARM, false);
-      CONF->PutBool(HAS_OPEN_SWITCH_KEY,  false);
-      CONF->PutBool(HAS_SHOCK_SENSOR_KEY, false);
-      CONF->PutBool(HAS_REED_SWITCH_KEY,  false);
-     // DBG_PRINTLN("[ESPNOW][CMD] Reset -> cleared pairing");
-    }
-    capBitsShadowValid_ = false;
-    capBitsShadow_ = 0;
-    ResetManager::RequestFactoryReset("ESP-NOW CMD_REMOVE_SLAVE");
-    return;
+  if (d->args == cmd::CmdArgs::CapBits) setCapBitsShadow_(dec.args[0]);
+  switch (d->hook) {
+    case cmd::CmdHook::None:                                              break;
+    case cmd::CmdHook::ForceAck: pendingForceAck_ = d->arg;               break;
+    case cmd::CmdHook::LockEmag: pendingLockEmag_ = static_cast<int8_t>(d->arg); break;
+    case cmd::CmdHook::TestMode: setConfigMode(true);                     break;
   }
-  if (opcode == CMD_FACTORY_RESET) {
-    //DBG_PRINTLN("[ESPNOW][CMD] CMD_FACTORY_RESET -> Device Reset procedure (factory)");
-    if (CONF) {
-      CONF->PutString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
-      CONF->PutString(MASTER_LMK_KEY, MASTER_LMK_DEFAULT);
-      CONF->PutBool(DEVICE_CONFIGURED, false);
-      CONF->PutBool(ARMED_STATE, false);
-      CONF->PutBool(MOTION_TRIG_ALARM, false);
-      CONF->PutBool(HAS_OPEN_SWITCH_KEY,  false);
-      CONF->PutBool(HAS_SHOCK_SENSOR_KEY, false);
-      CONF->PutBool(HAS_REED_SWITCH_KEY,  false);
-     // DBG_PRINTLN("[ESPNOW][CMD] Reset -> cleared pairing");
-    }
-    capBitsShadowValid_ = false;
-    capBitsShadow_ = 0;
-    SendAck(ACK_FACTORY_RESET, true);
-    ResetManager::RequestFactoryReset("ESP-NOW CMD_FACTORY_RESET");
-    return;
+  noteCmdDecode_(c0);
+
+  if (!transport || !injectTransportRx(this, d->module, d->op, std::vector<uint8_t>(dec.args, dec.args + dec.n), false)) {
+    //DBG_PRINTF("[ESPNOW][CMD] opcode=0x%04X -> transport missing/inject failed\n", (unsigned)opcode);
+    SendAck(ACK_UNINTENDED, false);
   }
+}
 
- // DBG_PRINTF("[ESPNOW][CMD] opcode=0x%04X\n", (unsigned)opcode);
+void EspNowManager::noteCmdDecode_(uint32_t c0) {
+  const uint32_t dc = ESP.getCycleCount() - c0;
+  cmdStats_.decoded++;
+  cmdStats_.decodeLastCycles = dc;
+  if (dc > cmdStats_.decodeMaxCycles) cmdStats_.decodeMaxCycles = dc;
+}
 
-  // Fast, read-only replies (stay on ESP-NOW edge)
-  if (opcode == CMD_STATE_QUERY) {
-   // DBG_PRINTLN("[ESPNOW][CMD] CMD_STATE_QUERY -> sendState()");
-    sendState("CMD_STATE_QUERY");
-    return;
-  }
-  if (opcode == CMD_HEARTBEAT_REQ) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] CMD_HEARTBEAT_REQ -> sendHeartbeat(force=true)");
-    sendHeartbeat(true);
-    return;
-  }
-  if (opcode == CMD_CONFIG_STATUS) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] CMD_CONFIG_STATUS");
-    const bool configured = (CONF && CONF->GetBool(DEVICE_CONFIGURED, false));
-    SendAck(configured ? ACK_CONFIGURED : ACK_NOT_CONFIGURED, configured);
-    return;
-  }
-  if (opcode == CMD_FP_QUERY_DB) {
-    if (IS_SLAVE_ALARM) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] FP_QUERY_DB -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
-      return;
-    }
-    //DBG_PRINTLN("[ESPNOW][CMD] CMD_FP_QUERY_DB -> transport QueryDb");
-    dispatchTransport(Module::Fingerprint, /*op*/0x06, {}, "FP_QUERY_DB");
-    return;
-  }
-  if (opcode == CMD_FP_NEXT_ID) {
-    if (IS_SLAVE_ALARM) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] FP_NEXT_ID -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+// Commands answered on the ESP-NOW edge (length already validated).
+void EspNowManager::runLocalCmd_(uint16_t opcode, const uint8_t* payload, size_t payloadLen,
+                                 uint16_t ack) {
+  (void)payloadLen;
+  switch (opcode) {
+    case CMD_REBOOT:
+      SendAck(ack, true);
+      ResetManager::RequestReboot("ESP-NOW CMD_REBOOT");
+      return;
+
+    case CMD_SET_CHANNEL: {
+      const uint8_t channel = payload[0];
+      if (channel < 1 || channel > 13 || !CONF) {
+        //DBG_PRINTF("[ESPNOW][CMD] CMD_SET_CHANNEL -> invalid=%u\n",static_cast<unsigned>(channel));
+        SendAck(ACK_ERR_POLICY, false);
+        return;
+      }
+      // Jump the queue, then let everything queued drain before rebooting.
+      (void)queueResponse_(ack, nullptr, 0, true, /*urgent*/true);
+      drainTxBeforeReset_();
+      CONF->PutIntImmediate(MASTER_CHANNEL_KEY, static_cast<int>(channel));
+      invalidatePeerCache();
+      ResetManager::RequestReboot("ESP-NOW CMD_SET_CHANNEL");
       return;
     }
-   // DBG_PRINTLN("[ESPNOW][CMD] CMD_FP_NEXT_ID -> transport NextId");
-    dispatchTransport(Module::Fingerprint, /*op*/0x07, {}, "FP_NEXT_ID");
-    return;
-  }
-  if (opcode == CMD_BATTERY_LEVEL) {
-    //DBG_PRINTLN("[ESPNOW][CMD] CMD_BATTERY_LEVEL");
-    uint8_t pct = static_cast<uint8_t>(Power ? Power->batteryPercentage : 0);
-    SendAck(EVT_BATTERY_PREFIX, &pct, 1, true);
-    return;
-  }
-  if (opcode == CMD_CLEAR_ALARM) {
-   // DBG_PRINTLN("[ESPNOW][CMD] CMD_CLEAR_ALARM -> clear alarm/buzzer");
-    breach = false;
-    if (CONF) {
-      CONF->PutBool(BREACH_STATE, false);
-    }
-    SendAck(ACK_ALARM_CLEARED, true);
-    SendAck(EVT_ALARM_CLEARED, true);
-    return;
-  }
 
-  // ---------- State-changing: bridge to transport then ACK ----------
-  if (opcode == CMD_ARM_SYSTEM) {
-    //DBG_PRINTLN("[ESPNOW][CMD] ARM_SYSTEM -> Device Arm (op=0x04)");
-    dispatchTransport(Module::Device, /*op*/0x04, {}, "ARM");
-    return;
-  }
-  if (opcode == CMD_DISARM_SYSTEM) {
-   // DBG_PRINTLN("[ESPNOW][CMD] DISARM_SYSTEM -> Device Disarm (op=0x05)");
-    dispatchTransport(Module::Device, /*op*/0x05, {}, "DISARM");
-    return;
-  }
-  if (opcode == CMD_ENABLE_MOTION) {
-    DBG_PRINTLN("[ESPNOW][RX] SHOCK TRIGGER ACTIVATED");
-    dispatchTransport(Module::Shock, /*op*/0x01, {}, "MOTION_ENABLE");
-    return;
-  }
-  if (opcode == CMD_DISABLE_MOTION) {
-    DBG_PRINTLN("[ESPNOW][RX] SHOCK TRIGGER DEACTIVATED");
-    dispatchTransport(Module::Shock, /*op*/0x02, {}, "MOTION_DISABLE");
-    return;
-  }
-  if (opcode == CMD_SET_SHOCK_SENSOR_TYPE) {
-    if (!payload || payloadLen < 1) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] SET_SHOCK_SENSOR_TYPE -> missing payload");
-      SendAck(ACK_UNINTENDED, false);
-      return;
-    }
-    uint8_t type = payload[0];
-   // DBG_PRINTF("[ESPNOW][CMD] SET_SHOCK_SENSOR_TYPE -> type=%u\n",static_cast<unsigned>(type));
-    dispatchTransport(Module::Shock, /*op*/0x10, {type}, "SHOCK_TYPE");
-    return;
-  }
-  if (opcode == CMD_SET_SHOCK_SENS_THRESHOLD) {
-    if (!payload || payloadLen < 1) {
-      //DBG_PRINTLN("[ESPNOW][CMD] SET_SHOCK_SENS_THRESHOLD -> missing payload");
-      SendAck(ACK_UNINTENDED, false);
+    case CMD_REMOVE_SLAVE:
+      // Jump the queue, then let everything queued drain before rebooting.
+      (void)queueResponse_(ack, nullptr, 0, true, /*urgent*/true);
+      drainTxBeforeReset_();
+      clearPairing_();
+      ResetManager::RequestFactoryReset("ESP-NOW CMD_REMOVE_SLAVE");
       return;
-    }
-    uint8_t ths = payload[0];
-   // DBG_PRINTF("[ESPNOW][CMD] SET_SHOCK_SENS_THRESHOLD -> ths=%u\n",static_cast<unsigned>(ths));
-    dispatchTransport(Module::Shock, /*op*/0x11, {ths}, "SHOCK_THS");
-    return;
-  }
-  if (opcode == CMD_SET_SHOCK_L2D_CFG) {
-    if (!payload || payloadLen < 11) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] SET_SHOCK_L2D_CFG -> missing payload");
-      SendAck(ACK_UNINTENDED, false);
-      return;
-    }
-    std::vector<uint8_t> cfg(payload, payload + 11);
-   // DBG_PRINTLN("[ESPNOW][CMD] SET_SHOCK_L2D_CFG -> apply");
-    dispatchTransport(Module::Shock, /*op*/0x12, cfg, "SHOCK_L2D_CFG");
-    return;
-  }
-  if (opcode == CMD_ENTER_TEST_MODE) {
-    //DBG_PRINTLN("[ESPNOW][CMD] ENTER_TEST_MODE -> Device SetConfigMode (op=0x01)");
-    setConfigMode(true);
-    dispatchTransport(Module::Device, /*op*/0x01, {}, "TEST_MODE");
-    return;
-  }
-  if (opcode == CMD_CAPS_QUERY) {
-   // DBG_PRINTLN("[ESPNOW][CMD] CAPS_QUERY -> ACK_CAPS");
-    uint8_t bits = 0;
-    if (CONF) {
-      bits |= CONF->GetBool(HAS_OPEN_SWITCH_KEY,   HAS_OPEN_SWITCH_DEFAULT)   ? 0x01 : 0;
-      bits |= CONF->GetBool(HAS_SHOCK_SENSOR_KEY,  HAS_SHOCK_SENSOR_DEFAULT)  ? 0x02 : 0;
-      bits |= CONF->GetBool(HAS_REED_SWITCH_KEY,   HAS_REED_SWITCH_DEFAULT)   ? 0x04 : 0;
-      bits |= CONF->GetBool(HAS_FINGERPRINT_KEY,   HAS_FINGERPRINT_DEFAULT)   ? 0x08 : 0;
-    }
-    if (IS_SLAVE_ALARM) {
-      bits = 0x06; // Shock + Reed only
-    }
-    SendAck(ACK_CAPS, &bits, 1, true);
-    return;
-  }
-  if (opcode == CMD_SET_ROLE) {
-   // DBG_PRINTLN("[ESPNOW][CMD] SET_ROLE -> Device SetRole (op=0x16)");
-    uint8_t role = (payloadLen >= 1) ? payload[0] : 0;
-    dispatchTransport(Module::Device, /*op*/0x16, {role}, "SET_ROLE");
-    return;
-  }
-  if (opcode == CMD_CANCEL_TIMERS) {
-   // DBG_PRINTLN("[ESPNOW][CMD] CANCEL_TIMERS -> Device CancelTimers (op=0x15)");
-    dispatchTransport(Module::Device, /*op*/0x15, {}, "CANCEL_TIMERS");
-    return;
-  }
-  if (opcode == CMD_SYNC_REQ) {
-   // DBG_PRINTLN("[ESPNOW][CMD] SYNC_REQ -> flushJournalToMaster + ACK_SYNCED");
-    size_t flushed = flushJournalToMaster_();
-    //DBG_PRINTF("[ESPNOW][CMD] Journal flushed lines=%u\n", (unsigned)flushed);
-    SendAck(ACK_SYNCED, true);
-    return;
-  }
 
-  // Motor commands
-  if (opcode == CMD_LOCK_SCREW) {
-    if (IS_SLAVE_ALARM) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] LOCK_SCREW -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+    case CMD_FACTORY_RESET:
+      clearPairing_();
+      SendAck(ack, true);
+      ResetManager::RequestFactoryReset("ESP-NOW CMD_FACTORY_RESET");
       return;
-    }
-   // DBG_PRINTLN("[ESPNOW][CMD] LOCK_SCREW -> Motor Lock (op=0x01)");
-    pendingForceAck_ = 0;
-    dispatchTransport(Module::Motor, /*op*/0x01, {}, "LOCK_SCREW");
-    // ACK will be emitted by Device on completion.
-    return;
-  }
-  if (opcode == CMD_UNLOCK_SCREW) {
-    if (IS_SLAVE_ALARM) {
-     // DBG_PRINTLN("[ESPNOW][CMD] UNLOCK_SCREW -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
-      return;
-    }
-   // DBG_PRINTLN("[ESPNOW][CMD] UNLOCK_SCREW -> Motor Unlock (op=0x02)");
-    pendingForceAck_ = 0;
-    dispatchTransport(Module::Motor, /*op*/0x02, {}, "UNLOCK_SCREW");
-    return;
-  }
-  if (opcode == CMD_FORCE_LOCK) {
-    if (IS_SLAVE_ALARM) {
-     // DBG_PRINTLN("[ESPNOW][CMD] FORCE_LOCK -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+
+    // Fast, read-only replies
+    case CMD_STATE_QUERY:
+      sendState("CMD_STATE_QUERY");
       return;
-    }
-    //DBG_PRINTLN("[ESPNOW][CMD] FORCE_LOCK -> Motor Lock (op=0x01)");
-    pendingForceAck_ = 1;
-    dispatchTransport(Module::Motor, /*op*/0x01, {}, "FORCE_LOCK");
-    return;
-  }
-  if (opcode == CMD_FORCE_UNLOCK) {
-    if (IS_SLAVE_ALARM) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] FORCE_UNLOCK -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+    case CMD_HEARTBEAT_REQ:
+      sendHeartbeat(true);
       return;
-    }
-   // DBG_PRINTLN("[ESPNOW][CMD] FORCE_UNLOCK -> Motor Unlock (op=0x02)");
-    pendingForceAck_ = 2;
-    dispatchTransport(Module::Motor, /*op*/0x02, {}, "FORCE_UNLOCK");
-    return;
-  }
-
-  // Capability control -> CapsSet
-  if (opcode == CMD_CAP_OPEN_ON || opcode == CMD_CAP_OPEN_OFF ||
-      opcode == CMD_CAP_SHOCK_ON|| opcode == CMD_CAP_SHOCK_OFF||
-      opcode == CMD_CAP_REED_ON || opcode == CMD_CAP_REED_OFF ||
-      opcode == CMD_CAP_FP_ON   || opcode == CMD_CAP_FP_OFF) {
-    //DBG_PRINTLN("[ESPNOW][CMD] CAP* -> Device CapsSet (op=0x07)");
-    uint8_t current = getCapBits_();
-    uint8_t bits = capBitsFromCmd(opcode, current);
-    setCapBitsShadow_(bits);
-    dispatchTransport(Module::Device, /*op*/0x07, {bits}, "CAPS_SET");
-    return;
-  }
-
-  // Lock driver mode (screw vs electromagnet) -> Device NvsWrite(LOCK_EMAG_KEY)
-  if (opcode == CMD_LOCK_EMAG_ON) {
-    if (IS_SLAVE_ALARM) {
-     // DBG_PRINTLN("[ESPNOW][CMD] LOCK_EMAG_ON -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+    case CMD_CONFIG_STATUS: {
+      const bool configured = (CONF && CONF->get<Cfg::DeviceConfigured>());
+      SendAck(configured ? ACK_CONFIGURED : ACK_NOT_CONFIGURED, configured);
       return;
     }
-   // DBG_PRINTLN("[ESPNOW][CMD] LOCK_EMAG_ON -> Device NvsWrite keyId=7 (LOCK_EMAG_KEY=true)");
-    std::vector<uint8_t> payloadVec = {7u, 1u};
-    pendingLockEmag_ = 1;
-    dispatchTransport(Module::Device, /*op*/0x0C, payloadVec, "LOCK_EMAG_ON");
-    return;
-  }
-  if (opcode == CMD_LOCK_EMAG_OFF) {
-    if (IS_SLAVE_ALARM) {
-    //  DBG_PRINTLN("[ESPNOW][CMD] LOCK_EMAG_OFF -> ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+    case CMD_BATTERY_LEVEL: {
+      uint8_t pct = static_cast<uint8_t>(Power ? Power->batteryPercentage : 0);
+      SendAck(ack, &pct, 1, true);
       return;
     }
-   // DBG_PRINTLN("[ESPNOW][CMD] LOCK_EMAG_OFF -> Device NvsWrite keyId=7 (LOCK_EMAG_KEY=false)");
-    std::vector<uint8_t> payloadVec = {7u, 0u};
-    pendingLockEmag_ = 0;
-    dispatchTransport(Module::Device, /*op*/0x0C, payloadVec, "LOCK_EMAG_OFF");
-    return;
-  }
-
-  // Fingerprint domain
-  if (IS_SLAVE_ALARM) {
-    const bool isFpCmd =
-        opcode == CMD_FP_VERIFY_ON ||
-        opcode == CMD_FP_VERIFY_OFF ||
-        opcode == CMD_ENROLL_FINGERPRINT ||
-        opcode == CMD_FP_DELETE_ID ||
-        opcode == CMD_FP_CLEAR_DB ||
-        opcode == CMD_FP_QUERY_DB ||
-        opcode == CMD_FP_NEXT_ID ||
-        opcode == CMD_FP_ADOPT_SENSOR ||
-        opcode == CMD_FP_RELEASE_SENSOR;
-    if (isFpCmd) {
-   //   DBG_PRINTLN("[ESPNOW][CMD] FP command ignored (alarm role)");
-      SendAck(ACK_ERR_POLICY, false);
+    case CMD_CLEAR_ALARM:
+      breach = false;
+      if (CONF) {
+        CONF->PutBool(BREACH_STATE, false);
+      }
+      SendAck(ack, true);
+      SendAck(EVT_ALARM_CLEARED, true);
+      return;
+    case CMD_CAPS_QUERY: {
+      uint8_t bits = 0;
+      if (CONF) {
+        bits |= CONF->get<Cfg::HasOpenSwitch>() ? 0x01 : 0;
+        bits |= CONF->get<Cfg::HasShockSensor>() ? 0x02 : 0;
+        bits |= CONF->get<Cfg::HasReedSwitch>() ? 0x04 : 0;
+        bits |= CONF->get<Cfg::HasFingerprint>() ? 0x08 : 0;
+      }
+      if (IS_SLAVE_ALARM) {
+        bits = 0x06; // Shock + Reed only
+      }
+      SendAck(ack, &bits, 1, true);
       return;
     }
-  }
-  if (opcode == CMD_FP_VERIFY_ON) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] FP_VERIFY_ON -> VerifyOn (op=0x01)");
-    dispatchTransport(Module::Fingerprint, /*op*/0x01, {}, "FP_VERIFY_ON");
-    return;
-  }
-  if (opcode == CMD_FP_VERIFY_OFF) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] FP_VERIFY_OFF -> VerifyOff (op=0x02)");
-    dispatchTransport(Module::Fingerprint, /*op*/0x02, {}, "FP_VERIFY_OFF");
-    return;
-  }
-  if (opcode == CMD_ENROLL_FINGERPRINT) {
-    uint16_t slotId = 0;
-    if (!parseU16Le_(payload, payloadLen, slotId)) {
-      SendAck(ACK_UNINTENDED, false);
+    case CMD_SYNC_REQ: {
+      size_t flushed = flushJournalToMaster_();
+      //DBG_PRINTF("[ESPNOW][CMD] Journal flushed lines=%u\n", (unsigned)flushed);
+      SendAck(ack, true);
       return;
     }
-  //  DBG_PRINTF("[ESPNOW][CMD] ENROLL slot=%u -> Enroll (op=0x03)\n", (unsigned)slotId);
-    std::vector<uint8_t> payloadVec{static_cast<uint8_t>(slotId & 0xFF),
-                                    static_cast<uint8_t>((slotId >> 8) & 0xFF)};
-    dispatchTransport(Module::Fingerprint, /*op*/0x03, payloadVec, "FP_ENROLL");
-    return;
-  }
-  if (opcode == CMD_FP_DELETE_ID) {
-    uint16_t slotId = 0;
-    if (!parseU16Le_(payload, payloadLen, slotId)) {
+    default:
       SendAck(ACK_UNINTENDED, false);
       return;
-    }
-  //  DBG_PRINTF("[ESPNOW][CMD] FP_DELETE slot=%u -> DeleteId (op=0x04)\n", (unsigned)slotId);
-    std::vector<uint8_t> payloadVec{static_cast<uint8_t>(slotId & 0xFF),
-                                    static_cast<uint8_t>((slotId >> 8) & 0xFF)};
-    dispatchTransport(Module::Fingerprint, /*op*/0x04, payloadVec, "FP_DELETE");
-    return;
   }
-  if (opcode == CMD_FP_CLEAR_DB) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] FP_CLEAR_DB -> ClearDb (op=0x05)");
-    dispatchTransport(Module::Fingerprint, /*op*/0x05, {}, "FP_CLEAR_DB");
-    return;
-  }
-  if (opcode == CMD_FP_ADOPT_SENSOR) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] FP_ADOPT -> AdoptSensor (op=0x08)");
-    dispatchTransport(Module::Fingerprint, /*op*/0x08, {}, "FP_ADOPT");
-    return;
-  }
-  if (opcode == CMD_FP_RELEASE_SENSOR) {
-  //  DBG_PRINTLN("[ESPNOW][CMD] FP_RELEASE -> ReleaseSensor (op=0x09)");
-    dispatchTransport(Module::Fingerprint, /*op*/0x09, {}, "FP_RELEASE");
-    return;
+}
+
+// Give queued frames (the urgent ACK first) up to 800 ms to leave.
+void EspNowManager::drainTxBeforeReset_() {
+  trySendNext_();
+  const uint32_t start = millis();
+  while ((millis() - start) < 800 && !txIdle_()) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+    esp_task_wdt_reset();
   }
+}
 
-  // Unknown
-//  DBG_PRINTF("[ESPNOW][CMD] Unhandled opcode=0x%04X\n", (unsigned)opcode);
-  SendAck(ACK_UNINTENDED, false);
+// Forget the master(s) and the provisioned capabilities.
+void EspNowManager::clearPairing_() {
+  if (CONF) {
+    CONF->PutString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
+    CONF->PutString(MASTER_LMK_KEY, MASTER_LMK_DEFAULT);
+    CONF->PutString(MASTER_STANDBY_ID, MASTER_STANDBY_ID_DEFAULT);
+    CONF->PutString(MASTER_STANDBY_LMK, MASTER_STANDBY_LMK_DEFAULT);
+    CONF->PutInt(MASTER_WIRE_KEY, MASTER_WIRE_DEFAULT);
+    invalidatePeerCache();
+    CONF->PutBool(DEVICE_CONFIGURED, false);
+    CONF->PutBool(ARMED_STATE, false);
+    CONF->PutBool(MOTION_TRIG_ALARM, false);
+    CONF->PutBool(HAS_OPEN_SWITCH_KEY,  false);
+    CONF->PutBool(HAS_SHOCK_SENSOR_KEY, false);
+    CONF->PutBool(HAS_REED_SWITCH_KEY,  false);
+   // DBG_PRINTLN("[ESPNOW][CMD] Reset -> cleared pairing");
+  }
+  capBitsShadowValid_ = false;
+  capBitsShadow_ = 0;
 }
@@ -5,6 +5,8 @@
 #include <Transport.hpp>
 #include <TransportManager.hpp>
 #include <Utils.hpp>
+#include <WarmState.hpp>
+#include <esp_heap_caps.h>
 #include <esp_task_wdt.h>
 #include <stdio.h>
 #include <string.h>
@@ -15,18 +17,56 @@
 // =============================================================
 EspNowManager* EspNowManager::instance = nullptr;
 namespace {
-// Journal allow-list (no timer entries)
-inline bool isAllowedJournalType(const char* t) {
-  if (!t) return false;
-  return !strcmp(t,"LOW_BATT")   || !strcmp(t,"CRITICAL") ||
-         !strcmp(t,"LOCKED")     || !strcmp(t,"UNLOCKED") ||
-         !strcmp(t,"BREACH")     || !strcmp(t,"FP_MATCH") ||
-         !strcmp(t,"FP_FAIL")    || !strcmp(t,"STATE")    ||
-         !strcmp(t,"MOTOR_FAIL") || !strcmp(t,"RESET");
-}
-
 // Keep NDJSON compact so "EVT:<line>" fits inside 120-byte wire payload
 static constexpr size_t MAX_NDJSON_LINE = 100;
+
+// Largest EVT_JOURNAL payload: response header is 4 bytes.
+static constexpr size_t kJournalFrameMax = ESPNOW_MAX_DATA_LEN - 4;
+
+uint32_t airtimeUs_(size_t payloadLen) {
+  // +4: ResponseMessage header around the payload.
+  return ESPNOW_AIR_PREAMBLE_US +
+         static_cast<uint32_t>(ESPNOW_AIR_OVERHEAD_BYTES + 4 + payloadLen) * 8u;
+}
+
+// {"seq":N,"type":"X","d":{}} or ...,"d":{"h":"<hex fields>"}} (no newline).
+size_t renderNdjson_(char* out, size_t cap, uint32_t seq, const journal::Record& r) {
+  static const char kHex[] = "0123456789ABCDEF";
+  int n = snprintf(out, cap, "{\"seq\":%lu,\"type\":\"%s\",\"d\":{",
+                   static_cast<unsigned long>(seq), journal::typeName(r.type));
+  if (n < 0 || static_cast<size_t>(n) >= cap) return 0;
+  size_t len = static_cast<size_t>(n);
+  // Fields only when the whole line still fits; otherwise keep the event.
+  const size_t withFields = len + 7 + r.len * 2 + 2;
+  if (r.len && withFields <= MAX_NDJSON_LINE && withFields < cap) {
+    memcpy(out + len, "\"h\":\"", 5); len += 5;
+    for (uint8_t i = 0; i < r.len; ++i) {
+      out[len++] = kHex[r.fields[i] >> 4];
+      out[len++] = kHex[r.fields[i] & 0x0F];
+    }
+    out[len++] = '"';
+  }
+  if (len + 2 >= cap) return 0;
+  out[len++] = '}';
+  out[len++] = '}';
+  out[len] = '\0';
+  return len;
+}
+
+// Length renderNdjson_() would return with a MAX_NDJSON_LINE + 1 buffer,
+// without rendering (journal stats only).
+size_t ndjsonSize_(uint32_t seq, const journal::Record& r) {
+  constexpr size_t cap = MAX_NDJSON_LINE + 1;
+  size_t digits = 1;
+  for (uint32_t v = seq; v >= 10; v /= 10) ++digits;
+  // {"seq":<n>,"type":"<name>","d":{
+  size_t len = 7 + digits + 9 + strlen(journal::typeName(r.type)) + 7;
+  if (len >= cap) return 0;
+  const size_t withFields = len + 7 + r.len * 2 + 2;
+  if (r.len && withFields <= MAX_NDJSON_LINE && withFields < cap) len += 6 + r.len * 2;
+  if (len + 2 >= cap) return 0;
+  return len + 2;
+}
 }
 
 // =============================================================
@@ -39,17 +79,40 @@ EspNowManager::EspNowManager(RTCManager* RTC,
                              Fingerprint* fng)
     : RTC(RTC), Power(Power), motor(motor), Slp(Slp), sw(nullptr),fng(fng) {
   instance = this;
-  breach = (CONF ? CONF->GetBool(BREACH_STATE, BREACH_STATE_DEFAULT) : false);
+  breach = (CONF ? CONF->get<Cfg::BreachState>() : false);
+  if (CONF) {
+    configured_ = CONF->get<Cfg::DeviceConfigured>();
+    (void)CONF->subscribe(&EspNowManager::onConfigChanged_, this,
+                          cfgBit(Cfg::DeviceConfigured) | cfgBit(Cfg::HasOpenSwitch) |
+                          cfgBit(Cfg::HasShockSensor) | cfgBit(Cfg::HasReedSwitch) |
+                          cfgBit(Cfg::HasFingerprint));
+  }
 
   //DBG_PRINTLN("[ESPNOW][Ctor] Constructing EspNowManager…");
 
   // Queues
-  rxQ   = xQueueCreate(ESPNOW_RX_QUEUE_SIZE, sizeof(RxEvent));
-  txQ   = xQueueCreate(ESPNOW_TX_QUEUE_SIZE, sizeof(TxAckEvent));
-  sendQ = xQueueCreate(ESPNOW_TX_QUEUE_SIZE, sizeof(TxAckEvent));
+  const size_t slabBytes = sizeof(RxEvent) * ESPNOW_RX_QUEUE_SIZE;
+#if ESPNOW_SLAB_IN_PSRAM
+  if (psramFound()) {
+    rxSlab_ = (RxEvent*) heap_caps_malloc(slabBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    rxSlabPsram_ = (rxSlab_ != nullptr);
+  }
+#endif
+  if (!rxSlab_) {
+    rxSlab_ = (RxEvent*) heap_caps_malloc(slabBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  }
+  rxQ     = xQueueCreate(ESPNOW_RX_QUEUE_SIZE, sizeof(uint8_t));
+  rxFreeQ = xQueueCreate(ESPNOW_RX_QUEUE_SIZE, sizeof(uint8_t));
+  journalQ_ = xQueueCreate(ESPNOW_JOURNAL_QUEUE, sizeof(JournalEvent));
+  if (rxSlab_ && rxFreeQ) {
+    for (uint8_t i = 0; i < ESPNOW_RX_QUEUE_SIZE; ++i) (void)xQueueSend(rxFreeQ, &i, 0);
+  }
+  for (uint8_t i = 0; i < ESPNOW_TX_QUEUE_SIZE; ++i) txFree_.push(i);
 
-  DBG_PRINTF("[ESPNOW][Ctor] Queues rxQ=%p txQ=%p sendQ=%p (sizes: rx=%u tx=%u)\n",
-               (void*)rxQ, (void*)txQ, (void*)sendQ, (unsigned)ESPNOW_RX_QUEUE_SIZE, (unsigned)ESPNOW_TX_QUEUE_SIZE);
+  DBG_PRINTF("[ESPNOW][Ctor] rx slab=%p (%u B, %s) rxQ=%p rxFreeQ=%p tx slots=%u inflight=%u\n",
+               (void*)rxSlab_, (unsigned)slabBytes, rxSlabPsram_ ? "PSRAM" : "DRAM",
+               (void*)rxQ, (void*)rxFreeQ, (unsigned)ESPNOW_TX_QUEUE_SIZE,
+               (unsigned)ESPNOW_TX_MAX_INFLIGHT);
 
   // Worker (persistent)
   xTaskCreate(
@@ -78,9 +141,9 @@ esp_err_t EspNowManager::init() {
   DBG_PRINTLN("[ESPNOW][init] Starting ESP-NOW stack...");
 
   uint8_t desiredChannel = getDefaultChannel_();
-  if (CONF && CONF->GetBool(DEVICE_CONFIGURED, false)) {
+  if (CONF && CONF->get<Cfg::DeviceConfigured>()) {
     desiredChannel = static_cast<uint8_t>(
-        CONF->GetInt(MASTER_CHANNEL_KEY, MASTER_CHANNEL_DEFAULT));
+        CONF->get<Cfg::MasterChannel>());
     DBG_PRINTF("[ESPNOW][init] Configured: use stored channel=%u\n",
                (unsigned)desiredChannel);
   } else {
@@ -100,6 +163,15 @@ esp_err_t EspNowManager::init() {
   DBG_PRINTLN("[ESPNOW][init] esp_now_init() OK, registering callbacks");
   esp_now_register_send_cb(onDataSent);
   esp_now_register_recv_cb(onDataReceived);
+#if ESPNOW_RSSI_CAPTURE
+  // Management frames only: enough for ESP-NOW action frames' RSSI.
+  const wifi_promiscuous_filter_t filt = { WIFI_PROMIS_FILTER_MASK_MGMT };
+  esp_wifi_set_promiscuous_filter(&filt);
+  esp_wifi_set_promiscuous_rx_cb(onPromiscRx_);
+  if (esp_wifi_set_promiscuous(true) != ESP_OK) {
+    DBG_PRINTLN("[ESPNOW][init] promiscuous RX unavailable; no RSSI capture");
+  }
+#endif
 
 
   // If already configured, ensure peer is registered and send startup bundle
@@ -129,7 +201,6 @@ esp_err_t EspNowManager::init() {
 
   // Start the presence timer fresh to avoid an immediate watchdog ping
   lastHbMs_ = millis();
-  nextPingDueMs_ = lastHbMs_ + PING_INTERVAL_MS;
 
   DBG_PRINTLN("[ESPNOW]ESPNOW Initialized Successfully ");
   return ESP_OK;
@@ -139,12 +210,17 @@ esp_err_t EspNowManager::deinit() {
   DBG_PRINTLN("[ESPNOW][deinit] Unregister and deinit ESPNOW…");
   esp_now_unregister_send_cb();
   esp_now_unregister_recv_cb();
+#if ESPNOW_RSSI_CAPTURE
+  esp_wifi_set_promiscuous(false);
+#endif
   esp_now_deinit();
+  if (transport) transport->invalidatePeers();   // standby peer must be re-added
 
   if (workerH) { vTaskDelete(workerH); workerH = nullptr; DBG_PRINTLN("[ESPNOW][deinit] Worker task deleted."); }
   if (rxQ)     { vQueueDelete(rxQ);    rxQ = nullptr;     DBG_PRINTLN("[ESPNOW][deinit] rxQ deleted.");        }
-  if (txQ)     { vQueueDelete(txQ);    txQ = nullptr;     DBG_PRINTLN("[ESPNOW][deinit] txQ deleted.");        }
-  if (sendQ)   { vQueueDelete(sendQ);  sendQ = nullptr;   DBG_PRINTLN("[ESPNOW][deinit] sendQ deleted.");      }
+  if (rxFreeQ) { vQueueDelete(rxFreeQ); rxFreeQ = nullptr; DBG_PRINTLN("[ESPNOW][deinit] rxFreeQ deleted.");  }
+  if (journalQ_) { vQueueDelete(journalQ_); journalQ_ = nullptr; DBG_PRINTLN("[ESPNOW][deinit] journalQ deleted."); }
+  if (rxSlab_) { heap_caps_free(rxSlab_); rxSlab_ = nullptr; DBG_PRINTLN("[ESPNOW][deinit] rx slab freed."); }
   DBG_PRINTLN("[ESPNOW][deinit] Done.");
   return ESP_OK;
 }
@@ -187,31 +263,92 @@ void EspNowManager::storeMacAddress(const uint8_t* mac_addr) {
            mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5]);
   DBG_PRINTF("[ESPNOW][storeMacAddress] %s\n", mac_str);
   CONF->PutString(MASTER_ESPNOW_ID, mac_str);
+  invalidatePeerCache();
 }
 
 esp_err_t EspNowManager::getMacAddress(uint8_t* mac_addr) {
-  if (!mac_addr || !CONF) {
-    DBG_PRINTLN("[ESPNOW][getMacAddress] Invalid arg or Conf=null");
+  if (!mac_addr) {
+    DBG_PRINTLN("[ESPNOW][getMacAddress] Invalid arg");
     return ESP_ERR_INVALID_ARG;
   }
-  String mac_str = CONF->GetString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
-  DBG_PRINTLN(String("[ESPNOW][getMacAddress] String=") + mac_str);
-  if (mac_str.length() == 17 && parseMacToBytes(mac_str, mac_addr)) return ESP_OK;
-  return ESP_ERR_INVALID_ARG;
+  return masterMac(mac_addr) ? ESP_OK : ESP_ERR_INVALID_ARG;
 }
 
 bool EspNowManager::compareMacAddress(const uint8_t* mac_addr) {
-  if (!mac_addr || !CONF) { DBG_PRINTLN("[ESPNOW][compareMacAddress] Missing mac or Conf"); return false; }
-  String stored_mac_str = CONF->GetString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
+  if (!mac_addr) { DBG_PRINTLN("[ESPNOW][compareMacAddress] Missing mac"); return false; }
   uint8_t stored_mac[6];
-  if (!parseMacToBytes(stored_mac_str, stored_mac)) {
-    DBG_PRINTLN("[ESPNOW][compareMacAddress] Stored master parse failed");
+  if (!masterMac(stored_mac)) {
+    DBG_PRINTLN("[ESPNOW][compareMacAddress] No stored master");
     return false;
   }
-  bool eq = true;
-  for (int i = 0; i < 6; ++i) if (stored_mac[i] != mac_addr[i]) { eq = false; break; }
-  DBG_PRINTF("[ESPNOW][compareMacAddress] equal=%d\n", (int)eq);
-  return eq;
+  return memcmp(stored_mac, mac_addr, 6) == 0;
+}
+
+// =============================================================
+//  Master identity cache
+// =============================================================
+bool EspNowManager::identity_(bool standby, PeerIdentity& out) {
+  taskENTER_CRITICAL(&peerMux_);
+  const bool     loaded = peerCacheLoaded_;
+  const uint32_t gen    = peerCacheGen_;
+  if (loaded) out = standby ? standbyCache_ : peerCache_;
+  taskEXIT_CRITICAL(&peerMux_);
+  if (loaded) return out.valid;
+
+  // Miss: read NVS outside the spinlock, then publish unless an
+  // invalidation raced the read. Both identities load together.
+  PeerIdentity fresh, freshStandby;
+  loadPeerIdentity_(fresh, MASTER_ESPNOW_ID, MASTER_LMK_KEY);
+  loadPeerIdentity_(freshStandby, MASTER_STANDBY_ID, MASTER_STANDBY_LMK);
+  // The standby is provisioned by the primary and speaks the same wire.
+  fresh.wire = freshStandby.wire =
+      CONF ? static_cast<uint8_t>(CONF->get<Cfg::MasterWire>()) : 0;
+  taskENTER_CRITICAL(&peerMux_);
+  if (peerCacheGen_ == gen) {
+    peerCache_       = fresh;
+    standbyCache_    = freshStandby;
+    peerCacheLoaded_ = true;
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+  txStats_.peerCacheLoads++;
+  DBG_PRINTF("[ESPNOW][peer] identity loaded valid=%d ch=%u lmk=%d standby=%d wire=0x%02X\n",
+             (int)fresh.valid, (unsigned)fresh.channel, (int)fresh.hasLmk,
+             (int)freshStandby.valid, (unsigned)fresh.wire);
+  out = standby ? freshStandby : fresh;
+  return out.valid;
+}
+
+bool EspNowManager::masterIdentity(PeerIdentity& out) {
+  return identity_(false, out);
+}
+
+bool EspNowManager::standbyIdentity(PeerIdentity& out) {
+  return identity_(true, out);
+}
+
+bool EspNowManager::masterMac(uint8_t out[6]) {
+  PeerIdentity id;
+  if (!masterIdentity(id)) return false;
+  memcpy(out, id.mac, 6);
+  return true;
+}
+
+uint8_t EspNowManager::wireCaps() {
+  PeerIdentity id;
+  return masterIdentity(id) ? id.wire : 0;
+}
+
+bool EspNowManager::nativeWire() {
+  return (wireCaps() & NOW_WIRE_TRANSPORT) != 0;
+}
+
+void EspNowManager::invalidatePeerCache() {
+  taskENTER_CRITICAL(&peerMux_);
+  peerCacheLoaded_ = false;
+  peerCacheGen_++;
+  taskEXIT_CRITICAL(&peerMux_);
+  if (transport) transport->invalidatePeers();
+  wakeWorker_();   // rebuilds the transport peer table
 }
 
 // =============================================================
@@ -224,65 +361,44 @@ void EspNowManager::workerTask(void* selfPtr) {
   DBG_PRINTLN("[ESPNOW][worker] Started.");
 
   uint32_t ctr = 0;
+  self->winStartUs_ = micros();
   for (;;) {
     // Keep task watchdog happy while doing radio/queue work.
     esp_task_wdt_reset();
 
+    const uint32_t t0  = micros();
     const uint32_t now = millis();
 
     self->pollPairing_();
-
-    // 1) RX
-    RxEvent rx{};
-    if (xQueueReceive(self->rxQ, &rx, pdMS_TO_TICKS(5)) == pdPASS) {
-      DBG_PRINTF("[ESPNOW][worker][RX] pop len=%d from %02X:%02X:%02X:%02X:%02X:%02X\n",
-                   rx.len, rx.mac[0], rx.mac[1], rx.mac[2], rx.mac[3], rx.mac[4], rx.mac[5]);
+    // Only the worker rebuilds the transport peer table; radio callbacks
+    // and other tasks route with the last one built.
+    if (self->transport) self->transport->refreshPeers();
+
+    // 1) RX: drain every ready slot (processed in place, then returned)
+    uint8_t rxIdx = 0;
+    while (xQueueReceive(self->rxQ, &rxIdx, 0) == pdPASS) {
+      const RxEvent& rx = self->rxSlab_[rxIdx];
+      DBG_PRINTF("[ESPNOW][worker][RX] pop slot=%u len=%d from %02X:%02X:%02X:%02X:%02X:%02X\n",
+                   (unsigned)rxIdx, rx.len, rx.mac[0], rx.mac[1], rx.mac[2], rx.mac[3], rx.mac[4], rx.mac[5]);
       self->processRx(rx);
+      (void)xQueueSend(self->rxFreeQ, &rxIdx, 0);
     }
 
-    // 2) Convert queued responses to paced send entries (txQ -> sendQ)
-    TxAckEvent tx{};
-    if (xQueueReceive(self->txQ, &tx, 0) == pdPASS) {
-      uint16_t opcode = 0;
-      if (tx.len >= 3) {
-        opcode = static_cast<uint16_t>(tx.data[1]) |
-                 (static_cast<uint16_t>(tx.data[2]) << 8);
-      }
-      DBG_PRINTF("[ESPNOW][worker][ACK] move to sendQ op=0x%04X attempt=%u status=%u\n",
-                 (unsigned)opcode, (unsigned)tx.attempts, (unsigned)(tx.status ? 1 : 0));
-      (void)xQueueSend(self->sendQ, &tx, 0);
-    }
-
-    // 3) If nothing is in flight, send next
+    // 2) Refill the in-flight window (picks up immediate-failure retries)
     self->trySendNext_();
 
-    // 4) No periodic heartbeat — master requests HB via HBRQ
+    // 3) No periodic heartbeat — master requests HB via HBRQ
     self->heartbeatTick_();  // no-op
 
     // ---- Everything below is DISABLED until device is configured ----
     const bool configured = self->isConfigured_();
     if (configured) {
-      if (now >= self->nextPingDueMs_) {
-        // Schedule next tick first (fixed 30s cadence)
-        self->nextPingDueMs_ = now + PING_INTERVAL_MS;
-
-        const bool ok = self->pingMaster(1);     // one single attempt
-        if (ok) {
-          if (!self->online_) {
-            self->setOffline(false);
-            self->lastHbMs_ = now;
-            // Optional: flush any offline journal
-            (void)self->flushJournalToMaster_();
-          }
-        } else {
-          if (self->online_) {
-            self->setOffline(true);
-          }
-        }
-      }
+      self->drainJournalQ_();
+      self->rescanTick_(now);
+      self->presenceTick_(now);
     } else {
       // Unconfigured: never ping; force offline
-      if (self->online_) self->setOffline(true);
+      self->online_ = false;
     }
 
     // Optional: monitor stack headroom
@@ -291,11 +407,68 @@ void EspNowManager::workerTask(void* selfPtr) {
       //DBG_PRINTF("[ESPNOW][worker] free stack (words): %u\n", (unsigned)hw);
     }
 
-    vTaskDelay(pdMS_TO_TICKS(1));
-    taskYIELD();
+    // 4) Block until RX, a TX completion/failure, or the next deadline.
+    const uint32_t waitMs = self->workerWaitMs_(millis());
+    const uint32_t t1 = micros();
+    const uint32_t woke = waitMs ? ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs))
+                                 : ulTaskNotifyTake(pdTRUE, 0);
+    self->noteWorkerPass_(t1 - t0, micros() - t1, waitMs && !woke);
   }
 }
 
+void EspNowManager::wakeWorker_() {
+  // The worker recomputes its deadline itself; a self-notify would spin it.
+  if (workerH && xTaskGetCurrentTaskHandle() != workerH) xTaskNotifyGive(workerH);
+}
+
+// Milliseconds until the worker has scheduled work (0 = now).
+uint32_t EspNowManager::workerWaitMs_(uint32_t now) {
+  uint32_t wait = ESPNOW_WORKER_IDLE_MS;
+
+  if (rxQ && uxQueueMessagesWaiting(rxQ) > 0) return 0;
+  if (journalQ_ && uxQueueMessagesWaiting(journalQ_) > 0) return 0;
+
+  bool txBacklog = false;
+  taskENTER_CRITICAL(&sendMux_);
+  txBacklog = (txReady_.count > 0) && (txInFlight_.count < txInFlightCap_());
+  taskEXIT_CRITICAL(&sendMux_);
+  if (txBacklog && ESPNOW_TX_RETRY_MS < wait) wait = ESPNOW_TX_RETRY_MS;
+  if (presenceRecovered_) return 0;
+
+  const uint32_t pair = pairingWaitMs_(now);
+  if (pair < wait) wait = pair;
+  const uint32_t scan = rescanWaitMs_(now);
+  if (scan < wait) wait = scan;
+
+  if (isConfigured_()) {
+    // Online: the quiet deadline moves with traffic. Offline: next probe.
+    const uint32_t dueAt = online_ ? lastHbMs_ + PRESENCE_TIMEOUT_MS : nextPingDueMs_;
+    const int32_t due = int32_t(dueAt - now);
+    const uint32_t w = due > 0 ? uint32_t(due) : 0;
+    if (w < wait) wait = w;
+  }
+  return wait;
+}
+
+void EspNowManager::noteWorkerPass_(uint32_t busyUs, uint32_t blockedUs, bool timed) {
+  WorkerStats& st = workerStats_;
+  st.wakeups++;
+  if (timed) st.timedWakes++;
+  st.busyUsTotal += busyUs;
+  winBusyUs_ += busyUs;
+  if (blockedUs >= ESPNOW_SLEEP_MIN_BLOCK_MS * 1000UL) winSleepUs_ += blockedUs;
+  winWakes_++;
+
+  const uint32_t nowUs = micros();
+  const uint32_t span  = nowUs - winStartUs_;
+  if (span < 1000000UL) return;
+  st.loadPermille  = uint16_t((uint64_t(winBusyUs_)  * 1000U) / span);
+  st.sleepPermille = uint16_t((uint64_t(winSleepUs_) * 1000U) / span);
+  st.wakesLastWin  = winWakes_;
+  winStartUs_ = nowUs;
+  winBusyUs_ = winSleepUs_ = winWakes_ = 0;
+}
+
 // =============================================================
 //  Utility
 // =============================================================
@@ -334,93 +507,294 @@ void EspNowManager::debugDumpPacket_(const char* tag, const uint8_t* data, size_
 }
 
 // =============================================================
-//  Journal: RAM ring (String) + NVS coalesce
+//  Journal: binary records in RAM + NVS blob (coalesced)
 // =============================================================
-bool EspNowManager::spoolImportant_(const char* type, const String& json) {
+bool EspNowManager::spoolImportant_(journal::Type type, const uint8_t* fields, uint8_t len) {
   // Skip completely if device not configured yet
   if (!isConfigured_()) {
     DBG_PRINTLN("[ESPNOW][journal] skip: not configured");
     return false;
   }
-
-  // Enforce journal policy: allow-list only (no timer entries)
-  if (!isAllowedJournalType(type)) {
-    DBG_PRINTLN(String("[ESPNOW][journal] drop type=") + (type ? type : "NULL"));
+  const uint8_t t = static_cast<uint8_t>(type);
+  if (t == 0 || t > journal::kTypeMax) {
+    DBG_PRINTF("[ESPNOW][journal] drop type=%u\n", (unsigned)t);
     return false;
   }
+  if (len > journal::kMaxFields || (len && !fields)) {
+    // Policy: keep the event, trim details
+    len = 0;
+  }
 
-  // Build compact NDJSON: {"seq":N,"type":"X","d":{...}}\n
-  String inner; inner.reserve(json.length());
-  if (json.length()) {
-    if (json.charAt(0) == '{') {
-      // Strip surrounding braces so we control final size precisely
-      int L = json.length();
-      inner = (L >= 2) ? json.substring(1, L - 1) : "";
-    } else {
-      inner = json; // already "k:v" style
-    }
+  const uint32_t seq = ++seq_;
+  if (flashJournal_.ready()) {
+    if (len > FlashJournal::kFields) len = FlashJournal::kFields;
+    if (!flashJournal_.append(seq, t, fields, len)) return false;
+    journalStats_.records++;
+    journalStats_.storeBytes += FlashJournal::kSlotSize;
+    noteNvsEquiv_(seq, len);
+    DBG_PRINTF("[ESPNOW][journal] spool seq=%lu type=%s (flash)\n",
+                 (unsigned long)seq, journal::typeName(t));
+    return true;
   }
 
-  // Fixed pieces we’ll render: prefix + inner + suffix
-  // prefix: {"seq":<N>,"type":"<T>","d":{
-  String seqStr = String(++seq_);
-  const String prefix = String("{\"seq\":") + seqStr + ",\"type\":\"" +
-                        (type ? type : "UNK") + "\",\"d\":{";
-  const String suffix = "}}\n";
+  if (!appendJournalRam_(seq, t, fields, len, true)) return false;
+  journalStats_.records++;
+  needsFlush_ = true;
+
+  DBG_PRINTF("[ESPNOW][journal] spool seq=%lu type=%s bytes=%u count=%u\n",
+               (unsigned long)seq, journal::typeName(t),
+               (unsigned)journalLen_, (unsigned)journalCount_);
 
-  // Budget for inner so total line <= MAX_NDJSON_LINE
-  size_t budget = (MAX_NDJSON_LINE > (prefix.length() + suffix.length()))
-                  ? (MAX_NDJSON_LINE - prefix.length() - suffix.length())
-                  : 0;
+  // Coalesce NVS writes: a burst of records costs one blob write.
+  if (journalCount_ % JOURNAL_COALESCE_MAX == 0 ||
+      millis() - lastJournalSaveMs_ >= JOURNAL_COALESCE_MS) {
+    (void)nvSaveJournal_("coalesce");
+  }
+  return true;
+}
 
-  if (inner.length() > budget) {
-    // If too large, prefer empty payload (keeps event but fits the wire)
-    DBG_PRINTF("[ESPNOW][journal] truncate inner %u->%u\n",
-                 (unsigned)inner.length(), (unsigned)budget);
-    inner = ""; // minimal `{}` data — policy: keep the event, trim details
+// Maps a master-bound transport message to a journal record while the
+// master is offline. Periodic StateReports are not journaled; the replay
+// ends with a fresh one anyway.
+void EspNowManager::journalOffline(const transport::TransportMessage& msg) {
+  using transport::Module;
+  if (online_ || !journalQ_ || !isConfigured_()) return;
+  if (msg.header.destId != TRANSPORT_MASTER_ID) return;
+  if (msg.header.type == static_cast<uint8_t>(transport::MessageType::Request)) return;
+
+  const uint8_t* p = msg.payload.data();
+  const size_t   n = msg.payload.size();
+  JournalEvent ev{};
+  bool copyPayload = false;
+  switch (static_cast<Module>(msg.header.module)) {
+    case Module::Power:
+      if (msg.header.opCode == 0x02)      ev.type = uint8_t(journal::Type::LowBatt);
+      else if (msg.header.opCode == 0x03) ev.type = uint8_t(journal::Type::Critical);
+      copyPayload = true;
+      break;
+    case Module::Device:
+      if (msg.header.opCode == 0x14) {          // CriticalPower
+        ev.type = uint8_t(journal::Type::Critical);
+        copyPayload = true;
+      } else if (msg.header.opCode == 0x0F) {   // AlarmRequest
+        ev.type = uint8_t(journal::Type::Breach);
+        copyPayload = true;
+      }
+      break;
+    case Module::Motor:
+      if (msg.header.opCode == 0x05 && n >= 2) { // MotorDone: status + locked
+        if (p[0] == static_cast<uint8_t>(transport::StatusCode::OK)) {
+          ev.type = uint8_t(p[1] ? journal::Type::Locked : journal::Type::Unlocked);
+        } else {
+          ev.type = uint8_t(journal::Type::MotorFail);
+          ev.fields[0] = p[0];
+          ev.len = 1;
+        }
+      }
+      break;
+    case Module::Fingerprint:
+      if (msg.header.opCode == 0x0A)      ev.type = uint8_t(journal::Type::FpMatch);
+      else if (msg.header.opCode == 0x0B) ev.type = uint8_t(journal::Type::FpFail);
+      copyPayload = true;
+      break;
+    default:
+      break;
   }
+  if (!ev.type) return;
+  if (copyPayload) {
+    ev.len = n > FlashJournal::kFields ? FlashJournal::kFields : uint8_t(n);
+    if (ev.len) memcpy(ev.fields, p, ev.len);
+  }
+  if (xQueueSend(journalQ_, &ev, 0) != pdPASS) {
+    DBG_PRINTF("[ESPNOW][journal] offline queue full, type=%s lost\n",
+                 journal::typeName(ev.type));
+    return;
+  }
+  wakeWorker_();
+}
 
-  String line;
-  line.reserve(prefix.length() + inner.length() + suffix.length());
-  line += prefix;
-  line += inner;
-  line += suffix;
+// Worker only: spools what journalOffline() queued.
+void EspNowManager::drainJournalQ_() {
+  if (!journalQ_) return;
+  JournalEvent ev;
+  while (xQueueReceive(journalQ_, &ev, 0) == pdPASS) {
+    (void)spoolImportant_(static_cast<journal::Type>(ev.type), ev.fields, ev.len);
+  }
+}
 
-  // Final safety: hard cap (shouldn’t trigger with above budgeting)
-  if (line.length() > MAX_NDJSON_LINE) {
-    DBG_PRINTF("[ESPNOW][journal] hard-cap %u->%u\n",
-                 (unsigned)line.length(), (unsigned)MAX_NDJSON_LINE);
-    // Keep valid JSON: drop inner entirely
-    line = String("{\"seq\":") + seqStr + ",\"type\":\"" +
-           (type ? type : "UNK") + "\",\"d\":{}}\n";
+// Appends one record to journal_. evict=false refuses instead of dropping
+// the oldest, and refuses once less than a worst-case record is left, so
+// staging from flash never skips a record it later acknowledges.
+bool EspNowManager::appendJournalRam_(uint32_t seq, uint8_t type, const uint8_t* fields,
+                                      uint8_t len, bool evict) {
+  if (journalCount_ == 0) {
+    journalBaseSeq_ = seq;
+    journalLastSeq_ = seq;
+  }
+  uint32_t delta = seq - journalLastSeq_;
+  size_t need = journal::recordSize(delta, len);
+  constexpr size_t kWorst = journal::kRecordFixed + journal::kMaxVarint + journal::kMaxFields;
+  if (!evict && journalLen_ + kWorst > sizeof(journal_)) return false;
+  while (journalCount_ && journalLen_ + need > sizeof(journal_)) {
+    dropOldestJournal_();
+    if (!journalCount_) {
+      journalBaseSeq_ = journalLastSeq_ = seq;
+      delta = 0;
+      need  = journal::recordSize(0, len);
+    }
   }
+  if (journalLen_ + need > sizeof(journal_)) return false;
 
-  // Append to RAM buffer and mark dirty
-  journalBuf_ += line;
+  journalLen_ += static_cast<uint16_t>(
+      journal::putRecord(journal_ + journalLen_, type, delta, fields, len));
+  journalLastSeq_ = seq;
   journalCount_++;
-  needsFlush_ = true;
-
-  DBG_PRINTF("[ESPNOW][journal] spool seq=%lu type=%s len=%u count=%u\n",
-               (unsigned long)seq_, type ? type : "UNK",
-               (unsigned)line.length(), (unsigned)journalCount_);
   return true;
 }
 
+void EspNowManager::resetJournalRam_() {
+  journalLen_ = 0;
+  journalCount_ = 0;
+}
+
+// Write-amplification reference: bytes the coalesced NVS blob would have
+// rewritten for the same records (whole blob on every save).
+void EspNowManager::noteNvsEquiv_(uint32_t seq, uint8_t len) {
+  nvsEquivLen_ += journal::recordSize(1, len);
+  if (nvsEquivLen_ > ESPNOW_JOURNAL_MAX_BYTES) nvsEquivLen_ = ESPNOW_JOURNAL_MAX_BYTES;
+  nvsEquivCount_++;
+  if (nvsEquivCount_ % JOURNAL_COALESCE_MAX == 0 ||
+      millis() - lastJournalSaveMs_ >= JOURNAL_COALESCE_MS) {
+    journalStats_.nvsEquivBytes += journal::varintSize(seq) + nvsEquivLen_;
+    lastJournalSaveMs_ = millis();
+  }
+}
+
+// Drop the first `count` records (`bytes` long, the last one at `seq`) once
+// they are replayed; the rest stays chained to `seq` as its new base.
+void EspNowManager::consumeJournal_(size_t bytes, uint32_t seq, uint16_t count) {
+  if (bytes >= journalLen_ || count >= journalCount_) {
+    resetJournalRam_();
+    journalBaseSeq_ = journalLastSeq_ = seq;
+    return;
+  }
+  memmove(journal_, journal_ + bytes, journalLen_ - bytes);
+  journalLen_    -= static_cast<uint16_t>(bytes);
+  journalCount_  -= count;
+  journalBaseSeq_ = seq;
+}
+
+// Evict the oldest record. The next delta was relative to the evicted seq,
+// which becomes the new base, so nothing else needs rewriting.
+void EspNowManager::dropOldestJournal_() {
+  journal::Record r;
+  const size_t n = journal::getRecord(journal_, journalLen_, r);
+  if (!n) {
+    journalLen_ = 0;
+    journalCount_ = 0;
+    return;
+  }
+  journalBaseSeq_ += r.seqDelta;
+  memmove(journal_, journal_ + n, journalLen_ - n);
+  journalLen_ -= static_cast<uint16_t>(n);
+  journalCount_--;
+  journalStats_.dropped++;
+}
+
 void EspNowManager::nvLoadJournal_() {
   if (!CONF) { DBG_PRINTLN("[ESPNOW][journal] nvLoadJournal_: Conf=null"); return; }
-  journalBuf_   = CONF->GetString(nvsKeyBuf_, "");
-  journalCount_ = (uint16_t)CONF->GetString(nvsKeyCnt_, "0").toInt();
+
+#if ESPNOW_JOURNAL_FLASH
+  // Warm wake: cursor and seq come from RTC memory, and the NVS blob was
+  // already moved to flash before the first sleep.
+  const WarmState::Block* warm = WarmState::get();
+  if (warm && warm->hasJournal && flashJournal_.resume(warm->journal)) {
+    resetJournalRam_();
+    if (seq_ < warm->journalSeq) seq_ = warm->journalSeq;
+    if (seq_ < flashJournal_.lastSeq()) seq_ = flashJournal_.lastSeq();
+    lastJournalSaveMs_ = millis();
+    return;
+  }
+#endif
+  // Pre-binary firmware kept an NDJSON string under another key.
+  if (CONF->GetString(nvsKeyOld_, "").length()) CONF->RemoveKey(nvsKeyOld_);
+
+  uint8_t blob[journal::kMaxVarint + ESPNOW_JOURNAL_MAX_BYTES];
+  const size_t n = CONF->GetBytes(nvsKeyBuf_, blob, sizeof(blob));
+  journalLen_ = 0;
+  journalCount_ = 0;
+  uint32_t base = 0;
+  const size_t h = n ? journal::getVarint(blob, n, base) : 0;
+  if (h) {
+    // Walk the records: count them, find the last seq, stop at any damage.
+    size_t off = h;
+    uint32_t seq = base;
+    journal::Record r;
+    while (off < n) {
+      const size_t used = journal::getRecord(blob + off, n - off, r);
+      if (!used || (off - h) + used > sizeof(journal_)) break;
+      off += used;
+      seq += r.seqDelta;
+      journalCount_++;
+    }
+    journalLen_ = static_cast<uint16_t>(off - h);
+    memcpy(journal_, blob + h, journalLen_);
+    journalBaseSeq_ = base;
+    journalLastSeq_ = seq;
+    if (seq_ < seq) seq_ = seq;
+  }
+  const uint32_t savedSeq = (uint32_t)CONF->GetString(nvsKeySeq_, "0").toInt();
+  if (seq_ < savedSeq) seq_ = savedSeq;
   lastJournalSaveMs_ = millis();
-  DBG_PRINTF("[ESPNOW][journal] nvLoad bufLen=%u count=%u\n",
-               (unsigned)journalBuf_.length(), (unsigned)journalCount_);
+  DBG_PRINTF("[ESPNOW][journal] nvLoad bytes=%u count=%u\n",
+               (unsigned)journalLen_, (unsigned)journalCount_);
+
+#if ESPNOW_JOURNAL_FLASH
+  if (!flashJournal_.begin()) return;
+  // Records still in the NVS blob move to the partition once.
+  if (journalCount_) {
+    size_t off = 0;
+    uint32_t seq = journalBaseSeq_;
+    journal::Record r;
+    while (off < journalLen_) {
+      const size_t used = journal::getRecord(journal_ + off, journalLen_ - off, r);
+      if (!used) break;
+      off += used;
+      seq += r.seqDelta;
+      const uint8_t n = r.len > FlashJournal::kFields ? FlashJournal::kFields : r.len;
+      if (seq > flashJournal_.lastSeq()) (void)flashJournal_.append(seq, r.type, r.fields, n);
+    }
+    CONF->PutBytes(nvsKeyBuf_, nullptr, 0);
+    CONF->PutString(nvsKeyCnt_, "0");
+    DBG_PRINTF("[ESPNOW][journal] moved %u NVS records to flash\n", (unsigned)journalCount_);
+  }
+  resetJournalRam_();
+  if (seq_ < flashJournal_.lastSeq()) seq_ = flashJournal_.lastSeq();
+#endif
+}
+
+bool EspNowManager::journalCursor(FlashJournal::Cursor& out, uint32_t& seq) {
+  seq = seq_;
+  return flashJournal_.cursor(out);
 }
 
 bool EspNowManager::nvSaveJournal_(const char* reason) {
   if (!CONF) { DBG_PRINTLN("[ESPNOW][journal] nvSaveJournal_: Conf=null"); return false; }
   if (!isConfigured_()) { DBG_PRINTLN("[ESPNOW][journal] skip save (unconfigured)"); return true; }
   if (!needsFlush_) { return true; }
-
-  CONF->PutString(nvsKeyBuf_, journalBuf_);
+  // Flash records are durable from append(); only seq is kept in NVS.
+  if (flashJournal_.ready()) { needsFlush_ = false; return true; }
+
+  uint8_t blob[journal::kMaxVarint + ESPNOW_JOURNAL_MAX_BYTES];
+  size_t n = 0;
+  if (journalCount_) {
+    n = journal::putVarint(blob, journalBaseSeq_);
+    memcpy(blob + n, journal_, journalLen_);
+    n += journalLen_;
+  }
+  CONF->PutBytes(nvsKeyBuf_, blob, n);
+  journalStats_.storeBytes    += n;
+  journalStats_.nvsEquivBytes += n;
   CONF->PutString(nvsKeyCnt_, String((int)journalCount_));
   CONF->PutString(nvsKeySeq_, String((unsigned long)seq_));
   needsFlush_ = false;
@@ -432,10 +806,10 @@ bool EspNowManager::nvSaveJournal_(const char* reason) {
 
 void EspNowManager::nvClearJournal_() {
   if (!CONF) { DBG_PRINTLN("[ESPNOW][journal] nvClearJournal_: Conf=null"); return; }
-  CONF->PutString(nvsKeyBuf_, "");
+  CONF->PutBytes(nvsKeyBuf_, nullptr, 0);
   CONF->PutString(nvsKeyCnt_, "0");
   // Keep seq_ growing; do not reset nvsKeySeq_
-  journalBuf_ = "";
+  journalLen_ = 0;
   journalCount_ = 0;
   needsFlush_ = false;
   DBG_PRINTLN("[ESPNOW][journal] Cleared NVS + RAM buffers");
@@ -443,37 +817,167 @@ void EspNowManager::nvClearJournal_() {
 
 size_t EspNowManager::flushJournalToMaster_() {
   if (!isConfigured_()) { DBG_PRINTLN("[ESPNOW][journal] flush: not configured"); return 0; }
+  if (flashJournal_.ready()) return flushFlashJournal_();
+  if (!journalCount_) return 0;
 
   // Ensure latest RAM -> NVS sync before we start
   (void)nvSaveJournal_("preflush");
 
-  // Combine any NVS content (safety) with RAM (already done in nvLoad/nvSave path)
-  String buf = journalBuf_;
-  size_t sent = 0;
-  int start = 0;
-  for (;;) {
-    int nl = buf.indexOf('\n', start);
-    if (nl < 0) break;
-    String line = buf.substring(start, nl);
-    start = nl + 1;
-    if (line.length() == 0) continue;
+  const size_t sent = (wireCaps() & NOW_WIRE_JOURNAL_BIN) ? replayJournalBinary_()
+                                                          : replayJournalNdjson_();
 
-    // Feed watchdog between journal lines; flush can span many events.
-    esp_task_wdt_reset();
+  // Replay consumed what it queued; keep the rest for the next flush.
+  if (journalCount_) {
+    needsFlush_ = true;
+    (void)nvSaveJournal_("partial flush");
+  } else {
+    nvClearJournal_();
+  }
+  DBG_PRINTF("[ESPNOW][journal] Flushed %u records to master (%u left)\n",
+             (unsigned)sent, (unsigned)journalCount_);
+  return sent;
+}
 
-    // Replay as EVT_GENERIC with NDJSON payload bytes
-    SendAck(EVT_GENERIC,
-            reinterpret_cast<const uint8_t*>(line.c_str()),
-            static_cast<size_t>(line.length()),
-            true);
-    ++sent;
+// Stages the next pending flash records in journal_ (from a cursor, so
+// each pass reads only its own slots), replays them and acknowledges up to
+// the last one once every frame was delivered; repeats until the
+// partition is drained. Anything not acked is resent by the next flush.
+size_t EspNowManager::flushFlashJournal_() {
+  size_t total = 0;
+  const bool bin = (wireCaps() & NOW_WIRE_JOURNAL_BIN) != 0;
+  flashReadPos_ = FlashJournal::kFromOldest;
+  while (flashJournal_.lastSeq() > flashJournal_.ackedSeq()) {
+    resetJournalRam_();
+    (void)flashJournal_.forEachPending(&EspNowManager::loadPendingJournal_, this, flashReadPos_);
+    if (!journalCount_) break;
+    const uint16_t staged = journalCount_;
+    beginJournalPass_();
+    total += bin ? replayJournalBinary_() : replayJournalNdjson_();
+    // Replay consumed what it queued: journalBaseSeq_ is the last one.
+    if (journalCount_ == staged) break;
+    if (!awaitJournalDelivery_(ESPNOW_JOURNAL_DELIVERY_MS)) {
+      DBG_PRINTLN("[ESPNOW][journal] flash replay not delivered; ack held");
+      break;
+    }
+    if (!flashJournal_.ack(journalBaseSeq_)) break;
+    journalStats_.storeBytes += FlashJournal::kSlotSize;
+    if (journalCount_) break;   // TX pool stayed full; resume on the next flush
+  }
+  resetJournalRam_();
+  if (CONF) CONF->PutString(nvsKeySeq_, String((unsigned long)seq_));
+  nvsEquivLen_ = 0;
+  nvsEquivCount_ = 0;
+  if (total) DBG_PRINTF("[ESPNOW][journal] Flushed %u flash records to master\n", (unsigned)total);
+  return total;
+}
 
-    // Pace a little to let sendQ drain
-    vTaskDelay(pdMS_TO_TICKS(5));
+// Stops the walk at the first record journal_ has no room for.
+bool EspNowManager::loadPendingJournal_(void* ctx, uint32_t seq, uint8_t type,
+                                        const uint8_t* fields, uint8_t len) {
+  auto* self = static_cast<EspNowManager*>(ctx);
+  return self->appendJournalRam_(seq, type, fields, len, false);
+}
+
+// EVT_JOURNAL: as many whole records per frame as fit; every frame carries
+// its own base seq so a lost frame does not corrupt the next one. Stops at
+// the first frame the TX pool cannot take; the queued records are consumed.
+size_t EspNowManager::replayJournalBinary_() {
+  uint8_t frame[kJournalFrameMax];
+  size_t  off = 0;        // end of the records queued so far
+  size_t  sent = 0;
+  uint32_t seq = journalBaseSeq_;
+  journal::Record r;
+
+  while (off < journalLen_) {
+    esp_task_wdt_reset();
+    // Frame header: count + base (seq of the record before this frame).
+    size_t   fl = 1 + journal::putVarint(frame + 1, seq);
+    size_t   end = off;
+    uint32_t endSeq = seq;
+    size_t   ndjson = 0;      // NDJSON equivalent of this frame (stats)
+    uint32_t ndjsonAir = 0;
+    uint8_t  count = 0;
+    while (end < journalLen_ && count < 0xFF) {
+      const size_t used = journal::getRecord(journal_ + end, journalLen_ - end, r);
+      if (!used) break;                            // damaged tail: stop
+      if (fl + used > sizeof(frame)) break;
+      memcpy(frame + fl, journal_ + end, used);
+      fl  += used;
+      end += used;
+      endSeq += r.seqDelta;
+      const size_t nl = ndjsonSize_(endSeq, r);
+      ndjson    += nl;
+      ndjsonAir += airtimeUs_(nl);
+      ++count;
+    }
+    if (!count) { off = journalLen_; break; }     // damaged tail: drop it
+    frame[0] = count;
+    if (!sendJournal_(EVT_JOURNAL, frame, fl)) {
+      DBG_PRINTLN("[ESPNOW][journal] replay stopped: frame not queued");
+      break;
+    }
+    noteJournalFrame_(fl, false);
+    journalStats_.ndjsonFrames    += count;
+    journalStats_.ndjsonBytes     += ndjson;
+    journalStats_.ndjsonAirtimeUs += ndjsonAir;
+    off  = end;
+    seq  = endSeq;
+    sent += count;
   }
+  consumeJournal_(off, seq, static_cast<uint16_t>(sent));
+  journalStats_.replayed += sent;
+  return sent;
+}
 
-  // Clear after enqueueing
-  nvClearJournal_();
-  DBG_PRINTF("[ESPNOW][journal] Flushed %u lines to master\n", (unsigned)sent);
+// Legacy masters: one NDJSON line per EVT_GENERIC, paced. Stops like the
+// binary replay when a line cannot be queued.
+size_t EspNowManager::replayJournalNdjson_() {
+  size_t off = 0;
+  size_t sent = 0;
+  uint16_t consumed = 0;   // records queued or skipped (unrenderable)
+  uint32_t seq = journalBaseSeq_;
+  journal::Record r;
+  char line[MAX_NDJSON_LINE + 1];
+
+  while (off < journalLen_) {
+    const size_t used = journal::getRecord(journal_ + off, journalLen_ - off, r);
+    if (!used) { off = journalLen_; break; }   // damaged tail: drop it
+    const uint32_t recSeq = seq + r.seqDelta;
+    const size_t n = renderNdjson_(line, sizeof(line), recSeq, r);
+    if (n) {
+      // Feed watchdog between journal lines; flush can span many events.
+      esp_task_wdt_reset();
+
+      // Replay as EVT_GENERIC with NDJSON payload bytes
+      if (!sendJournal_(EVT_GENERIC, reinterpret_cast<const uint8_t*>(line), n)) {
+        DBG_PRINTLN("[ESPNOW][journal] replay stopped: line not queued");
+        break;
+      }
+      noteJournalFrame_(n, false);
+      noteJournalFrame_(n, true);
+      ++sent;
+
+      // Pace a little to let the TX pool drain
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    off += used;
+    seq  = recSeq;
+    ++consumed;
+  }
+  consumeJournal_(off, seq, consumed);
+  journalStats_.replayed += sent;
   return sent;
 }
+
+void EspNowManager::noteJournalFrame_(size_t payloadLen, bool ndjsonEquiv) {
+  JournalStats& st = journalStats_;
+  if (ndjsonEquiv) {
+    st.ndjsonFrames++;
+    st.ndjsonBytes     += payloadLen;
+    st.ndjsonAirtimeUs += airtimeUs_(payloadLen);
+  } else {
+    st.frames++;
+    st.bytes     += payloadLen;
+    st.airtimeUs += airtimeUs_(payloadLen);
+  }
+}
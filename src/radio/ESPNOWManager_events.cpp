@@ -1,14 +1,27 @@
 #include <ESPNOWManager.hpp>
 #include <CommandAPI.hpp>
 #include <ConfigNvs.hpp>
-#include <NVSManager.hpp>
+#include <BridgeTable.hpp>
 #include <Transport.hpp>
 #include <Utils.hpp>
 
 // =============================================================
 //  Transport -> CommandAPI bridge (Responses/Events to ACK_*)
 // =============================================================
+// Legacy masters only: native masters (NOW_WIRE_TRANSPORT negotiated at
+// pairing) receive the transport frame itself and never reach this code.
 namespace {
+using transport::Module;
+using bridge::Xlate;
+using bridge::XlateEntry;
+using bridge::xkey;
+
+// FP enrollment stage (1..8) -> ACK opcode.
+constexpr uint16_t kEnrollAck[] = {
+  ACK_FP_ENROLL_START, ACK_FP_ENROLL_CAP1, ACK_FP_ENROLL_LIFT, ACK_FP_ENROLL_CAP2,
+  ACK_FP_ENROLL_STORING, ACK_FP_ENROLL_OK, ACK_FP_ENROLL_FAIL, ACK_FP_ENROLL_TIMEOUT,
+};
+
 bool isStatusOk_(const transport::TransportMessage& msg, size_t minPayload = 1) {
   if (msg.payload.size() < minPayload) return false;
   return msg.payload[0] == static_cast<uint8_t>(transport::StatusCode::OK);
@@ -19,306 +32,160 @@ bool EspNowManager::handleTransportTx(const transport::TransportMessage& msg) {
   // Only translate messages destined to master (destId=1).
   if (msg.header.destId != 1) return false;
 
-  auto sendResp = [this](uint16_t opcode, const uint8_t* payload, size_t len, bool ok = true) {
-    SendAck(opcode, payload, len, ok);
-  };
-  auto sendRespNoPayload = [this](uint16_t opcode, bool ok = true) {
-    SendAck(opcode, ok);
-  };
-
-  const uint8_t mod = msg.header.module;
-  const uint8_t op  = msg.header.opCode;
-  const auto& pl    = msg.payload;
-  const auto statusOk = isStatusOk_(msg);
-
-  // ---------- Device module ----------
-  if (mod == static_cast<uint8_t>(transport::Module::Device)) {
-    switch (op) {
-      case 0x02: // StateQuery Response
-      case 0x09: // StateReport Event
-        sendState("TRSPRT");
-        return true;
-      case 0x01: // ConfigMode Response
-        sendRespNoPayload(ACK_TEST_MODE, statusOk);
+  const auto& pl = msg.payload;
+  const XlateEntry* e = bridge::findXlate(static_cast<uint16_t>((msg.header.module << 8) | msg.header.opCode));
+  if (e) {
+    const bool statusOk = isStatusOk_(msg);
+    switch (e->kind) {
+      case Xlate::Status:
+        SendAck(e->ack, statusOk);
         return true;
-      case 0x03: { // ConfigStatus Response
-        if (pl.size() >= 2) {
-          const bool configured = pl[1] != 0;
-          sendRespNoPayload(configured ? ACK_CONFIGURED : ACK_NOT_CONFIGURED, configured);
-          return true;
-        }
-        break;
-      }
-      case 0x04: // Arm Response
-        sendRespNoPayload(ACK_ARMED, statusOk);
-        return true;
-      case 0x05: // Disarm Response
-        sendRespNoPayload(ACK_DISARMED, statusOk);
+      case Xlate::StatusPick:
+        SendAck(statusOk ? e->ack : e->alt, statusOk);
         return true;
-      case 0x07: // CapsSet Response
-        sendRespNoPayload(ACK_CAP_SET, statusOk);
+      case Xlate::EventOk:
+        SendAck(e->ack, true);
         return true;
-      case 0x08: { // CapsQuery Response
-        if (pl.size() >= 2) {
-          uint8_t bits = pl[1];
-          setCapBitsShadow_(bits);
-          sendResp(ACK_CAPS, &bits, 1, statusOk);
-          return true;
-        }
-        break;
-      }
-      case 0x0C: // NvsWrite Response
-        if (pendingLockEmag_ >= 0) {
-          sendRespNoPayload(pendingLockEmag_ ? ACK_LOCK_EMAG_ON : ACK_LOCK_EMAG_OFF, statusOk);
-          pendingLockEmag_ = -1;
-          return true;
-        }
-        sendRespNoPayload(ACK_CAP_SET, statusOk);
+      case Xlate::EventFail:
+        SendAck(e->ack, false);
         return true;
-      case 0x0B: { // PairingStatus Response
+      case Xlate::Flag:
         if (pl.size() >= 2) {
-          const bool configured = pl[1] != 0;
-          sendRespNoPayload(configured ? ACK_CONFIGURED : ACK_NOT_CONFIGURED, configured);
+          const bool flag = pl[1] != 0;
+          SendAck(flag ? e->ack : e->alt, flag);
           return true;
         }
         break;
-      }
-      case 0x0D: // Heartbeat Response
-      case 0x17: { // Ping Response
-        if (pl.size() >= 7) {
-          uint32_t up = (uint32_t)pl[1] | ((uint32_t)pl[2] << 8) |
-                        ((uint32_t)pl[3] << 16) | ((uint32_t)pl[4] << 24);
-          uint16_t seq16 = (uint16_t)pl[5] | ((uint16_t)pl[6] << 8);
-          struct HeartbeatPayload {
-            uint32_t seq_le;
-            uint32_t up_ms_le;
-          } payload{};
-          payload.seq_le = seq16;
-          payload.up_ms_le = up;
-          sendResp(ACK_HEARTBEAT,
-                   reinterpret_cast<const uint8_t*>(&payload),
-                   sizeof(payload),
-                   statusOk);
+      case Xlate::ReasonOk:
+        SendAck(e->ack, pl.empty() || pl[0] == 0);
+        return true;
+      case Xlate::Byte0Event:
+        if (pl.empty()) SendAck(e->ack, false);
+        else            SendAck(e->ack, pl.data(), 1, false);
+        return true;
+      case Xlate::Copy:
+      case Xlate::CopyEvent:
+        if (pl.size() >= static_cast<size_t>(e->off) + e->len) {
+          SendAck(e->ack, pl.data() + e->off, e->len,
+                  e->kind == Xlate::Copy ? statusOk : false);
           return true;
         }
         break;
-      }
-      case 0x0E: // UnlockRequest Event
-        sendRespNoPayload(EVT_GENERIC, false);
-        return true;
-      case 0x0F: { // AlarmRequest Event
-        uint8_t reason = (pl.size() >= 1) ? pl[0] : 0;
-        if (reason == 0) sendRespNoPayload(EVT_BREACH, true);
-        else             sendRespNoPayload(EVT_MTRTTRG, false);
-        return true;
-      }
-      case 0x10: // DriverFar
-        sendRespNoPayload(ACK_DRIVER_FAR, true);
-        return true;
-      case 0x15: // CancelTimers Response
-        sendRespNoPayload(ACK_TMR_CANCELLED, statusOk);
-        return true;
-      case 0x16: // SetRole Response
-        sendRespNoPayload(ACK_ROLE, statusOk);
-        return true;
-      case 0x11: // LockCanceled
-        sendRespNoPayload(ACK_LOCK_CANCELED, pl.size() ? (pl[0] == 0) : true);
-        return true;
-      case 0x12: // AlarmOnlyMode
-        sendRespNoPayload(ACK_ALARM_ONLY_MODE, pl.size() ? (pl[0] == 0) : true);
-        return true;
-      case 0x14: // CriticalPower
-        sendRespNoPayload(EVT_CRITICAL, false);
-        return true;
-      default:
+      case Xlate::Special:
+        if (translateSpecial_(msg, e->ack, e->alt, statusOk)) return true;
         break;
     }
   }
 
-  // ---------- Motor module ----------
-  if (mod == static_cast<uint8_t>(transport::Module::Motor)) {
-    if (op == 0x01 || op == 0x02) { // Lock/Unlock response
+  // Not handled: swallow to prevent raw transport frames reaching master.
+  DBG_PRINTF("[ESPNOW][TRSPRT] Unhandled response mod=0x%02X op=0x%02X len=%u\n",
+               (unsigned)msg.header.module, (unsigned)msg.header.opCode, (unsigned)pl.size());
+  return true;
+}
+
+// Entries that depend on manager state (pending force/EMAG ACKs, cap shadow)
+// or reshape the payload. Returns false when the payload is too short.
+bool EspNowManager::translateSpecial_(const transport::TransportMessage& msg,
+                                      uint16_t ack, uint16_t alt, bool statusOk) {
+  const uint8_t mod = msg.header.module;
+  const uint8_t op  = msg.header.opCode;
+  const auto&   pl  = msg.payload;
+
+  switch (xkey(static_cast<Module>(mod), op)) {
+    case xkey(Module::Device, 0x02): // StateQuery Response: status + state record
+      if (pl.size() < 1 + transport::kStateRecordSize) return false;
+      sendStateRecord_(pl.data() + 1, "TRSPRT");
+      return true;
+    case xkey(Module::Device, 0x09): // StateReport Event: state record
+      if (pl.size() < transport::kStateRecordSize) return false;
+      sendStateRecord_(pl.data(), "TRSPRT");
+      return true;
+    case xkey(Module::Device, 0x08): { // CapsQuery Response
+      if (pl.size() < 2) return false;
+      uint8_t bits = pl[1];
+      setCapBitsShadow_(bits);
+      SendAck(ack, &bits, 1, statusOk);
+      return true;
+    }
+    case xkey(Module::Device, 0x0C): // NvsWrite Response
+      if (pendingLockEmag_ >= 0) {
+        SendAck(pendingLockEmag_ ? ACK_LOCK_EMAG_ON : ACK_LOCK_EMAG_OFF, statusOk);
+        pendingLockEmag_ = -1;
+        return true;
+      }
+      SendAck(ack, statusOk);
+      return true;
+    case xkey(Module::Device, 0x0D):   // Heartbeat Response
+    case xkey(Module::Device, 0x17): { // Ping Response
+      if (pl.size() < 7) return false;
+      uint32_t up = (uint32_t)pl[1] | ((uint32_t)pl[2] << 8) |
+                    ((uint32_t)pl[3] << 16) | ((uint32_t)pl[4] << 24);
+      uint16_t seq16 = (uint16_t)pl[5] | ((uint16_t)pl[6] << 8);
+      struct HeartbeatPayload {
+        uint32_t seq_le;
+        uint32_t up_ms_le;
+      } payload{};
+      payload.seq_le = seq16;
+      payload.up_ms_le = up;
+      SendAck(ack, reinterpret_cast<const uint8_t*>(&payload), sizeof(payload), statusOk);
+      return true;
+    }
+    case xkey(Module::Device, 0x0F): { // AlarmRequest Event
+      const uint8_t reason = pl.empty() ? 0 : pl[0];
+      if (reason == 0) SendAck(ack, true);
+      else             SendAck(alt, false);
+      return true;
+    }
+    case xkey(Module::Motor, 0x01):  // Lock response
+    case xkey(Module::Motor, 0x02):  // Unlock response
       if (!statusOk) {
         pendingForceAck_ = 0;
-        sendRespNoPayload(ACK_LOCK_CANCELED, false);
-        return true;
+        SendAck(ack, false);
       }
       return true; // success: wait for MotorDone event
-    }
-    if (op == 0x05) { // MotorDone event
-      if (pl.size() >= 2) {
-        bool locked = pl[1] != 0;
-        if (pendingForceAck_ == 1) {
-          sendRespNoPayload(ACK_FORCE_LOCKED, statusOk);
-          pendingForceAck_ = 0;
-          return true;
-        }
-        if (pendingForceAck_ == 2) {
-          sendRespNoPayload(ACK_FORCE_UNLOCKED, statusOk);
-          pendingForceAck_ = 0;
-          return true;
-        }
-        sendRespNoPayload(locked ? ACK_LOCKED : ACK_UNLOCKED, statusOk);
+    case xkey(Module::Motor, 0x05): { // MotorDone event
+      if (pl.size() < 2) return false;
+      if (pendingForceAck_ == 1 || pendingForceAck_ == 2) {
+        SendAck(pendingForceAck_ == 1 ? ACK_FORCE_LOCKED : ACK_FORCE_UNLOCKED, statusOk);
+        pendingForceAck_ = 0;
         return true;
       }
-    }
-  }
-
-  // ---------- Shock module ----------
-  if (mod == static_cast<uint8_t>(transport::Module::Shock)) {
-    if (op == 0x03) {
-      const bool motionEnabled = (CONF && CONF->GetBool(MOTION_TRIG_ALARM, false));
-      DBG_PRINT("[ESPNOW][TX] shock sensor triggered (motion ");
-      DBG_PRINT(motionEnabled ? "enabled" : "disabled");
-      DBG_PRINTLN(")");
-      sendRespNoPayload(EVT_MTRTTRG, false);
+      SendAck(pl[1] != 0 ? ack : alt, statusOk);
       return true;
     }
-    if (op == 0x10) {
+    case xkey(Module::Shock, 0x10): // SensorType response
       if (!statusOk && pl.size() >= 2 && pl[1] == 0x01) {
-        sendRespNoPayload(ACK_SHOCK_INT_MISSING, false);
+        SendAck(alt, false);
         return true;
       }
-      sendRespNoPayload(ACK_SHOCK_SENSOR_TYPE_SET, statusOk);
-      return true;
-    }
-    if (op == 0x11) {
-      sendRespNoPayload(ACK_SHOCK_SENS_THRESHOLD_SET, statusOk);
-      return true;
-    }
-    if (op == 0x12) {
-      sendRespNoPayload(ACK_SHOCK_L2D_CFG_SET, statusOk);
+      SendAck(ack, statusOk);
       return true;
-    }
-  }
-
-  // ---------- Switch/Reed module ----------
-  if (mod == static_cast<uint8_t>(transport::Module::SwitchReed)) {
-    if (op == 0x01 && pl.size() >= 1) { // DoorEdge
+    case xkey(Module::SwitchReed, 0x01): { // DoorEdge
+      if (pl.empty()) return false;
       uint8_t open = pl[0] ? 1 : 0;
-      sendResp(EVT_REED, &open, 1, false);
+      SendAck(ack, &open, 1, false);
       return true;
     }
-    if (op == 0x02) { // OpenRequest
-      sendRespNoPayload(EVT_GENERIC, false);
-      return true;
-    }
-  }
-
-  // ---------- Power module ----------
-  if (mod == static_cast<uint8_t>(transport::Module::Power)) {
-    if (op == 0x02) { // LowBatt
-      if (!pl.empty()) {
-        sendResp(EVT_LWBT, &pl[0], 1, false);
-      } else {
-        sendRespNoPayload(EVT_LWBT, false);
+    case xkey(Module::Fingerprint, 0x0B): { // Fail/busy/no-sensor/tamper
+      if (pl.empty()) return false;
+      uint8_t reason = pl[0];
+      if (pl.size() >= 2 && reason > 3) reason = pl[1];
+      switch (reason) {
+        case 0: SendAck(ack,              false); return true;
+        case 1: SendAck(ACK_FP_NO_SENSOR, false); return true;
+        case 2: SendAck(ACK_FP_BUSY,      false); return true;
+        case 3: SendAck(ACK_ERR_TOKEN,    false); return true;
+        default: return false;
       }
-      return true;
     }
-    if (op == 0x03) { // CriticalBatt
-      if (!pl.empty()) {
-        sendResp(EVT_CRITICAL, &pl[0], 1, false);
-      } else {
-        sendRespNoPayload(EVT_CRITICAL, false);
-      }
+    case xkey(Module::Fingerprint, 0x0C): { // EnrollProgress
+      if (pl.size() < 4) return false;
+      const uint8_t stage = pl[0];
+      if (stage < 1 || stage > sizeof(kEnrollAck) / sizeof(kEnrollAck[0])) return false;
+      SendAck(kEnrollAck[stage - 1], pl[3] == 0);
       return true;
     }
+    default:
+      return false;
   }
-
-  // ---------- Fingerprint module ----------
-  if (mod == static_cast<uint8_t>(transport::Module::Fingerprint)) {
-    switch (op) {
-      case 0x01: // VerifyOn response
-        sendRespNoPayload(ACK_FP_VERIFY_ON, statusOk);
-        return true;
-      case 0x02: // VerifyOff response
-        sendRespNoPayload(ACK_FP_VERIFY_OFF, statusOk);
-        return true;
-      case 0x0A: { // MatchEvent
-        if (pl.size() >= 3) {
-          uint8_t out[3] = {pl[0], pl[1], pl[2]};
-          sendResp(EVT_FP_MATCH, out, sizeof(out), false);
-          return true;
-        }
-        break;
-      }
-      case 0x0B: { // Fail/busy/no-sensor/tamper
-        if (pl.empty()) break;
-        uint8_t reason = pl[0];
-        if (pl.size() >= 2 && reason > 3) {
-          reason = pl[1];
-        }
-        switch (reason) {
-          case 0: sendRespNoPayload(EVT_FP_FAIL, false);          return true;
-          case 1: sendRespNoPayload(ACK_FP_NO_SENSOR,     false); return true;
-          case 2: sendRespNoPayload(ACK_FP_BUSY,          false); return true;
-          case 3: sendRespNoPayload(ACK_ERR_TOKEN,        false); return true;
-          default: break;
-        }
-        break;
-      }
-      case 0x0C: { // EnrollProgress
-        if (pl.size() < 4) break;
-        uint8_t stage = pl[0];
-        uint8_t status = pl[3];
-        uint16_t ack = 0;
-        switch (stage) {
-          case 1: ack = ACK_FP_ENROLL_START;   break;
-          case 2: ack = ACK_FP_ENROLL_CAP1;    break;
-          case 3: ack = ACK_FP_ENROLL_LIFT;    break;
-          case 4: ack = ACK_FP_ENROLL_CAP2;    break;
-          case 5: ack = ACK_FP_ENROLL_STORING; break;
-          case 6: ack = ACK_FP_ENROLL_OK;      break;
-          case 7: ack = ACK_FP_ENROLL_FAIL;    break;
-          case 8: ack = ACK_FP_ENROLL_TIMEOUT; break;
-          default: break;
-        }
-        if (ack != 0) {
-          sendRespNoPayload(ack, status == 0);
-          return true;
-        }
-        break;
-      }
-      case 0x06: { // QueryDb response
-        if (pl.size() >= 5) {
-          uint8_t out[4] = {pl[1], pl[2], pl[3], pl[4]};
-          sendResp(ACK_FP_DB_INFO, out, sizeof(out), statusOk);
-          return true;
-        }
-        break;
-      }
-      case 0x07: { // NextId response
-        if (pl.size() >= 3) {
-          uint8_t out[2] = {pl[1], pl[2]};
-          sendResp(ACK_FP_NEXT_ID, out, sizeof(out), statusOk);
-          return true;
-        }
-        break;
-      }
-      case 0x04: { // DeleteId response
-        if (pl.size() >= 3) {
-          uint8_t out[2] = {pl[1], pl[2]};
-          sendResp(ACK_FP_ID_DELETED, out, sizeof(out), statusOk);
-          return true;
-        }
-        break;
-      }
-      case 0x05: // ClearDb response
-        sendRespNoPayload(ACK_FP_DB_CLEARED, statusOk);
-        return true;
-      case 0x08: // AdoptSensor response
-        sendRespNoPayload(statusOk ? ACK_FP_ADOPT_OK : ACK_FP_ADOPT_FAIL, statusOk);
-        return true;
-      case 0x09: // ReleaseSensor response
-        sendRespNoPayload(statusOk ? ACK_FP_RELEASE_OK : ACK_FP_RELEASE_FAIL, statusOk);
-        return true;
-      default:
-        break;
-    }
-  }
-
-  // Not handled: swallow to prevent raw transport frames reaching master.
-  DBG_PRINTF("[ESPNOW][TRSPRT] Unhandled response mod=0x%02X op=0x%02X len=%u\n",
-               (unsigned)mod, (unsigned)op, (unsigned)pl.size());
-  return true;
 }
@@ -0,0 +1,192 @@
+#include <ESPNOWManager.hpp>
+#include <CommandAPI.hpp>
+#include <ConfigNvs.hpp>
+#include <NVSManager.hpp>
+#include <Utils.hpp>
+#include <esp_wifi.h>
+#include <string.h>
+
+// =============================================================
+//  RSSI capture (promiscuous RX metadata)
+// =============================================================
+// ESP-NOW's receive callback carries no RSSI on this core, so management
+// frames are sniffed as well: ESP-NOW rides in vendor-specific action frames
+// (category 0x7F, Espressif OUI 18:FE:34). Only frames from a known master
+// are sampled; everything else returns after a few byte compares.
+void EspNowManager::onPromiscRx_(void* buf, wifi_promiscuous_pkt_type_t type) {
+  if (!instance || !buf || type != WIFI_PKT_MGMT) return;
+  const auto* pkt = static_cast<const wifi_promiscuous_pkt_t*>(buf);
+  const uint8_t* p = pkt->payload;
+  if (pkt->rx_ctrl.sig_len < 28) return;
+  if (p[0] != 0xD0) return;                                      // action frame
+  if (p[24] != 0x7F) return;                                     // vendor specific
+  if (p[25] != 0x18 || p[26] != 0xFE || p[27] != 0x34) return;   // Espressif OUI
+  if (!instance->isKnownMasterMac_(p + 10)) return;              // addr2 = sender
+  instance->noteRssi_(static_cast<int8_t>(pkt->rx_ctrl.rssi));
+}
+
+// Cached identities only: never loads NVS from the Wi-Fi task.
+bool EspNowManager::isKnownMasterMac_(const uint8_t* mac) {
+  bool known = false;
+  taskENTER_CRITICAL(&peerMux_);
+  if (peerCacheLoaded_) {
+    known = (peerCache_.valid && memcmp(peerCache_.mac, mac, 6) == 0) ||
+            (standbyCache_.valid && memcmp(standbyCache_.mac, mac, 6) == 0);
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+  return known;
+}
+
+void EspNowManager::noteRssi_(int8_t rssi) {
+  taskENTER_CRITICAL(&linkMux_);
+  rssiWin_[rssiHead_] = rssi;
+  rssiHead_ = static_cast<uint8_t>((rssiHead_ + 1) % ESPNOW_RSSI_WINDOW);
+  if (rssiCount_ < ESPNOW_RSSI_WINDOW) rssiCount_++;
+  int16_t sum = 0;
+  int8_t  lo  = rssi;
+  int8_t  hi  = rssi;
+  for (uint8_t i = 0; i < rssiCount_; ++i) {
+    const int8_t v = rssiWin_[i];
+    sum += v;
+    if (v < lo) lo = v;
+    if (v > hi) hi = v;
+  }
+  link_.rssiLast = rssi;
+  link_.rssiAvg  = static_cast<int8_t>(sum / rssiCount_);
+  link_.rssiMin  = lo;
+  link_.rssiMax  = hi;
+  link_.rssiSamples++;
+  taskEXIT_CRITICAL(&linkMux_);
+  updateLinkScore_();
+}
+
+void EspNowManager::updateLinkScore_() {
+  LinkQuality& q = link_;
+  const uint32_t rttMs   = q.rttEwmaUs / 1000;
+  const int32_t  rttPen  = rttMs > 20 ? 20 : int32_t(rttMs);
+  const int32_t  weak    = (q.rssiSamples && q.rssiAvg < -80) ? (-80 - q.rssiAvg) : 0;
+  const int32_t  rssiPen = weak > 20 ? 20 : weak;
+  const int32_t  score   = int32_t(q.deliveryPermille / 10) - rttPen - rssiPen;
+  q.score = static_cast<uint8_t>(score < 0 ? 0 : (score > 100 ? 100 : score));
+}
+
+void EspNowManager::linkStatsPayload(AckLinkStatsPayload& out) const {
+  const LinkQuality& q = link_;
+  memset(&out, 0, sizeof(out));
+  out.rssi_last       = q.rssiLast;
+  out.rssi_avg        = q.rssiAvg;
+  out.rssi_min        = q.rssiMin;
+  out.rssi_max        = q.rssiMax;
+  out.channel         = channel_;
+  out.score           = q.score;
+  out.online          = online_ ? 1 : 0;
+  out.fail_streak     = q.failStreak;
+  out.delivery_pm_le  = q.deliveryPermille;
+  out.rtt_us_le       = q.rttEwmaUs;
+  out.rescans_le      = q.rescans;
+  out.rescan_found_le = q.rescanFound;
+  for (int i = 0; i < ESPNOW_RTT_BUCKETS; ++i) {
+    out.rtt_hist_le[i] = q.rttHist[i] > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(q.rttHist[i]);
+  }
+}
+
+// =============================================================
+//  Channel re-discovery
+// =============================================================
+bool EspNowManager::requestChannelRescan() {
+  if (!isConfigured_() || rescan_.active) return false;
+  startRescan_(true);
+  wakeWorker_();
+  return true;
+}
+
+void EspNowManager::startRescan_(bool manual) {
+  uint8_t cur = 0;
+  wifi_second_chan_t second = WIFI_SECOND_CHAN_NONE;
+  if (esp_wifi_get_channel(&cur, &second) != ESP_OK) cur = channel_;
+
+  // Last known good channel first, then the rest in order.
+  PeerIdentity id;
+  (void)masterIdentity(id);
+  const uint8_t stored = id.channel;
+  uint8_t n = 0;
+  if (stored >= 1 && stored <= ESPNOW_CHANNEL_MAX) rescan_.order[n++] = stored;
+  for (uint8_t ch = 1; ch <= ESPNOW_CHANNEL_MAX; ++ch) {
+    if (ch != stored) rescan_.order[n++] = ch;
+  }
+
+  rescan_.count        = n;
+  rescan_.idx          = 0;
+  rescan_.origChannel  = cur;
+  rescan_.manual       = manual;
+  rescan_.delivered    = false;
+  rescan_.dwellStartMs = 0;
+  rescan_.everRan      = true;
+  rescan_.active       = true;
+  link_.rescans++;
+  DBG_PRINTF("[ESPNOW][rescan] start (%s) from ch=%u fails=%u\n",
+             manual ? "manual" : "auto", (unsigned)cur, (unsigned)link_.txFailStreak);
+}
+
+// One channel per dwell: hop, probe, and wait for a delivery report.
+void EspNowManager::rescanTick_(uint32_t now) {
+  if (!rescan_.active) return;
+
+  if (rescan_.dwellStartMs && rescan_.delivered) {
+    const uint8_t ch = channel_;
+    rescan_.active    = false;
+    rescan_.lastEndMs = now;
+    link_.rescanFound++;
+    if (CONF) {
+      CONF->PutInt(MASTER_CHANNEL_KEY, static_cast<int>(ch));
+      invalidatePeerCache();
+    }
+    DBG_PRINTF("[ESPNOW][rescan] master answered on ch=%u (saved)\n", (unsigned)ch);
+    return;
+  }
+  if (rescan_.dwellStartMs && now - rescan_.dwellStartMs < ESPNOW_RESCAN_DWELL_MS) return;
+
+  if (rescan_.idx >= rescan_.count) {
+    (void)applyChannel_(rescan_.origChannel);
+    rescan_.active    = false;
+    rescan_.lastEndMs = now;
+    nextPingDueMs_    = now + pingBackoffMs_;
+    DBG_PRINTF("[ESPNOW][rescan] no answer; back to ch=%u\n", (unsigned)rescan_.origChannel);
+    return;
+  }
+
+  const uint8_t ch = rescan_.order[rescan_.idx++];
+  rescan_.delivered    = false;
+  rescan_.dwellStartMs = now ? now : 1;
+  if (!applyChannel_(ch)) return;   // next channel after the dwell
+  link_.probes++;
+  sendHeartbeat(true);
+}
+
+// Milliseconds until rescanTick_() has work (UINT32_MAX = idle).
+uint32_t EspNowManager::rescanWaitMs_(uint32_t now) const {
+  if (!rescan_.active) return UINT32_MAX;
+  if (!rescan_.dwellStartMs || rescan_.delivered) return 0;
+  const uint32_t elapsed = now - rescan_.dwellStartMs;
+  return elapsed >= ESPNOW_RESCAN_DWELL_MS ? 0 : ESPNOW_RESCAN_DWELL_MS - elapsed;
+}
+
+bool EspNowManager::applyChannel_(uint8_t channel) {
+  if (channel < 1 || channel > ESPNOW_CHANNEL_MAX) return false;
+  if (esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE) != ESP_OK) {
+    DBG_PRINTF("[ESPNOW][rescan] set channel %u failed\n", (unsigned)channel);
+    return false;
+  }
+  channel_ = channel;
+  // Peers pinned to the old channel would refuse to send.
+  PeerIdentity id;
+  for (int standby = 0; standby < 2; ++standby) {
+    if (!identity_(standby != 0, id)) continue;
+    esp_now_peer_info_t info = {};
+    if (esp_now_get_peer(id.mac, &info) == ESP_OK && info.channel != 0) {
+      info.channel = channel;
+      (void)esp_now_mod_peer(&info);
+    }
+  }
+  return true;
+}
@@ -18,7 +18,8 @@ bool parsePairInit_(const uint8_t* data,
                     size_t len,
                     uint8_t& capsOut,
                     uint32_t& seedOut,
-                    bool& shockExternalOut) {
+                    bool& shockExternalOut,
+                    uint8_t& wireOut) {
   if (!data || len < kPairInitPayloadLen) {
     return false;
   }
@@ -40,6 +41,8 @@ bool parsePairInit_(const uint8_t* data,
   capsOut = caps;
   seedOut = seed;
   shockExternalOut = (shockExt != 0);
+  // Optional trailing wire-caps byte; absent on legacy masters.
+  wireOut = (len > kPairInitPayloadLen) ? data[kPairInitPayloadLen] : 0;
   return true;
 }
 
@@ -92,7 +95,7 @@ uint8_t EspNowManager::getDefaultChannel_() {
 // =============================================================
 //  Peer Management / Send
 // =============================================================
-esp_err_t EspNowManager::registerPeer(const uint8_t* peer_addr, bool encrypt) {
+esp_err_t EspNowManager::registerPeer(const uint8_t* peer_addr, bool encrypt, const uint8_t* lmk) {
   if (!peer_addr) {
     DBG_PRINTLN("[ESPNOW][registerPeer] Invalid arg: peer_addr=null");
     return ESP_ERR_INVALID_ARG;
@@ -107,23 +110,20 @@ esp_err_t EspNowManager::registerPeer(const uint8_t* peer_addr, bool encrypt) {
   memcpy(peerInfo.peer_addr, peer_addr, ESP_NOW_ETH_ALEN);
   peerInfo.channel = channel_;
   peerInfo.encrypt = encrypt;
-  if (encrypt) {
+  if (encrypt && lmk) {
+    memcpy(peerInfo.lmk, lmk, sizeof(peerInfo.lmk));
+  } else if (encrypt) {
     if (!CONF) {
       DBG_PRINTLN("[ESPNOW][registerPeer] Conf missing for LMK");
       return ESP_ERR_INVALID_STATE;
     }
-    String lmkHex = CONF->GetString(MASTER_LMK_KEY, MASTER_LMK_DEFAULT);
-    if (lmkHex.length() != 32) {
+    PeerIdentity id;
+    (void)masterIdentity(id);
+    if (!id.hasLmk) {
       DBG_PRINTLN("[ESPNOW][registerPeer] Missing or invalid LMK");
       return ESP_ERR_INVALID_ARG;
     }
-    uint8_t lmk[16] = {0};
-    if (!hexToBytes_(lmkHex.c_str(), lmk, sizeof(lmk))) {
-      DBG_PRINTLN("[ESPNOW][registerPeer] LMK hex parse failed");
-      return ESP_ERR_INVALID_ARG;
-    }
-    DBG_PRINTF("[ESPNOW][pair] LMK=%s\n", lmkHex.c_str());
-    memcpy(peerInfo.lmk, lmk, sizeof(lmk));
+    memcpy(peerInfo.lmk, id.lmk, sizeof(id.lmk));
   }
   esp_err_t r = esp_now_add_peer(&peerInfo);
 
@@ -208,7 +208,9 @@ bool EspNowManager::handlePairInit_(const uint8_t masterMac[6], const uint8_t* d
   uint8_t caps = 0;
   uint32_t seed = 0;
   bool shockExternal = true;
-  if (!parsePairInit_(data, len, caps, seed, shockExternal)) {
+  uint8_t wire = 0;
+  const bool wireOffered = len > kPairInitPayloadLen;
+  if (!parsePairInit_(data, len, caps, seed, shockExternal, wire)) {
     return false;
   }
 
@@ -224,6 +226,8 @@ bool EspNowManager::handlePairInit_(const uint8_t masterMac[6], const uint8_t* d
              (caps & 0x02) ? 1u : 0u,
              (caps & 0x04) ? 1u : 0u,
              (caps & 0x08) ? 1u : 0u);
+  DBG_PRINTF("[ESPNOW][pair] WIRE offer=0x%02X agreed=0x%02X\n",
+             (unsigned)wire, (unsigned)(wire & NOW_WIRE_CAPS_LOCAL));
   DBG_PRINTLN("[ESPNOW][pair] Step 1: add temporary unencrypted peer");
 
   uint8_t lmk[16] = {0};
@@ -236,6 +240,7 @@ bool EspNowManager::handlePairInit_(const uint8_t masterMac[6], const uint8_t* d
   pendingPairInitMs_ = millis();
   pendingPairInitChannel_ = channel;
   pendingPairInitCaps_ = caps;
+  pendingPairInitWire_ = wire & NOW_WIRE_CAPS_LOCAL;
   pendingPairInitSeed_ = seed;
   pendingPairInitShockExternal_ = shockExternal;
   pendingPairInitAckInFlight_ = false;
@@ -253,7 +258,11 @@ bool EspNowManager::handlePairInit_(const uint8_t masterMac[6], const uint8_t* d
 
   uint8_t resp[ESPNOW_MAX_DATA_LEN];
   size_t respLen = 0;
-  if (!buildResponse_(ACK_PAIR_INIT, nullptr, 0, resp, &respLen)) {
+  // Answer a wire offer with what we accept; a bare PairInit gets the
+  // payload-less ACK legacy masters expect.
+  const uint8_t wireAns = pendingPairInitWire_;
+  if (!buildResponse_(ACK_PAIR_INIT, wireOffered ? &wireAns : nullptr, wireOffered ? 1 : 0,
+                      resp, &respLen)) {
     DBG_PRINTLN("[ESPNOW][pair] ACK_PAIR_INIT build failed");
     clearPendingPairInit_("ack build failed", true);
     return false;
@@ -308,6 +317,8 @@ void EspNowManager::finalizePairInit_() {
   CONF->PutBool(ARMED_STATE, false);
   CONF->PutBool(MOTION_TRIG_ALARM, false);
   CONF->PutString(MASTER_LMK_KEY, String(lmkHex));
+  CONF->PutInt(MASTER_WIRE_KEY, pendingPairInitWire_);
+  invalidatePeerCache();
   setCapBitsShadow_(caps);
 
   DBG_PRINTLN("[ESPNOW][pair] Step 4: remove temporary unencrypted peer");
@@ -316,13 +327,13 @@ void EspNowManager::finalizePairInit_() {
     DBG_PRINTLN("[ESPNOW][pair] secure peer setup failed");
     CONF->PutBool(DEVICE_CONFIGURED, false);
     CONF->PutString(MASTER_LMK_KEY, MASTER_LMK_DEFAULT);
+    invalidatePeerCache();
     clearPendingPairInit_("secure setup failed", false);
     return;
   }
 
   DBG_PRINTLN("[ESPNOW][pair] Step 5: secure peer ready, send configured bundle");
-  lastHbMs_ = millis();
-  online_ = true;
+  markPresent_(millis());
   sendConfiguredBundle_("PAIR_INIT");
   clearPendingPairInit_("paired", false);
 }
@@ -338,6 +349,7 @@ void EspNowManager::clearPendingPairInit_(const char* reason, bool removePeer) {
   pendingPairInitMs_ = 0;
   pendingPairInitChannel_ = MASTER_CHANNEL_DEFAULT;
   pendingPairInitCaps_ = 0;
+  pendingPairInitWire_ = 0;
   pendingPairInitSeed_ = 0;
   pendingPairInitAckInFlight_ = false;
   pendingPairInitAckDone_ = false;
@@ -347,6 +359,27 @@ void EspNowManager::clearPendingPairInit_(const char* reason, bool removePeer) {
   pendingPairInitShockExternal_ = true;
 }
 
+// NVS -> binary identity (cache miss path only).
+void EspNowManager::loadPeerIdentity_(PeerIdentity& out, const char* macKey, const char* lmkKey) {
+  out = PeerIdentity();
+  if (!CONF) return;
+  const String macStr = CONF->GetString(macKey, MASTER_ESPNOW_ID_DEFAULT);
+  if (macStr.length() == 17 && macStr != MASTER_ESPNOW_ID_DEFAULT) {
+    out.valid = parseMacToBytes(macStr, out.mac);
+  }
+  out.channel = static_cast<uint8_t>(CONF->get<Cfg::MasterChannel>());
+  const String lmkHex = CONF->GetString(lmkKey, MASTER_LMK_DEFAULT);
+  out.hasLmk = (lmkHex.length() == 32) && hexToBytes_(lmkHex.c_str(), out.lmk, sizeof(out.lmk));
+}
+
+// Milliseconds until pollPairing_() has something to do (UINT32_MAX = none).
+uint32_t EspNowManager::pairingWaitMs_(uint32_t now) const {
+  if (!pendingPairInit_ || !pendingPairInitAckDone_) return UINT32_MAX;
+  if (!pendingPairInitAckOk_) return 0;
+  const uint32_t elapsed = now - pendingPairInitAckDoneMs_;
+  return elapsed >= kPairInitAckDelayMs ? 0 : kPairInitAckDelayMs - elapsed;
+}
+
 void EspNowManager::pollPairing_() {
   if (!pendingPairInit_) {
     return;
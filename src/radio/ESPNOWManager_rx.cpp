@@ -36,21 +36,35 @@ void EspNowManager::onDataReceived(const uint8_t* mac_addr, const uint8_t* data,
   /*DBG_PRINTF("[ESPNOW][RX][onDataReceived] from %02X:%02X:%02X:%02X:%02X:%02X len=%d\n",
                mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], len);*/
 
-  RxEvent e{};
-  memcpy(e.mac, mac_addr, 6);
-  e.len = (len > ESPNOW_MAX_DATA_LEN) ? ESPNOW_MAX_DATA_LEN : len;
-  memcpy(e.buf, data, e.len);
-  if (xQueueSend(instance->rxQ, &e, 0) == pdPASS) {
-    DBG_PRINTF("[ESPNOW][RX] Queued RxEvent: len=%d\n", e.len);
+  // One copy: driver buffer -> free slab slot; only the index is queued.
+  const uint32_t t0 = ESP.getCycleCount();
+  uint8_t idx = 0;
+  bool queued = false;
+  if (instance->rxSlab_ && xQueueReceive(instance->rxFreeQ, &idx, 0) == pdPASS) {
+    RxEvent& e = instance->rxSlab_[idx];
+    memcpy(e.mac, mac_addr, 6);
+    e.len = (len > ESPNOW_MAX_DATA_LEN) ? ESPNOW_MAX_DATA_LEN : len;
+    memcpy(e.buf, data, e.len);
+    queued = (xQueueSend(instance->rxQ, &idx, 0) == pdPASS);
+    if (!queued) (void)xQueueSend(instance->rxFreeQ, &idx, 0);
+  }
+  const uint32_t dt = ESP.getCycleCount() - t0;
+  RxStats& st = instance->rxStats_;
+  st.cbLastCycles = dt;
+  if (dt > st.cbMaxCycles) st.cbMaxCycles = dt;
+  if (queued) {
+    st.frames++;
+    instance->wakeWorker_();
+    DBG_PRINTF("[ESPNOW][RX] Queued slot=%u len=%d\n", (unsigned)idx, len);
   } else {
-    DBG_PRINTLN("[ESPNOW][RX] RxEvent queue full (dropped)");
+    st.drops++;
+    DBG_PRINTLN("[ESPNOW][RX] RX slab full (dropped)");
   }
-  // After queueing the RxEvent:
-  if (instance->isConfigured_()) {
-    instance->lastHbMs_ = millis();
-    if (!instance->isOnline()) {
-      instance->setOffline(false);
-    }
+  if (instance->transport) instance->transport->notePeerRx(mac_addr);
+  // After queueing the RxEvent; frames from other nodes (slaves, pairing
+  // broadcasts) say nothing about the master.
+  if (instance->isConfigured_() && instance->isKnownMasterMac_(mac_addr)) {
+    instance->markPresent_(millis());
   }
   if (instance->Slp) instance->Slp->reset();
   // Note: raw frame is forwarded to TransportManager from the ESPNOW worker task
@@ -85,7 +99,8 @@ void EspNowManager::processRx(const RxEvent& e) {
     return;
   }
 
-  if (!compareMacAddress(e.mac)) {
+  // Primary or standby master (transport peer table).
+  if (!compareMacAddress(e.mac) && !(transport && transport->isMasterPeer(e.mac))) {
     DBG_PRINTLN("[ESPNOW][processRx] Sender MAC mismatch -> ignore");
     return;
   }
@@ -95,6 +110,14 @@ void EspNowManager::processRx(const RxEvent& e) {
   }
 
   const uint8_t frameType = e.buf[0];
+  if (frameType == NOW_FRAME_TRANSPORT) {
+    // Native wire mode: straight into the transport stack, no CommandAPI hop.
+    if (transport && e.len > 1) {
+      markPresent_(millis());
+      transport->onRadioReceive(e.buf + 1, static_cast<size_t>(e.len - 1));
+    }
+    return;
+  }
   if (frameType != NOW_FRAME_CMD) {
     DBG_PRINTF("[ESPNOW][processRx] Non-command frame type=0x%02X ignored\n",
                (unsigned)frameType);
@@ -113,7 +136,7 @@ void EspNowManager::processRx(const RxEvent& e) {
              (unsigned)opcode, (unsigned)payloadLen);
 
   // Presence seen on any valid packet
-  lastHbMs_ = millis();
+  markPresent_(millis());
 
   // Hand off to command handler (CommandAPI -> transport bridge)
   ProcessComand(opcode, payload, payloadLen);
@@ -12,8 +12,17 @@
 //  Helpers
 // =============================================================
 bool EspNowManager::isConfigured_() const {
-  bool cfg = (CONF && CONF->GetBool(DEVICE_CONFIGURED, false));
-  return cfg;
+  return configured_;
+}
+
+// NVS change notification: refresh the mirrors instead of polling per frame.
+void EspNowManager::onConfigChanged_(Cfg id, void* ctx) {
+  auto* self = static_cast<EspNowManager*>(ctx);
+  if (id == Cfg::DeviceConfigured) {
+    self->configured_ = CONF->get<Cfg::DeviceConfigured>();
+  } else {
+    self->capBitsShadowValid_ = false;
+  }
 }
 
 void EspNowManager::sendConfiguredBundle_(const char* reason) {
@@ -45,10 +54,10 @@ uint8_t EspNowManager::getCapBits_() {
   if (!capBitsShadowValid_) {
     uint8_t bits = 0;
     if (CONF) {
-      bits |= CONF->GetBool(HAS_OPEN_SWITCH_KEY,   HAS_OPEN_SWITCH_DEFAULT)   ? 0x01 : 0;
-      bits |= CONF->GetBool(HAS_SHOCK_SENSOR_KEY,  HAS_SHOCK_SENSOR_DEFAULT)  ? 0x02 : 0;
-      bits |= CONF->GetBool(HAS_REED_SWITCH_KEY,   HAS_REED_SWITCH_DEFAULT)   ? 0x04 : 0;
-      bits |= CONF->GetBool(HAS_FINGERPRINT_KEY,   HAS_FINGERPRINT_DEFAULT)   ? 0x08 : 0;
+      bits |= CONF->get<Cfg::HasOpenSwitch>() ? 0x01 : 0;
+      bits |= CONF->get<Cfg::HasShockSensor>() ? 0x02 : 0;
+      bits |= CONF->get<Cfg::HasReedSwitch>() ? 0x04 : 0;
+      bits |= CONF->get<Cfg::HasFingerprint>() ? 0x08 : 0;
     }
     capBitsShadow_ = bits;
     capBitsShadowValid_ = true;
@@ -107,18 +116,17 @@ void EspNowManager::sendState(const char* reason) {
   AckStatePayload payload{};
 
   const bool cfg   = isConfigured_();
-  const bool armed = CONF ? CONF->GetBool(ARMED_STATE, false) : false;
-  const bool motionEnabled = CONF ? CONF->GetBool(MOTION_TRIG_ALARM, false) : false;
+  const bool armed = CONF ? CONF->get<Cfg::ArmedState>() : false;
+  const bool motionEnabled = CONF ? CONF->get<Cfg::MotionTrigAlarm>() : false;
   payload.cfg = cfg ? 1 : 0;
   payload.armed = armed ? 1 : 0;
   payload.motion = motionEnabled ? 1 : 0;
   payload.role = IS_SLAVE_ALARM ? 1 : 0;
 
   const bool lock = IS_SLAVE_ALARM ? false
-                                   : (CONF ? CONF->GetBool(LOCK_STATE, true) : true);
+                                   : (CONF ? CONF->get<Cfg::LockState>() : true);
   const bool hasReed = IS_SLAVE_ALARM ? true
-                                      : (CONF ? CONF->GetBool(HAS_REED_SWITCH_KEY,
-                                                              HAS_REED_SWITCH_DEFAULT)
+                                      : (CONF ? CONF->get<Cfg::HasReedSwitch>()
                                               : false);
   const bool door = hasReed && sw ? sw->isDoorOpen() : false;
   const bool motorMoving =
@@ -160,6 +168,33 @@ void EspNowManager::sendState(const char* reason) {
           true);
 }
 
+// ACK_STATE from a transport state record (transport::kStateRecordSize
+// bytes) so bridged StateQuery/StateReport reuse the snapshot the device
+// already took instead of re-reading NVS and the peripherals.
+void EspNowManager::sendStateRecord_(const uint8_t* rec, const char* reason) {
+  AckStatePayload payload{};
+  payload.armed  = rec[0];
+  payload.lock   = rec[1];
+  payload.door   = rec[2];
+  payload.breach = rec[3];
+  payload.motor  = rec[4];
+  payload.batt   = rec[5] <= 100 ? rec[5] : 0xFF;
+  payload.pmode  = rec[6];
+  payload.band   = rec[7];
+  payload.cfg    = rec[9];
+  payload.up_ms_le = (uint32_t)rec[11] | ((uint32_t)rec[12] << 8) |
+                     ((uint32_t)rec[13] << 16) | ((uint32_t)rec[14] << 24);
+  payload.role   = rec[15];
+  payload.motion = rec[16];
+  payload.seq_le = ++seq_;
+  if (reason && *reason) {
+    const size_t n = strnlen(reason, NOW_STATE_REASON_MAX);
+    payload.reason_len = static_cast<uint8_t>(n);
+    memcpy(payload.reason, reason, n);
+  }
+  SendAck(ACK_STATE, reinterpret_cast<const uint8_t*>(&payload), sizeof(payload), true);
+}
+
 void EspNowManager::sendHeartbeat(bool force) {
   if (!isConfigured_()) {
     DBG_PRINTLN("[ESPNOW][HB] Not configured -> skip");
@@ -170,7 +205,6 @@ void EspNowManager::sendHeartbeat(bool force) {
     return;
   }
   const uint32_t now = millis();
-  lastHbMs_ = now;
   struct HeartbeatPayload {
     uint32_t seq_le;
     uint32_t up_ms_le;
@@ -185,12 +219,91 @@ void EspNowManager::sendHeartbeat(bool force) {
 }
 
 // =============================================================
-//  Presence / PING
+//  Presence / link quality
 // =============================================================
-bool EspNowManager::pingMaster(uint8_t /*tries*/) {
-  if (!isConfigured_()) {
-    return false;
+// Evidence of a live master: a frame from it or a frame delivered to it.
+// Runs in the radio callbacks too, so it only flips flags; the worker does
+// the follow-up work.
+void EspNowManager::markPresent_(uint32_t now) {
+  lastHbMs_ = now;
+  link_.failStreak = 0;
+  if (!online_) {
+    online_ = true;
+    presenceRecovered_ = true;
+    pingBackoffMs_ = PRESENCE_BACKOFF_MIN_MS;
+    link_.onlineEvents++;
   }
+}
+
+// Delivery report for a pool frame sent to a master (onDataSent).
+void EspNowManager::noteDelivery_(bool ok, uint32_t rttUs) {
+  LinkQuality& q = link_;
+  const int32_t target = ok ? 1000 : 0;
+  q.deliveryPermille = static_cast<uint16_t>(
+      int32_t(q.deliveryPermille) + (target - int32_t(q.deliveryPermille)) / 16);
+
   const uint32_t now = millis();
-  return (now - lastHbMs_) < 60000UL;
+  if (ok) {
+    q.rttEwmaUs = q.rttEwmaUs ? q.rttEwmaUs - q.rttEwmaUs / 8 + rttUs / 8 : rttUs;
+    const uint32_t ms = rttUs / 1000;
+    const uint8_t  b  = ms < 1 ? 0 : ms < 2 ? 1 : ms < 5 ? 2 : ms < 10 ? 3 : ms < 20 ? 4 : 5;
+    q.rttHist[b]++;
+    if (rescan_.active) rescan_.delivered = true;
+    q.txFailStreak = 0;
+    markPresent_(now);
+  } else {
+    if (q.failStreak < 0xFF) q.failStreak++;
+    if (q.txFailStreak < 0xFF) q.txFailStreak++;
+    // A run of undelivered frames is a faster signal than the quiet timeout.
+    if (online_ && q.failStreak >= PRESENCE_FAIL_STREAK) {
+      online_ = false;
+      q.offlineEvents++;
+      pingBackoffMs_ = PRESENCE_BACKOFF_MIN_MS;
+      nextPingDueMs_ = now + pingBackoffMs_;
+    }
+  }
+  updateLinkScore_();
+}
+
+// Worker side. Online: nothing to do until the link has been quiet for
+// PRESENCE_TIMEOUT_MS. Offline: probe with exponential backoff; the probe's
+// delivery report (or any RX) brings the link back.
+void EspNowManager::presenceTick_(uint32_t now) {
+  if (presenceRecovered_) {
+    presenceRecovered_ = false;
+    DBG_PRINTLN("[ESPNOW][presence] master online");
+    (void)flushJournalToMaster_();
+  }
+
+  if (rescan_.active) return;   // the rescan probes each channel itself
+
+  if (online_) {
+    // Signed: a callback may have stamped lastHbMs_ after `now` was taken.
+    if (int32_t(now - lastHbMs_) < int32_t(PRESENCE_TIMEOUT_MS)) return;
+    link_.checks++;
+    online_ = false;
+    link_.offlineEvents++;
+    pingBackoffMs_ = PRESENCE_BACKOFF_MIN_MS;
+    nextPingDueMs_ = now;   // first probe right away
+    DBG_PRINTF("[ESPNOW][presence] master quiet %lu ms -> offline\n",
+               (unsigned long)(now - lastHbMs_));
+  }
+
+  // Sustained delivery failure: the master may have moved channel. Only
+  // delivery reports count; RX from the master does not clear it.
+  if (link_.txFailStreak >= ESPNOW_RESCAN_FAIL_STREAK &&
+      (!rescan_.everRan || now - rescan_.lastEndMs >= ESPNOW_RESCAN_COOLDOWN_MS)) {
+    startRescan_(false);
+    return;
+  }
+
+  if (int32_t(now - nextPingDueMs_) < 0) return;
+  link_.checks++;
+  nextPingDueMs_ = now + pingBackoffMs_;
+  pingBackoffMs_ = (pingBackoffMs_ >= PRESENCE_BACKOFF_MAX_MS / 2) ? PRESENCE_BACKOFF_MAX_MS
+                                                                  : pingBackoffMs_ * 2;
+#if PRESENCE_OFFLINE_PROBE
+  link_.probes++;
+  sendHeartbeat(true);
+#endif
 }
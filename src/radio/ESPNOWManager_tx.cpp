@@ -2,7 +2,9 @@
 #include <ConfigNvs.hpp>
 #include <Logger.hpp>
 #include <NVSManager.hpp>
+#include <TransportManager.hpp>
 #include <Utils.hpp>
+#include <BootTrace.hpp>
 #include <string.h>
 
 // =============================================================
@@ -13,8 +15,10 @@ void EspNowManager::onDataSent(const uint8_t* mac_addr, esp_now_send_status_t st
 
   DBG_PRINTF("[ESPNOW][TX][onDataSent] status=%d\n", (int)status);
 
+  bool pairAck = false;   // report for the pairing ACK sent around the pool
   if (instance->pendingPairInitAckInFlight_ && instance->pendingPairInit_) {
     if (mac_addr && memcmp(mac_addr, instance->pendingPairInitMac_, 6) == 0) {
+      pairAck = true;
       instance->pendingPairInitAckInFlight_ = false;
       instance->pendingPairInitAckDone_ = true;
       instance->pendingPairInitAckOk_ = (status == ESP_NOW_SEND_SUCCESS);
@@ -24,165 +28,400 @@ void EspNowManager::onDataSent(const uint8_t* mac_addr, esp_now_send_status_t st
     }
   }
 
-  if (status == ESP_NOW_SEND_SUCCESS) {
-    taskENTER_CRITICAL(&instance->sendMux_);
-    instance->hasInFlight_ = false;
-    taskEXIT_CRITICAL(&instance->sendMux_);
-    DBG_PRINTLN("[ESPNOW][TX] Success; clearing in-flight and trying next.");
-    instance->trySendNext_();
-    return;
-  }
-
-  // Failure: retry up to ESPNOW_TX_MAX_RETRY times
-  TxAckEvent retry{};
-  bool haveRetry = false;
+  // Per-peer liveness/RTT for master failover.
+  const bool ok = (status == ESP_NOW_SEND_SUCCESS);
+  if (instance->transport && mac_addr) instance->transport->notePeerStatus(mac_addr, ok);
 
+  // Complete the oldest in-flight frame; completions arrive in send order.
+  // Frames sent around the pool (pairing ACK, transport peers) don't match.
+  // A broadcast slot takes one report from each peer it was sent to (any
+  // other report is not its own) and is never retried (best effort).
+  bool matched = false;
+  uint8_t attempts = 0;
+  uint32_t rttUs = 0;
   taskENTER_CRITICAL(&instance->sendMux_);
-  if (instance->inFlight_.attempts < ESPNOW_TX_MAX_RETRY) {
-    retry = instance->inFlight_;
-    retry.attempts++;
-    haveRetry = true;
+  uint8_t idx = 0;
+  if (instance->txInFlight_.front(idx) && instance->txSlots_[idx].bcast) {
+    TxSlot& slot = instance->txSlots_[idx];
+    for (uint8_t i = 0; mac_addr && !pairAck && i < instance->bcastPeerCount_; ++i) {
+      const uint32_t bit = uint32_t(1) << i;
+      if (!(instance->bcastPending_ & bit) ||
+          memcmp(mac_addr, instance->bcastPeers_[i], 6) != 0) continue;
+      instance->bcastPending_ &= ~bit;
+      if (ok) slot.anyOk = true;
+      break;
+    }
+    if (!instance->bcastPending_) {
+      instance->txInFlight_.pop(idx);
+      if (slot.anyOk) instance->txStats_.delivered++;
+      else            instance->txStats_.dropped++;
+      slot.bcast = false;
+      instance->txFree_.push(idx);
+    }
+  } else if (instance->txInFlight_.front(idx) && mac_addr &&
+             memcmp(mac_addr, instance->txSlots_[idx].mac, 6) == 0) {
+    instance->txInFlight_.pop(idx);
+    TxSlot& slot = instance->txSlots_[idx];
+    matched = true;
+    rttUs = micros() - slot.sentUs;
+    if (ok || slot.attempts >= ESPNOW_TX_MAX_RETRY) {
+      if (ok) instance->txStats_.delivered++;
+      else    instance->txStats_.dropped++;
+      instance->journalDone_(slot, ok);
+      instance->txFree_.push(idx);
+      if (instance->txHold_ && instance->txHoldIdx_ == idx) instance->txHold_ = false;
+    } else {
+      // Frames already handed to the driver still land first; hold the
+      // pipeline so no frame queued after this one can pass the retry.
+      slot.attempts++;
+      attempts = slot.attempts;
+      instance->txStats_.retries++;
+      instance->txReady_.pushFront(idx);
+      instance->txHold_    = true;
+      instance->txHoldIdx_ = idx;
+    }
   }
-  instance->hasInFlight_ = false;
   taskEXIT_CRITICAL(&instance->sendMux_);
 
-  if (haveRetry) {
-    DBG_PRINTF("[ESPNOW][TX] Failure; requeue attempt %u/%u\n",
-                 (unsigned)retry.attempts, (unsigned)ESPNOW_TX_MAX_RETRY);
-    (void)xQueueSend(instance->sendQ, &retry, 0);
-  } else {
-    DBG_PRINTLN("[ESPNOW]ESP-NOW callback failure; drop after max retries.");
+  if (matched) instance->noteDelivery_(ok, rttUs);
+  if (matched && !ok) {
+    if (attempts) {
+      DBG_PRINTF("[ESPNOW][TX] Failure; requeue attempt %u/%u\n",
+                 (unsigned)attempts, (unsigned)ESPNOW_TX_MAX_RETRY);
+    } else {
+      DBG_PRINTLN("[ESPNOW]ESP-NOW callback failure; drop after max retries.");
+    }
   }
 
   instance->trySendNext_();
+  instance->wakeWorker_();   // pairing ACK completion / retry backlog
 }
 
 // =============================================================
 //  Public API (TX)
 // =============================================================
-void EspNowManager::SendAck(uint16_t opcode, bool Status) {
-  SendAck(opcode, nullptr, 0, Status);
+bool EspNowManager::SendAck(uint16_t opcode, bool Status) {
+  return SendAck(opcode, nullptr, 0, Status);
 }
 
-void EspNowManager::SendAck(uint16_t opcode, const uint8_t* payload, size_t payloadLen, bool Status) {
-  if (!isConfigured_()) { DBG_PRINTLN("[ESPNOW][SendAck] Ignored: not configured"); return; }
-  if (!txQ)             { DBG_PRINTLN("[ESPNOW][SendAck] txQ=null"); return; }
-  if (CONF) {
-    String master = CONF->GetString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
-    if (master.isEmpty() || master == MASTER_ESPNOW_ID_DEFAULT) {
-      DBG_PRINTLN("[ESPNOW][SendAck] Ignored: master MAC missing");
-      return;
-    }
-  }
-  TxAckEvent e{};
-  e.status   = Status;
-  e.attempts = 0;  // first try
-  size_t frameLen = 0;
-  if (!buildResponse_(opcode, payload, payloadLen, e.data, &frameLen)) {
-    DBG_PRINTLN("[ESPNOW][SendAck] buildResponse failed");
-    return;
+bool EspNowManager::SendAck(uint16_t opcode, const uint8_t* payload, size_t payloadLen, bool Status) {
+  if (!isConfigured_()) { DBG_PRINTLN("[ESPNOW][SendAck] Ignored: not configured"); return false; }
+  uint8_t master[6];
+  if (!masterMac(master)) {
+    DBG_PRINTLN("[ESPNOW][SendAck] Ignored: master MAC missing");
+    return false;
   }
-  e.len = static_cast<uint16_t>(frameLen);
+  if (!queueResponse_(opcode, payload, payloadLen, Status, false)) return false;
+  trySendNext_();
+  return true;
+}
 
-  DBG_PRINTF("[ESPNOW][ACK][enqueue] op=0x%04X len=%u status=%u\n",
-             (unsigned)opcode, (unsigned)e.len, (unsigned)(Status ? 1 : 0));
-  if (xQueueSend(txQ, &e, 0) != pdPASS) {
-    DBG_PRINTLN("[ESPNOW][ACK] txQ full (drop)");
+// Journal replay pacing: wait for a free pool slot instead of a fixed delay
+// per frame. false = the pool stayed full for timeoutMs.
+bool EspNowManager::waitTxSlot_(uint32_t timeoutMs) {
+  const uint32_t t0 = millis();
+  for (;;) {
+    taskENTER_CRITICAL(&sendMux_);
+    const bool free = txFree_.count > 0;
+    taskEXIT_CRITICAL(&sendMux_);
+    if (free) return true;
+    if (millis() - t0 >= timeoutMs) return false;
+    trySendNext_();
+    vTaskDelay(pdMS_TO_TICKS(ESPNOW_TX_RETRY_MS));
   }
 }
 
-void EspNowManager::doSendAck(const TxAckEvent& e) {
-  uint16_t opcode = 0;
-  if (e.len >= 3) {
-    opcode = static_cast<uint16_t>(e.data[1]) |
-             (static_cast<uint16_t>(e.data[2]) << 8);
-  }
-  DBG_PRINTF("[ESPNOW][ACK][doSendAck] op=0x%04X len=%u attempt=%u status=%u\n",
-             (unsigned)opcode, (unsigned)e.len, (unsigned)e.attempts,
-             (unsigned)(e.status ? 1 : 0));
-  TxAckEvent copy = e;
-  if (xQueueSend(sendQ, &copy, 0) != pdPASS) {
-    DBG_PRINTLN("[ESPNOW][ACK] sendQ full (drop)");
-  }
+// Journal replay frame: like SendAck(), after waitTxSlot_(), and tagged
+// with the current pass so awaitJournalDelivery_() can tell when it lands.
+bool EspNowManager::sendJournal_(uint16_t opcode, const uint8_t* payload, size_t payloadLen) {
+  if (!isConfigured_()) return false;
+  uint8_t master[6];
+  if (!masterMac(master)) return false;
+  if (!waitTxSlot_(ESPNOW_JOURNAL_SLOT_WAIT_MS)) return false;
+  if (!queueResponse_(opcode, payload, payloadLen, true, false, true)) return false;
+  trySendNext_();
+  return true;
 }
 
-bool EspNowManager::sendAckNow_(const TxAckEvent& e) {
-  if (!LOGG) {
-    DBG_PRINTLN("[ESPNOW][sendAckNow_] Log=null; abort");
-    return false;
+void EspNowManager::beginJournalPass_() {
+  taskENTER_CRITICAL(&sendMux_);
+  if (++journalGen_ == 0) journalGen_ = 1;   // 0 marks non-journal slots
+  journalInFlight_ = 0;
+  journalLost_     = false;
+  taskEXIT_CRITICAL(&sendMux_);
+}
+
+// Final outcome of a slot (delivered or dropped); caller holds sendMux_.
+// Frames from an earlier pass are ignored.
+void EspNowManager::journalDone_(TxSlot& slot, bool delivered) {
+  if (slot.journalGen == journalGen_) {
+    if (journalInFlight_) journalInFlight_--;
+    if (!delivered) journalLost_ = true;
   }
+  slot.journalGen = 0;
+}
 
-  uint8_t peerMac[6]{};
-  if (getMacAddress(peerMac) != ESP_OK) {
-    DBG_PRINTLN("[ESPNOW][sendAckNow_] getMacAddress failed");
-    return false;
+// true once every frame of this pass was delivered; false as soon as one
+// is dropped, or if they are still pending after timeoutMs.
+bool EspNowManager::awaitJournalDelivery_(uint32_t timeoutMs) {
+  const uint32_t t0 = millis();
+  for (;;) {
+    taskENTER_CRITICAL(&sendMux_);
+    const uint8_t left = journalInFlight_;
+    const bool    lost = journalLost_;
+    taskEXIT_CRITICAL(&sendMux_);
+    if (lost) return false;
+    if (!left) return true;
+    if (millis() - t0 >= timeoutMs) return false;
+    trySendNext_();   // immediate-fail requeues wait for a pump
+    vTaskDelay(pdMS_TO_TICKS(ESPNOW_TX_RETRY_MS));
   }
+}
 
-  if (e.len == 0 || e.len > ESPNOW_MAX_DATA_LEN) {
-    DBG_PRINTLN("[ESPNOW][sendAckNow_] invalid length");
+// =============================================================
+//  TX slot pool
+// =============================================================
+static_assert(ESPNOW_TX_QUEUE_SIZE <= 255, "slot indices are uint8_t");
+static_assert(ESPNOW_TX_MAX_INFLIGHT >= 1 && ESPNOW_TX_MAX_INFLIGHT <= ESPNOW_TX_QUEUE_SIZE,
+              "ESPNOW_TX_MAX_INFLIGHT out of range");
+
+bool EspNowManager::takeTxSlot_(uint8_t& idx) {
+  taskENTER_CRITICAL(&sendMux_);
+  const bool got = txFree_.pop(idx);
+  if (!got) txStats_.poolFull++;
+  taskEXIT_CRITICAL(&sendMux_);
+  if (!got) {
+    DBG_PRINTLN("[ESPNOW][ACK] TX pool full (drop)");
     return false;
   }
-  uint16_t opcode = 0;
-  if (e.len >= 3) {
-    opcode = static_cast<uint16_t>(e.data[1]) |
-             (static_cast<uint16_t>(e.data[2]) << 8);
-  }
+  TxSlot& slot = txSlots_[idx];
+  slot.attempts    = 0;  // first try
+  slot.bcast       = false;
+  slot.anyOk       = false;
+  slot.journalGen  = 0;
+  return true;
+}
+
+void EspNowManager::readyTxSlot_(uint8_t idx, bool urgent) {
+  taskENTER_CRITICAL(&sendMux_);
+  if (urgent) txReady_.pushFront(idx);
+  else        txReady_.push(idx);
+  txStats_.queued++;
+  taskEXIT_CRITICAL(&sendMux_);
+}
 
-  DBG_PRINTF("[ESPNOW][ACK][send] op=0x%04X len=%u -> master\n",
-             (unsigned)opcode, (unsigned)e.len);
+bool EspNowManager::queueResponse_(uint16_t opcode, const uint8_t* payload, size_t payloadLen,
+                                   bool status, bool urgent, bool journal) {
+  uint8_t idx = 0;
+  if (!takeTxSlot_(idx)) return false;
 
-  esp_err_t r = sendData(peerMac, e.data, e.len);
-  if (r == ESP_OK) {
+  // The slot is ours until it is queued: build the frame straight into it.
+  TxSlot& slot = txSlots_[idx];
+  size_t frameLen = 0;
+  if (!buildResponse_(opcode, payload, payloadLen, slot.data, &frameLen)) {
+    DBG_PRINTLN("[ESPNOW][SendAck] buildResponse failed");
     taskENTER_CRITICAL(&sendMux_);
-    inFlight_    = e;
-    hasInFlight_ = true;
+    txFree_.push(idx);
     taskEXIT_CRITICAL(&sendMux_);
-    if (LOGG) {
-      String logLine = String("op=0x") + String(opcode, HEX) +
-                       " len=" + String(e.len);
-      LOGG->logAckSent(logLine);
-    }
-    DBG_PRINTLN("[ESPNOW][ACK] In-flight set.");
-    return true;
+    return false;
   }
+  slot.len      = static_cast<uint16_t>(frameLen);
+  slot.status   = status;
+  if (journal) {
+    taskENTER_CRITICAL(&sendMux_);
+    slot.journalGen = journalGen_;
+    journalInFlight_++;
+    taskEXIT_CRITICAL(&sendMux_);
+  }
+  readyTxSlot_(idx, urgent);
+
+  DBG_PRINTF("[ESPNOW][ACK][enqueue] op=0x%04X len=%u status=%u%s\n",
+             (unsigned)opcode, (unsigned)slot.len, (unsigned)(status ? 1 : 0),
+             urgent ? " urgent" : "");
+  return true;
+}
 
-  DBG_PRINTF("[ESPNOW][ACK] sendData failed -> %d\n", (int)r);
-  if (e.attempts < ESPNOW_TX_MAX_RETRY) {
-    TxAckEvent retry = e;
-    retry.attempts++;
-    DBG_PRINTF("[ESPNOW][ACK] Immediate fail; requeue attempt %u/%u\n",
-                 (unsigned)retry.attempts, (unsigned)ESPNOW_TX_MAX_RETRY);
-    (void)xQueueSend(sendQ, &retry, 0);
-  } else {
-    DBG_PRINTLN("[ESPNOW]ESP-NOW immediate send failed; drop after max retries.");
+bool EspNowManager::queueBroadcast(const uint8_t* data, size_t len) {
+  if (!data || !len || len > ESPNOW_MAX_DATA_LEN) return false;
+  uint8_t idx = 0;
+  if (!takeTxSlot_(idx)) return false;
+  TxSlot& slot = txSlots_[idx];
+  memcpy(slot.data, data, len);
+  slot.len    = static_cast<uint16_t>(len);
+  slot.status = true;
+  slot.bcast  = true;
+  readyTxSlot_(idx, false);
+  trySendNext_();
+  return true;
+}
+
+// Native wire mode: the transport frame rides the same slot pool (and thus
+// the same master failover/delivery accounting) as CommandAPI responses.
+bool EspNowManager::queueTransport(const uint8_t* data, size_t len) {
+  if (!data || !len || len + 1 > ESPNOW_MAX_DATA_LEN) return false;
+  uint8_t idx = 0;
+  if (!takeTxSlot_(idx)) return false;
+  TxSlot& slot = txSlots_[idx];
+  slot.data[0] = NOW_FRAME_TRANSPORT;
+  memcpy(slot.data + 1, data, len);
+  slot.len    = static_cast<uint16_t>(len + 1);
+  slot.status = true;
+  readyTxSlot_(idx, false);
+  trySendNext_();
+  return true;
+}
+
+// Registered ESP-NOW peers, i.e. where esp_now_send(NULL) goes.
+uint8_t EspNowManager::fetchPeers_(uint8_t (*out)[6]) {
+  uint8_t n = 0;
+  esp_now_peer_info_t p{};
+  for (bool first = true; n < ESP_NOW_MAX_TOTAL_PEER_NUM; first = false) {
+    if (esp_now_fetch_peer(first, &p) != ESP_OK) break;
+    memcpy(out[n++], p.peer_addr, 6);
   }
-  return false;
+  return n;
 }
 
+// Hand ready frames to ESP-NOW until ESPNOW_TX_MAX_INFLIGHT are outstanding
+// (one while a retry is on hold, see txHold_). A broadcast waits until the
+// previous one has all its reports.
+// Called from SendAck(), the worker, and onDataSent(); only one caller pumps
+// at a time, the others return and leave the work to it.
 void EspNowManager::trySendNext_() {
-  // Check in-flight under lock
-  bool busy = false;
   taskENTER_CRITICAL(&sendMux_);
-  busy = hasInFlight_;
+  const bool idle = txPumping_ || txReady_.count == 0 ||
+                    txInFlight_.count >= txInFlightCap_();
+  if (!idle) txPumping_ = true;
   taskEXIT_CRITICAL(&sendMux_);
-  if (busy || !sendQ) {
-    if (busy) DBG_PRINTLN("[ESPNOW][TX] In-flight present; not sending next.");
+  if (idle) return;
+
+  // Master frames go to the healthiest master in the transport peer table
+  // (primary, or the standby while the primary is failing).
+  uint8_t peerMac[6]{};
+  const uint32_t c0 = ESP.getCycleCount();
+  const bool havePeer = transport ? transport->resolveMaster(peerMac) : masterMac(peerMac);
+  const uint32_t dc = ESP.getCycleCount() - c0;
+  txStats_.peerLookupLastCycles = dc;
+  if (dc > txStats_.peerLookupMaxCycles) txStats_.peerLookupMaxCycles = dc;
+  if (!havePeer) {
+    DBG_PRINTLN("[ESPNOW][TX] master MAC missing");
+    taskENTER_CRITICAL(&sendMux_);
+    txPumping_ = false;
+    taskEXIT_CRITICAL(&sendMux_);
     return;
   }
 
-  TxAckEvent next{};
-  if (xQueueReceive(sendQ, &next, 0) == pdPASS) {
-    uint16_t opcode = 0;
-    if (next.len >= 3) {
-      opcode = static_cast<uint16_t>(next.data[1]) |
-               (static_cast<uint16_t>(next.data[2]) << 8);
+  for (;;) {
+    uint8_t idx = 0;
+    // A broadcast needs the peer list, fetched outside the critical section.
+    uint8_t peers[ESP_NOW_MAX_TOTAL_PEER_NUM][6];
+    uint8_t nPeers = 0;
+    taskENTER_CRITICAL(&sendMux_);
+    const bool nextBcast = txReady_.front(idx) && txSlots_[idx].bcast;
+    taskEXIT_CRITICAL(&sendMux_);
+    if (nextBcast) nPeers = fetchPeers_(peers);
+
+    taskENTER_CRITICAL(&sendMux_);
+    if (txInFlight_.count >= txInFlightCap_() || !txReady_.front(idx) ||
+        (txSlots_[idx].bcast && bcastPending_)) {
+      txPumping_ = false;   // same critical section as the check: no lost wakeups
+      taskEXIT_CRITICAL(&sendMux_);
+      return;
+    }
+    if (txSlots_[idx].bcast != nextBcast) {   // urgent frame jumped ahead: peek again
+      taskEXIT_CRITICAL(&sendMux_);
+      continue;
+    }
+    (void)txReady_.pop(idx);
+    if (nextBcast && !nPeers) {                // nobody to send to, no report will come
+      txStats_.dropped++;
+      txSlots_[idx].bcast = false;
+      txFree_.push(idx);
+      taskEXIT_CRITICAL(&sendMux_);
+      continue;
+    }
+    // Mark in flight before sending: the callback can beat esp_now_send()
+    // and recycle the slot, so read what we log while it is still ours.
+    TxSlot& slot = txSlots_[idx];
+    memcpy(slot.mac, peerMac, 6);
+    const bool     bcast    = slot.bcast;
+    if (bcast) {
+      memcpy(bcastPeers_, peers, sizeof(peers[0]) * nPeers);
+      bcastPeerCount_ = nPeers;
+      bcastPending_   = (nPeers >= 32) ? UINT32_MAX : ((uint32_t(1) << nPeers) - 1);
+      slot.anyOk = false;
+    }
+    const uint16_t len      = slot.len;
+    const uint8_t  attempts = slot.attempts;
+    const uint16_t opcode   = (len >= 3)
+        ? static_cast<uint16_t>(slot.data[1] | (uint16_t(slot.data[2]) << 8))
+        : 0;
+    slot.sentUs = micros();
+    txInFlight_.push(idx);
+    if (txInFlight_.count > txStats_.inFlightMax) txStats_.inFlightMax = txInFlight_.count;
+    taskEXIT_CRITICAL(&sendMux_);
+
+    DBG_PRINTF("[ESPNOW][ACK][send] op=0x%04X len=%u attempt=%u -> %s\n",
+               (unsigned)opcode, (unsigned)len, (unsigned)attempts,
+               bcast ? "all peers" : "master");
+
+    // Stamp the RTT sample first: the delivery report can beat the return.
+    if (!bcast && transport) transport->notePeerSent(peerMac);
+    const esp_err_t r = bcast ? esp_now_send(nullptr, slot.data, len)
+                              : sendData(peerMac, slot.data, len);
+    if (r == ESP_OK) {
+      BootTrace::mark(BootTrace::Phase::FirstFrame);
+      taskENTER_CRITICAL(&sendMux_);
+      txStats_.sent++;
+      taskEXIT_CRITICAL(&sendMux_);
+      if (!bcast && LOGG) {
+        String logLine = String("op=0x") + String(opcode, HEX) +
+                         " len=" + String(len);
+        LOGG->logAckSent(logLine);
+      }
+      continue;
     }
-    DBG_PRINTF("[ESPNOW][TX] Dequeued for send: op=0x%04X attempt=%u\n",
-               (unsigned)opcode, (unsigned)next.attempts);
-    (void)sendAckNow_(next);
+
+    // Immediate failure (e.g. ESP-NOW buffer full): take it back out of the
+    // in-flight FIFO (only the pump pushes, so it is still the newest entry)
+    // and stop; the worker pumps again on its next pass.
+    DBG_PRINTF("[ESPNOW][ACK] sendData failed -> %d\n", (int)r);
+    bool requeued = false;
+    taskENTER_CRITICAL(&sendMux_);
+    uint8_t tail = 0;
+    if (txInFlight_.back(tail) && tail == idx) txInFlight_.popBack();
+    if (bcast) bcastPending_ = 0;   // nothing went out: no reports due
+    if (slot.attempts < ESPNOW_TX_MAX_RETRY) {
+      slot.attempts++;
+      txStats_.retries++;
+      txReady_.pushFront(idx);
+      requeued = true;
+    } else {
+      txStats_.dropped++;
+      journalDone_(slot, false);
+      txFree_.push(idx);
+      if (txHold_ && txHoldIdx_ == idx) txHold_ = false;
+    }
+    txPumping_ = false;
+    taskEXIT_CRITICAL(&sendMux_);
+    wakeWorker_();   // worker re-pumps after ESPNOW_TX_RETRY_MS
+    if (requeued) {
+      DBG_PRINTF("[ESPNOW][ACK] Immediate fail; requeue attempt %u/%u\n",
+                 (unsigned)(attempts + 1), (unsigned)ESPNOW_TX_MAX_RETRY);
+    } else {
+      DBG_PRINTLN("[ESPNOW]ESP-NOW immediate send failed; drop after max retries.");
+    }
+    return;
   }
 }
 
+bool EspNowManager::txIdle_() {
+  taskENTER_CRITICAL(&sendMux_);
+  const bool idle = (txReady_.count == 0) && (txInFlight_.count == 0);
+  taskEXIT_CRITICAL(&sendMux_);
+  return idle;
+}
+
 // =============================================================
 //  Response builder
 // =============================================================
@@ -9,18 +9,45 @@ EspNowAdapter::EspNowAdapter(uint8_t selfId,
                             const uint8_t* data,
                             size_t len) -> bool {
               if (!now) return false;
-              // If this message is destined to master, try CommandAPI bridge first.
-              if (msg.header.destId == 1 && now->handleTransportTx(msg)) {
-                return true; // handled as ACK
+              // Master: native masters take the frame as is; legacy masters
+              // get it translated by the CommandAPI bridge.
+              if (msg.header.destId == TRANSPORT_MASTER_ID) {
+                if (now->nativeWire()) return now->queueTransport(data, len);
+                if (now->handleTransportTx(msg)) return true; // handled as ACK
+              }
+              // Broadcast: one radio send reaches every registered peer.
+              if (msg.header.destId == TRANSPORT_BROADCAST_ID) {
+                return now->queueBroadcast(data, len);
               }
               if (!resolver) return false;
               uint8_t mac[6]{};
               if (!resolver(msg.header.destId, mac)) return false;
               return now->sendData(mac, data, len) == ESP_OK;
             },
-            cfg),
+            clampBatch_(cfg)),
       now_(now),
       resolver_(std::move(resolver)) {
+  // Multi-record frames only make sense for peers that receive raw transport
+  // frames; master traffic (destId=1) is batched only in native wire mode,
+  // otherwise the CommandAPI bridge translates it per message.
+  port_.setBatchSender(
+      [this](uint8_t destId) {
+        return destId != TRANSPORT_MASTER_ID || (now_ && now_->nativeWire());
+      },
+      [this](uint8_t destId, const uint8_t* data, size_t len) -> bool {
+        if (now_ && destId == TRANSPORT_BROADCAST_ID) return now_->queueBroadcast(data, len);
+        if (now_ && destId == TRANSPORT_MASTER_ID) return now_->queueTransport(data, len);
+        if (!now_ || !resolver_) return false;
+        uint8_t mac[6]{};
+        if (!resolver_(destId, mac)) return false;
+        return now_->sendData(mac, data, len) == ESP_OK;
+      });
+}
+
+transport::TransportPort::Config EspNowAdapter::clampBatch_(transport::TransportPort::Config cfg) {
+  // One byte is reserved for the NOW_FRAME_TRANSPORT prefix (native master).
+  if (cfg.batchMaxBytes > ESPNOW_MAX_DATA_LEN - 1) cfg.batchMaxBytes = ESPNOW_MAX_DATA_LEN - 1;
+  return cfg;
 }
 
 void EspNowAdapter::onRadioReceive(const uint8_t* data, size_t len) {
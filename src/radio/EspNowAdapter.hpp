@@ -14,12 +14,24 @@
  * Notes:
  *  - Does not modify EspNowManager; caller must hook onDataReceived to onRadioReceive().
  *  - Peer resolution (logical destId -> MAC) is provided by the user via resolver.
+ *  - destId=TRANSPORT_BROADCAST_ID goes out as a single ESP-NOW broadcast send.
  */
 
 #include <Transport.hpp>
 #include <ESPNOWManager.hpp>
 #include <functional>
 
+// ---------- Logical IDs ----------
+#ifndef TRANSPORT_MASTER_ID
+#define TRANSPORT_MASTER_ID          1         // "the master": routed to the healthiest one
+#endif
+#ifndef TRANSPORT_STANDBY_ID
+#define TRANSPORT_STANDBY_ID         3         // the standby master itself
+#endif
+#ifndef TRANSPORT_BROADCAST_ID
+#define TRANSPORT_BROADCAST_ID       0xFF      // every registered peer, one radio send
+#endif
+
 class EspNowAdapter {
 public:
   using PeerResolver = std::function<bool(uint8_t destId, uint8_t outMac[6])>;
@@ -36,6 +48,8 @@ public:
   void onRadioReceive(const uint8_t* data, size_t len);
 
 private:
+  static transport::TransportPort::Config clampBatch_(transport::TransportPort::Config cfg);
+
   transport::TransportPort port_;
   EspNowManager* now_;
   PeerResolver resolver_;
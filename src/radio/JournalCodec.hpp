@@ -0,0 +1,120 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#pragma once
+/**
+ * @file JournalCodec.h
+ * @brief Binary encoding of offline journal records.
+ *
+ *  Record : [type u8][seqDelta varint][len u8][fields: len bytes]
+ *  Journal: [base seq varint] record*   (NVS blob and RAM buffer)
+ *  Frame  : [count u8][base seq varint] record*   (EVT_JOURNAL payload)
+ *
+ * seqDelta is relative to the previous record (the first one to the base),
+ * so a typical record costs 3 bytes plus its packed fields. Varints are
+ * LEB128 (7 bits per byte, low group first, bit7 = more).
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace journal {
+
+// Allow-listed journal types (no timer entries). 0 is never stored.
+enum class Type : uint8_t {
+  LowBatt   = 1,
+  Critical  = 2,
+  Locked    = 3,
+  Unlocked  = 4,
+  Breach    = 5,
+  FpMatch   = 6,
+  FpFail    = 7,
+  State     = 8,
+  MotorFail = 9,
+  Reset     = 10,
+};
+constexpr uint8_t kTypeMax = 10;
+
+// NDJSON names, for masters that still take one line per EVT_GENERIC.
+inline const char* typeName(uint8_t t) {
+  static const char* const kNames[kTypeMax + 1] = {
+    "UNK", "LOW_BATT", "CRITICAL", "LOCKED", "UNLOCKED", "BREACH",
+    "FP_MATCH", "FP_FAIL", "STATE", "MOTOR_FAIL", "RESET",
+  };
+  return t <= kTypeMax ? kNames[t] : kNames[0];
+}
+
+constexpr size_t kMaxVarint   = 5;    // u32
+constexpr size_t kMaxFields   = 32;   // packed field bytes per record
+constexpr size_t kRecordFixed = 2;    // type + len
+
+// ------- Varint -------
+inline size_t putVarint(uint8_t* out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = uint8_t(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = uint8_t(v);
+  return n;
+}
+
+constexpr size_t varintSize(uint32_t v) {
+  size_t n = 1;
+  while (v >= 0x80) { v >>= 7; ++n; }
+  return n;
+}
+
+// Returns bytes consumed, 0 on truncation/overlong input.
+inline size_t getVarint(const uint8_t* in, size_t len, uint32_t& v) {
+  v = 0;
+  for (size_t i = 0; i < len && i < kMaxVarint; ++i) {
+    v |= uint32_t(in[i] & 0x7F) << (7 * i);
+    if (!(in[i] & 0x80)) return i + 1;
+  }
+  return 0;
+}
+
+// ------- Records -------
+struct Record {
+  uint8_t        type     = 0;
+  uint32_t       seqDelta = 0;
+  uint8_t        len      = 0;
+  const uint8_t* fields   = nullptr;   // points into the parsed buffer
+};
+
+constexpr size_t recordSize(uint32_t seqDelta, size_t fieldLen) {
+  return kRecordFixed + varintSize(seqDelta) + fieldLen;
+}
+
+inline size_t putRecord(uint8_t* out, uint8_t type, uint32_t seqDelta,
+                        const uint8_t* fields, uint8_t len) {
+  size_t n = 0;
+  out[n++] = type;
+  n += putVarint(out + n, seqDelta);
+  out[n++] = len;
+  for (uint8_t i = 0; i < len; ++i) out[n++] = fields[i];
+  return n;
+}
+
+// Returns bytes consumed, 0 when the record is malformed or truncated.
+inline size_t getRecord(const uint8_t* in, size_t len, Record& r) {
+  if (len < kRecordFixed + 1) return 0;
+  r.type = in[0];
+  if (r.type == 0 || r.type > kTypeMax) return 0;
+  const size_t v = getVarint(in + 1, len - 1, r.seqDelta);
+  if (!v) return 0;
+  size_t n = 1 + v;
+  if (n >= len) return 0;
+  r.len = in[n++];
+  if (r.len > kMaxFields || n + r.len > len) return 0;
+  r.fields = in + n;
+  return n + r.len;
+}
+
+} // namespace journal
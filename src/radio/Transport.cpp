@@ -1,41 +1,43 @@
 #include <Transport.hpp>
 #include <Utils.hpp>
+#include <esp_random.h>
 
 namespace transport {
 
 namespace {
-constexpr size_t kHeaderSize = 11;     // fixed header bytes
-constexpr size_t kMaxFrameBytes = 200; // header + payload
+constexpr uint32_t kTokenScale = 1000; // milli-tokens per frame
+
+size_t trailerSize(const Header& h) {
+  return ((h.flags & kFlagAckTrailer) ? kAckTrailerSize : 0) +
+         ((h.flags & kFlagCrc16)      ? kCrc16Size      : 0);
+}
 
 bool checkHeaderFields(const Header& h) {
   if (h.version != 1) return false;
   if (h.payloadLen > kMaxFrameBytes) return false;
-  if ((kHeaderSize + h.payloadLen) > kMaxFrameBytes) return false;
+  if ((kHeaderSize + h.payloadLen + trailerSize(h)) > kMaxFrameBytes) return false;
   return true;
 }
 } // namespace
 
 // ---------------- CRC8 (poly 0x07) ----------------
+// Engine is chosen at compile time (TRANSPORT_CRC8_ENGINE, see TransportCrc.hpp).
 uint8_t TransportPort::computeCrc8(const uint8_t* data, size_t len) {
-  uint8_t crc = 0x00;
-  for (size_t i = 0; i < len; ++i) {
-    crc ^= data[i];
-    for (int b = 0; b < 8; ++b) {
-      if (crc & 0x80) crc = (crc << 1) ^ 0x07;
-      else            crc <<= 1;
-    }
-  }
-  return crc;
+  return crc::crc8(data, len);
 }
 
 // ---------------- Serializer ----------------
 bool Serializer::encode(const TransportMessage& msg, std::vector<uint8_t>& out) {
-  const Header& h = msg.header;
+  return encode(msg.header, msg.payload.data(), msg.payload.size(), out);
+}
+
+bool Serializer::encode(const Header& h, const uint8_t* payload, size_t len,
+                        std::vector<uint8_t>& out) {
   if (!checkHeaderFields(h)) return false;
-  if (msg.payload.size() != h.payloadLen) return false;
+  if (len != h.payloadLen) return false;
 
   out.clear();
-  out.reserve(kHeaderSize + msg.payload.size());
+  out.reserve(kHeaderSize + len + trailerSize(h));
 
   // Write header except crc8
   out.push_back(h.version);
@@ -54,11 +56,26 @@ bool Serializer::encode(const TransportMessage& msg, std::vector<uint8_t>& out)
   out.push_back(crc);
 
   // Payload
-  out.insert(out.end(), msg.payload.begin(), msg.payload.end());
+  out.insert(out.end(), payload, payload + len);
+
+  // Optional ack trailer: ackBase(u16 LE) + ackBits(u16 LE)
+  if (h.flags & kFlagAckTrailer) {
+    out.push_back(uint8_t(h.ackBase & 0xFF));
+    out.push_back(uint8_t((h.ackBase >> 8) & 0xFF));
+    out.push_back(uint8_t(h.ackBits & 0xFF));
+    out.push_back(uint8_t((h.ackBits >> 8) & 0xFF));
+  }
+
+  // Optional CRC-16 trailer (LE) over everything before it
+  if (h.flags & kFlagCrc16) {
+    const uint16_t c16 = crc::crc16(out.data(), out.size());
+    out.push_back(uint8_t(c16 & 0xFF));
+    out.push_back(uint8_t((c16 >> 8) & 0xFF));
+  }
   return true;
 }
 
-bool Serializer::decode(const uint8_t* buf, size_t len, TransportMessage& out) {
+bool Serializer::decodeHeader(const uint8_t* buf, size_t len, Header& out) {
   if (!buf || len < kHeaderSize) return false;
 
   Header h{};
@@ -74,21 +91,212 @@ bool Serializer::decode(const uint8_t* buf, size_t len, TransportMessage& out) {
   h.crc8       = buf[10];
 
   if (!checkHeaderFields(h)) return false;
-  if (len != (kHeaderSize + h.payloadLen)) return false;
+  size_t body = kHeaderSize + h.payloadLen;
+  if (len != (body + trailerSize(h))) return false;
 
   // Verify CRC
   const uint8_t computed = TransportPort::computeCrc8(buf, kHeaderSize - 1); // crc over header except crc8
   if (computed != h.crc8) return false;
+  if (h.flags & kFlagAckTrailer) {
+    h.ackBase = uint16_t(buf[body])     | (uint16_t(buf[body + 1]) << 8);
+    h.ackBits = uint16_t(buf[body + 2]) | (uint16_t(buf[body + 3]) << 8);
+    body += kAckTrailerSize;
+  }
+  if (h.flags & kFlagCrc16) {
+    const uint16_t rx16 = uint16_t(buf[body]) | (uint16_t(buf[body + 1]) << 8);
+    if (crc::crc16(buf, body) != rx16) return false;
+  }
+
+  out = h;
+  return true;
+}
 
+bool Serializer::decode(const uint8_t* buf, size_t len, TransportMessage& out) {
+  Header h{};
+  if (!decodeHeader(buf, len, h)) return false;
   out.header = h;
   out.payload.assign(buf + kHeaderSize, buf + kHeaderSize + h.payloadLen);
   return true;
 }
 
+bool Serializer::decode(const uint8_t* buf, size_t len, TransportMessageView& out) {
+  Header h{};
+  if (!decodeHeader(buf, len, h)) return false;
+  out.header  = h;
+  out.payload = ByteSpan(buf + kHeaderSize, h.payloadLen);
+  return true;
+}
+
+// ---------------- DedupSet ----------------
+constexpr uint32_t DedupSet::kEmpty;
+
+DedupSet::DedupSet(uint32_t entries) {
+  if (entries == 0) entries = 32;
+  uint32_t cap = 1;
+  while (cap < entries * 2) cap <<= 1;   // keep load factor <= 0.5
+  table_.assign(cap, kEmpty);
+  fifo_.assign(entries, kEmpty);
+  mask_ = cap - 1;
+}
+
+uint32_t DedupSet::slotOf_(uint32_t key) const {
+  // Fibonacci hashing spreads sequential msgIds across the table.
+  return ((key * 2654435769u) >> 7) & mask_;
+}
+
+bool DedupSet::contains(uint8_t srcId, uint16_t msgId) const {
+  const uint32_t key = key_(srcId, msgId);
+  for (uint32_t i = slotOf_(key);; i = (i + 1) & mask_) {
+    if (table_[i] == key) return true;
+    if (table_[i] == kEmpty) return false;
+  }
+}
+
+void DedupSet::insert(uint8_t srcId, uint16_t msgId) {
+  const uint32_t key = key_(srcId, msgId);
+  const uint32_t cap = static_cast<uint32_t>(fifo_.size());
+
+  // Evict oldest once the window is full.
+  if (fifoCount_ == cap) {
+    erase_(fifo_[fifoHead_]);
+    fifoHead_ = (fifoHead_ + 1) % cap;
+    --fifoCount_;
+  }
+
+  uint32_t i = slotOf_(key);
+  while (table_[i] != kEmpty) {
+    if (table_[i] == key) return;   // already present
+    i = (i + 1) & mask_;
+  }
+  table_[i] = key;
+  fifo_[(fifoHead_ + fifoCount_) % cap] = key;
+  ++fifoCount_;
+}
+
+uint32_t DedupSet::newest(uint32_t* out, uint32_t max) const {
+  const uint32_t cap = static_cast<uint32_t>(fifo_.size());
+  const uint32_t n = fifoCount_ < max ? fifoCount_ : max;
+  for (uint32_t i = 0; i < n; ++i) {
+    out[i] = fifo_[(fifoHead_ + fifoCount_ - n + i) % cap];
+  }
+  return n;
+}
+
+void DedupSet::erase_(uint32_t key) {
+  uint32_t i = slotOf_(key);
+  while (table_[i] != key) {
+    if (table_[i] == kEmpty) return;
+    i = (i + 1) & mask_;
+  }
+  // Backward-shift delete keeps probe chains intact without tombstones.
+  uint32_t j = i;
+  for (;;) {
+    table_[i] = kEmpty;
+    for (;;) {
+      j = (j + 1) & mask_;
+      if (table_[j] == kEmpty) return;
+      const uint32_t home = slotOf_(table_[j]);
+      // Move j back to i only if its home slot is not cyclically in (i, j].
+      const bool inRange = (i <= j) ? (i < home && home <= j)
+                                    : (i < home || home <= j);
+      if (!inRange) break;
+    }
+    table_[i] = table_[j];
+    i = j;
+  }
+}
+
+// ---------------- SeqWindow ----------------
+void SeqWindow::seed_(Sender& s, uint16_t msgId, uint32_t nowMs) {
+  s.highest = msgId;
+  s.bitmap  = 1;
+  s.lastMs  = nowMs;
+}
+
+bool SeqWindow::checkAndRecord(uint8_t srcId, uint16_t msgId, uint32_t nowMs) {
+  Sender* s = nullptr;
+  for (auto& e : senders_) {
+    if (e.used && e.srcId == srcId) { s = &e; break; }
+  }
+  if (!s) {
+    // New sender: take a free entry, else replace round-robin.
+    for (auto& e : senders_) {
+      if (!e.used) { s = &e; break; }
+    }
+    if (!s) {
+      s = &senders_[nextVictim_];
+      nextVictim_ = static_cast<uint8_t>((nextVictim_ + 1) % TRANSPORT_DEDUP_WINDOW_SENDERS);
+    }
+    s->used  = true;
+    s->srcId = srcId;
+    seed_(*s, msgId, nowMs);
+    return false;
+  }
+
+  const uint32_t idleMs = s->lastMs ? nowMs - s->lastMs : UINT32_MAX;
+  const int16_t diff = static_cast<int16_t>(msgId - s->highest);
+  if (diff > 0) {
+    s->bitmap  = (diff >= kWindowBits) ? 0 : (s->bitmap << diff);
+    s->bitmap |= 1;
+    s->highest = msgId;
+    s->lastMs  = nowMs;
+    return false;
+  }
+
+  const uint16_t behind = static_cast<uint16_t>(-diff);
+  if (behind < kWindowBits) {
+    const uint64_t bit = uint64_t(1) << behind;
+    s->lastMs = nowMs;
+    if (s->bitmap & bit) return true;
+    s->bitmap |= bit;
+    return false;
+  }
+  if (behind >= kRestartDelta || idleMs >= TRANSPORT_DEDUP_RESTART_IDLE_MS) {
+    // Sender counter restarted (reboot); re-seed the window.
+    seed_(*s, msgId, nowMs);
+    return false;
+  }
+  return true; // older than the window mid-stream: a late duplicate
+}
+
+uint8_t SeqWindow::save(Saved* out) const {
+  uint8_t n = 0;
+  for (const auto& e : senders_) {
+    if (!e.used) continue;
+    out[n++] = { e.srcId, e.highest, e.bitmap };
+  }
+  return n;
+}
+
+void SeqWindow::restore(const Saved* in, uint8_t n) {
+  if (n > TRANSPORT_DEDUP_WINDOW_SENDERS) n = TRANSPORT_DEDUP_WINDOW_SENDERS;
+  for (uint8_t i = 0; i < TRANSPORT_DEDUP_WINDOW_SENDERS; ++i) {
+    Sender& s = senders_[i];
+    s.used = i < n;
+    if (!s.used) continue;
+    s.srcId   = in[i].srcId;
+    s.highest = in[i].highest;
+    s.bitmap  = in[i].bitmap;
+    s.lastMs  = 0;   // silence across the sleep is unknown
+  }
+  nextVictim_ = 0;
+}
+
 // ---------------- TransportPort ----------------
 TransportPort::TransportPort(uint8_t selfId, SendFn sender, Config cfg)
-    : selfId_(selfId), sendFn_(std::move(sender)), cfg_(cfg) {
-  dedupBuf_.reserve(cfg_.dedupEntries ? cfg_.dedupEntries : 32);
+    : selfId_(selfId), sendFn_(std::move(sender)), cfg_(cfg),
+      dedupSet_(cfg.dedupEntries) {
+  // Reserve once so assign()/encode() on the hot path never reallocate.
+  txScratch_.payload.reserve(kMaxPayloadBytes);
+  ackScratch_.payload.reserve(kMaxPayloadBytes);
+  encodeBuf_.reserve(kMaxFrameBytes);
+  batchFirst_.payload.reserve(kMaxPayloadBytes);
+  txTokens_ = uint32_t(cfg_.txBurst ? cfg_.txBurst : 1) * kTokenScale;
+  lastRefillMs_ = millis();
+  batchBuf_.reserve(cfg_.batchMaxBytes > kMaxFrameBytes ? cfg_.batchMaxBytes : 0);
+  DBG_PRINTF("[TRSPRT] dedup mode=%s entries=%u\n",
+             cfg_.dedupMode == DedupMode::SlidingWindow ? "window" : "hashed",
+             (unsigned)dedupSet_.capacity());
 }
 
 bool TransportPort::registerHandler(Module module, TransportHandler* handler) {
@@ -96,166 +304,820 @@ bool TransportPort::registerHandler(Module module, TransportHandler* handler) {
   return true;
 }
 
-bool TransportPort::send(TransportMessage msg, bool highPriority) {
-  msg.header.srcId = selfId_;
-  if (!isResponse_(msg)) {
-    msg.header.msgId = nextMsgId_++;
+template <typename Fn>
+auto TransportPort::withTxRing_(TxClass cls, Fn&& fn) {
+  switch (cls) {
+    case TxClass::Critical:  return fn(txCritical_);
+    case TxClass::Control:   return fn(txControl_);
+    case TxClass::Telemetry: return fn(txTelemetry_);
+    default:                 return fn(txBulk_);
   }
-  msg.header.payloadLen = static_cast<uint8_t>(msg.payload.size());
+}
 
-  if (highPriority) txHigh_.push_back(msg);
-  else              txLow_.push_back(msg);
-  return true;
+bool TransportPort::send(const TransportMessage& msg, bool highPriority) {
+  TxOptions opt;
+  opt.cls = highPriority ? TxClass::Control : TxClass::Telemetry;
+  return send(msg, opt);
+}
+
+bool TransportPort::send(const TransportMessage& msg, const TxOptions& opt) {
+  if (msg.payload.size() > kMaxPayloadBytes) return false;
+  const size_t  len = msg.payload.size();
+  const uint8_t ci  = static_cast<uint8_t>(opt.cls) < kTxClassCount
+                          ? static_cast<uint8_t>(opt.cls) : uint8_t(TxClass::Bulk);
+  const TxClass cls = static_cast<TxClass>(ci);
+
+  Header h = msg.header;
+  h.srcId = selfId_;
+  h.payloadLen = static_cast<uint8_t>(len);
+  h.flags &= uint8_t(~(kFlagCrc16 | kFlagWindowed | kFlagAckTrailer));
+  if (isAckRequired_(h) && !isResponse_(h) && isWindowedModule_(h.module)) {
+    h.flags |= kFlagWindowed;
+  }
+  if (wantsCrc16_(h.destId) && len + kCrc16Size <= kMaxPayloadBytes) {
+    h.flags |= kFlagCrc16;
+  }
+
+  const uint32_t now = millis();
+  uint32_t deadline = 0;
+  if (opt.deadlineMs) {
+    deadline = now + opt.deadlineMs;
+    if (!deadline) deadline = 1;   // 0 means "no deadline"
+  }
+
+  Stats::TxClassStats& cs = stats_.txClass[ci];
+  bool ok = true;
+  bool replaced = false;
+  portENTER_CRITICAL(&txMux_);
+  if (!isResponse_(h)) {
+    h.msgId = nextMsgId_++;
+  }
+  FrameSlot* slot = nullptr;
+  if (opt.supersede) {
+    // Last value wins: overwrite the newest queued frame with the same key
+    // in place; it keeps its queue position (and original enqueue time).
+    slot = withTxRing_(cls, [&](auto& ring) {
+      return ring.findLast([&](const FrameSlot& s) {
+        return s.supersede && s.header.destId == h.destId &&
+               s.header.module == h.module && s.header.opCode == h.opCode;
+      });
+    });
+    if (slot) {
+      slot->header = h;
+      if (len) memcpy(slot->payload, msg.payload.data(), len);
+      replaced = true;
+      cs.superseded++;
+    }
+  }
+  if (!slot) {
+    slot = withTxRing_(cls, [&](auto& ring) {
+      return ring.push(h, msg.payload.data(), len);
+    });
+    if (slot) {
+      if (++cs.depth > cs.maxDepth) cs.maxDepth = cs.depth;
+    } else {
+      cs.drops++;
+      ok = false;
+    }
+  }
+  if (slot) {
+    slot->deadlineMs = deadline;
+    slot->supersede  = opt.supersede;
+  }
+  portEXIT_CRITICAL(&txMux_);
+
+  if (ok && !replaced && wakeFn_) wakeFn_();
+  if (txTapFn_) txTapFn_(msg);
+  if (!ok) {
+    DBG_PRINTF("[TRSPRT][TX] queue full (class %u) mod=0x%02X op=0x%02X dropped\n",
+               (unsigned)ci, (unsigned)h.module, (unsigned)h.opCode);
+  }
+  return ok;
+}
+
+bool TransportPort::wantsCrc16_(uint8_t destId) const {
+  if (cfg_.crc16) return true;
+  return (crc16Peers_[destId >> 3] & (1u << (destId & 7))) != 0;
+}
+
+void TransportPort::loadSlot_(const FrameSlot& slot, TransportMessage& out) {
+  out.header = slot.header;
+  out.payload.assign(slot.payload, slot.payload + slot.header.payloadLen);
 }
 
-bool TransportPort::sendNow_(TransportMessage& msg) {
-  std::vector<uint8_t> buf;
-  if (!Serializer::encode(msg, buf)) return false;
-  const bool ok = sendFn_ ? sendFn_(msg, buf.data(), buf.size()) : false;
-  if (ok && isAckRequired_(msg) && !isResponse_(msg)) {
-    Pending p;
-    p.msg = msg;
-    p.attempts = 1;
-    p.lastSendMs = millis();
-    pending_[msg.header.msgId] = p;
+bool TransportPort::transmit_(const TransportMessage& msg) {
+  if (!Serializer::encode(msg, encodeBuf_)) {
+    stats_.txEncodeErrors++;
+    return false;
   }
+  return sendFn_ ? sendFn_(msg, encodeBuf_.data(), encodeBuf_.size()) : false;
+}
+
+bool TransportPort::sendNow_(const TransportMessage& msg) {
+  const bool ok = transmit_(msg);
+  if (ok) addPending_(msg.header, encodeBuf_.data(), encodeBuf_.size(), millis());
   return ok;
 }
 
+bool TransportPort::inFlightFull_(const Header& h) const {
+  if (!isAckRequired_(h) || isResponse_(h)) return false;
+  if (h.flags & kFlagWindowed) {
+    return windowedPending_ >= cfg_.windowSize || pendingCount_ >= TRANSPORT_PENDING_SLOTS;
+  }
+  if (!cfg_.maxInFlight) return false;
+  return uint8_t(pendingCount_ - windowedPending_) >= cfg_.maxInFlight;
+}
+
+void TransportPort::refillTokens_(uint32_t now) {
+  const uint32_t cap = uint32_t(cfg_.txBurst ? cfg_.txBurst : 1) * kTokenScale;
+  const uint32_t elapsed = now - lastRefillMs_;
+  lastRefillMs_ = now;
+  if (!cfg_.txRatePerSec) { txTokens_ = cap; return; }   // pacing disabled
+  // rate tokens/s == rate milli-tokens/ms
+  const uint64_t t = uint64_t(txTokens_) + uint64_t(elapsed) * cfg_.txRatePerSec;
+  txTokens_ = (t > cap) ? cap : uint32_t(t);
+}
+
+bool TransportPort::takeToken_() {
+  if (txTokens_ < kTokenScale) return false;
+  txTokens_ -= kTokenScale;
+  return true;
+}
+
+void TransportPort::noteTxLatency_(const FrameSlot& slot, uint32_t now) {
+  const uint32_t lat = now - slot.enqueuedMs;
+  stats_.txSent++;
+  stats_.txLatencyLastMs = lat;
+  stats_.txLatencySumMs += lat;
+  if (lat > stats_.txLatencyMaxMs) stats_.txLatencyMaxMs = lat;
+}
+
+void TransportPort::addPending_(const Header& h, const uint8_t* frame, size_t len,
+                                uint32_t now) {
+  if (!isAckRequired_(h) || isResponse_(h)) return;
+  if (len > kMaxFrameBytes) return;
+
+  // Re-arm an existing entry for the same msgId, else take a free slot.
+  int slot = -1;
+  for (uint8_t i = 0; i < TRANSPORT_PENDING_SLOTS; ++i) {
+    if (pending_[i].used && pending_[i].header.msgId == h.msgId) {
+      heapRemove_(i);
+      slot = i;
+      break;
+    }
+    if (slot < 0 && !pending_[i].used) slot = i;
+  }
+  if (slot < 0) {
+    stats_.txPendingFull++;
+    DBG_PRINTF("[TRSPRT][TX] pending pool full, msgId=%u not tracked\n", (unsigned)h.msgId);
+    return;
+  }
+
+  Pending& p = pending_[slot];
+  p.used       = true;
+  p.header     = h;
+  if (h.flags & kFlagWindowed) windowedPending_++;
+  p.attempts   = 1;
+  p.lastSendMs = now;
+  p.deadlineMs = now + backoffMs_(1);
+  p.frameLen   = static_cast<uint8_t>(len);
+  memcpy(p.frame, frame, len);
+  heapPush_(static_cast<uint8_t>(slot));
+}
+
+// Exponential backoff: retryMs * 2^(attempts-1), capped, plus random jitter.
+uint32_t TransportPort::backoffMs_(uint8_t attempts) {
+  uint32_t d = cfg_.retryMs ? cfg_.retryMs : 1;
+  for (uint8_t i = 1; i < attempts && d < cfg_.retryMaxMs; ++i) d <<= 1;
+  if (cfg_.retryMaxMs && d > cfg_.retryMaxMs) d = cfg_.retryMaxMs;
+  if (cfg_.retryJitterPct) {
+    const uint32_t span = (d * cfg_.retryJitterPct) / 100;
+    if (span) d += esp_random() % (span + 1);
+  }
+  return d;
+}
+
+// ---------------- Retry heap (min on deadlineMs, wrap-safe) ----------------
+bool TransportPort::heapLess_(uint8_t a, uint8_t b) const {
+  return int32_t(pending_[retryHeap_[a]].deadlineMs - pending_[retryHeap_[b]].deadlineMs) < 0;
+}
+
+void TransportPort::heapSwap_(uint8_t a, uint8_t b) {
+  const uint8_t t = retryHeap_[a];
+  retryHeap_[a] = retryHeap_[b];
+  retryHeap_[b] = t;
+  pending_[retryHeap_[a]].heapPos = a;
+  pending_[retryHeap_[b]].heapPos = b;
+}
+
+void TransportPort::heapSiftUp_(uint8_t pos) {
+  while (pos > 0) {
+    const uint8_t parent = (pos - 1) / 2;
+    if (!heapLess_(pos, parent)) break;
+    heapSwap_(pos, parent);
+    pos = parent;
+  }
+}
+
+void TransportPort::heapSiftDown_(uint8_t pos) {
+  for (;;) {
+    const uint8_t l = 2 * pos + 1;
+    const uint8_t r = l + 1;
+    uint8_t m = pos;
+    if (l < pendingCount_ && heapLess_(l, m)) m = l;
+    if (r < pendingCount_ && heapLess_(r, m)) m = r;
+    if (m == pos) return;
+    heapSwap_(pos, m);
+    pos = m;
+  }
+}
+
+void TransportPort::heapPush_(uint8_t slot) {
+  const uint8_t pos = pendingCount_++;
+  retryHeap_[pos] = slot;
+  pending_[slot].heapPos = pos;
+  heapSiftUp_(pos);
+}
+
+void TransportPort::heapRemove_(uint8_t slot) {
+  const uint8_t pos  = pending_[slot].heapPos;
+  const uint8_t last = --pendingCount_;
+  pending_[slot].used = false;
+  if (pending_[slot].header.flags & kFlagWindowed) windowedPending_--;
+  if (pos == last) return;
+  heapSwap_(pos, last);
+  heapSiftDown_(pos);
+  heapSiftUp_(pos);
+}
+
+void TransportPort::loadPending_(const Pending& p, TransportMessage& out) const {
+  out.header = p.header;
+  out.payload.assign(p.frame + kHeaderSize, p.frame + kHeaderSize + p.header.payloadLen);
+}
+
+void TransportPort::serviceRetries_(uint32_t now) {
+  while (pendingCount_) {
+    const uint8_t slot = retryHeap_[0];
+    Pending& p = pending_[slot];
+    if (int32_t(now - p.deadlineMs) < 0) return;   // earliest is not due yet
+
+    if (p.attempts >= cfg_.maxRetries) {
+      stats_.txTimeouts++;
+      loadPending_(p, txScratch_);
+      heapRemove_(slot);
+      auto handlerIt = handlers_.find(txScratch_.header.module);
+      if (handlerIt != handlers_.end() && handlerIt->second &&
+          (!enterFn_ || enterFn_())) {
+        handlerIt->second->onAckTimeout(txScratch_);
+        if (leaveFn_) leaveFn_();
+      }
+      continue;
+    }
+
+    if (!takeToken_()) return;   // paced; retry on a later tick
+    p.attempts++;
+    p.lastSendMs = now;
+    p.deadlineMs = now + backoffMs_(p.attempts);
+    heapSiftDown_(0);
+    stats_.txRetries++;
+
+    // Resend the cached frame; the bridge still needs the message view.
+    loadPending_(p, txScratch_);
+    if (sendFn_) sendFn_(txScratch_, p.frame, p.frameLen);
+  }
+}
+
+const FrameSlot* TransportPort::txHead_(uint32_t now) {
+  for (uint8_t c = 0; c < kTxClassCount; ++c) {
+    const TxClass cls = static_cast<TxClass>(c);
+    Stats::TxClassStats& cs = stats_.txClass[c];
+    const FrameSlot* head = withTxRing_(cls, [&](auto& ring) -> const FrameSlot* {
+      while (!ring.empty()) {
+        const FrameSlot& f = ring.front();
+        if (!f.deadlineMs || int32_t(now - f.deadlineMs) < 0) return &f;
+        ring.pop();            // stale: never worth the airtime
+        cs.depth--;
+        cs.expired++;
+      }
+      return nullptr;
+    });
+    if (head) {
+      txHeadClass_ = cls;
+      return head;
+    }
+  }
+  return nullptr;
+}
+
+void TransportPort::popTxHead_() {
+  withTxRing_(txHeadClass_, [](auto& ring) { ring.pop(); });
+  Stats::TxClassStats& cs = stats_.txClass[static_cast<uint8_t>(txHeadClass_)];
+  cs.depth--;
+  cs.sent++;
+}
+
+// Returns true when a queued frame was consumed (sent or dropped on failure).
+bool TransportPort::sendOne_() {
+  const uint32_t now = millis();
+  portENTER_CRITICAL(&txMux_);
+  const FrameSlot* head = txHead_(now);
+  if (!head) {
+    portEXIT_CRITICAL(&txMux_);
+    return false;
+  }
+  loadSlot_(*head, txScratch_);
+  noteTxLatency_(*head, now);
+  popTxHead_();
+  portEXIT_CRITICAL(&txMux_);
+  attachAck_(txScratch_.header);
+  sendNow_(txScratch_);
+  return true;
+}
+
+// Returns false while the batch window is open or when the radio refused the batch.
+bool TransportPort::sendBatch_() {
+  const uint32_t now = millis();
+
+  portENTER_CRITICAL(&txMux_);
+  const FrameSlot* head = txHead_(now);
+  if (!head) {
+    portEXIT_CRITICAL(&txMux_);
+    return false;
+  }
+  const uint8_t destId = head->header.destId;
+  // Critical frames never wait for a burst to coalesce.
+  const bool    young  = txHeadClass_ != TxClass::Critical &&
+                         (now - head->enqueuedMs) < cfg_.batchWindowMs;
+  portEXIT_CRITICAL(&txMux_);
+
+  if (!batchGate_(destId)) return sendOne_();
+  if (young) return false;   // let the burst coalesce
+
+  batchBuf_.clear();
+  batchBuf_.push_back(kBatchMagic);
+  batchBuf_.push_back(0);
+  uint8_t count = 0;
+  uint8_t untracked = 0;   // records with no pending entry (no retry)
+
+  for (;;) {
+    portENTER_CRITICAL(&txMux_);
+    head = txHead_(now);
+    if (!head || head->header.destId != destId) {
+      portEXIT_CRITICAL(&txMux_);
+      break;
+    }
+    // The first record reserves room for a piggybacked SACK trailer.
+    const size_t frameLen = kHeaderSize + head->header.payloadLen +
+                            ((head->header.flags & kFlagCrc16) ? kCrc16Size : 0) +
+                            (count == 0 ? kAckTrailerSize : 0);
+    if (batchBuf_.size() + 1 + frameLen > cfg_.batchMaxBytes ||
+        (count > 0 && inFlightFull_(head->header))) {
+      portEXIT_CRITICAL(&txMux_);
+      break;
+    }
+    loadSlot_(*head, txScratch_);
+    noteTxLatency_(*head, now);
+    popTxHead_();
+    portEXIT_CRITICAL(&txMux_);
+
+    if (count == 0) attachAck_(txScratch_.header);
+    if (!Serializer::encode(txScratch_, encodeBuf_)) {
+      stats_.txEncodeErrors++;
+      DBG_PRINTF("[TRSPRT][TX] encode failed, msgId=%u dropped\n",
+                 (unsigned)txScratch_.header.msgId);
+      continue;
+    }
+    batchBuf_.push_back(static_cast<uint8_t>(encodeBuf_.size()));
+    batchBuf_.insert(batchBuf_.end(), encodeBuf_.begin(), encodeBuf_.end());
+    ++count;
+    if (!isAckRequired_(txScratch_.header) || isResponse_(txScratch_.header)) ++untracked;
+
+    // Arm the pending entry at once so inFlightFull_() counts it for the
+    // next record; if the send fails, the retry path resends it alone.
+    addPending_(txScratch_.header, encodeBuf_.data(), encodeBuf_.size(), now);
+    if (count == 1) {
+      batchFirst_.header = txScratch_.header;
+      batchFirst_.payload.assign(txScratch_.payload.begin(), txScratch_.payload.end());
+    }
+  }
+
+  if (count == 0) return false;
+  if (count == 1) {                               // nothing to aggregate
+    sendNow_(batchFirst_);                        // re-arms the same msgId
+    return true;
+  }
+
+  batchBuf_[1] = count;
+  const bool ok = batchFn_(destId, batchBuf_.data(), batchBuf_.size());
+  if (ok) {
+    stats_.txBatches++;
+    stats_.txBatchedMsgs += count;
+  } else {
+    // Tracked records retry from pending; the rest are gone.
+    stats_.txBatchFails++;
+    stats_.txBatchLost += untracked;
+  }
+  DBG_PRINTF("[TRSPRT][TX] batch dst=%u msgs=%u bytes=%u %s\n",
+             (unsigned)destId, (unsigned)count, (unsigned)batchBuf_.size(),
+             ok ? "OK" : "FAIL");
+  return ok;   // a failed send stops this tick's drain
+}
+
 void TransportPort::tick() {
   // Drain RX before transmitting so responses can be issued even while TX queue is busy.
   drainRxQueue();
 
-  // Transmit queued (high priority first)
-  if (!txHigh_.empty()) {
-    TransportMessage msg = txHigh_.front();
-    txHigh_.erase(txHigh_.begin());
-    sendNow_(msg);
-  } else if (!txLow_.empty()) {
-    TransportMessage msg = txLow_.front();
-    txLow_.erase(txLow_.begin());
-    sendNow_(msg);
+  const uint32_t now = millis();
+  refillTokens_(now);
+
+  // Drain every ready frame in class order (Critical, Control, Telemetry,
+  // Bulk), aggregated when a batch sender is set, until the queues empty,
+  // the bucket runs dry, or the in-flight cap is hit. Critical frames are
+  // not held back by an empty bucket.
+  const bool batching = batchFn_ && batchGate_ && cfg_.batchMaxBytes > kMaxFrameBytes;
+  for (;;) {
+    portENTER_CRITICAL(&txMux_);
+    const FrameSlot* head = txHead_(now);
+    const bool full = head && inFlightFull_(head->header);
+    const bool critical = head && txHeadClass_ == TxClass::Critical;
+    portEXIT_CRITICAL(&txMux_);
+    if (!head) break;
+    if (full) { stats_.txInFlightFull++; break; }
+    if (!critical && txTokens_ < kTokenScale) { stats_.txRateLimited++; break; }
+
+    const bool sent = batching ? sendBatch_() : sendOne_();
+    if (!sent) break;   // batch window still open, or the radio refused it
+    takeToken_();
+  }
+
+  // Handle retries (paced by the same bucket; deferred when it is empty)
+  serviceRetries_(now);
+
+  // SACKs that found no outgoing frame to ride on
+  flushAcks_(now);
+}
+
+void TransportPort::onReceiveRaw(const uint8_t* data, size_t len) {
+  if (data && len >= kBatchHeaderSize && data[0] == kBatchMagic) {
+    unpackBatch_(data, len);
+    return;
+  }
+
+  Header h{};
+  if (!Serializer::decodeHeader(data, len, h)) {
+    stats_.rxInvalid++;
+    return;
+  }
+  // Peer speaks CRC-16: answer it with trailers from now on.
+  if (h.flags & kFlagCrc16) crc16Peers_[h.srcId >> 3] |= uint8_t(1u << (h.srcId & 7));
+
+  DBG_PRINTF("[ESPNOW][RX] TRSPRT src=%u dst=%u mod=0x%02X op=0x%02X type=0x%02X flags=0x%02X len=%u\n",
+               h.srcId,
+               h.destId,
+               (unsigned)h.module,
+               (unsigned)h.opCode,
+               (unsigned)h.type,
+               (unsigned)h.flags,
+               (unsigned)h.payloadLen);
+
+  const bool linkAck  = (h.module == static_cast<uint8_t>(Module::Link));
+  const bool windowed = (h.flags & kFlagWindowed) && !(h.flags & kFlagResponse);
+  const uint32_t nowMs = millis();
+
+  portENTER_CRITICAL(&rxMux_);
+  const uint32_t t0 = ESP.getCycleCount();
+  stats_.rxFrames++;
+  bool full = false;
+  if (rxQueue_.full()) {
+    // Drop before recording so the sender's retry is not seen as a duplicate.
+    full = true;
+    stats_.rxQueueDrops++;
+  } else if (!linkAck && isDuplicate_(h, nowMs)) {
+    // A retransmitted windowed frame means our SACK was lost: owe it again.
+    if (windowed) noteWindowedRx_(h.srcId, h.msgId, nowMs);
+    stats_.rxDuplicates++;
+  } else {
+    if (windowed) noteWindowedRx_(h.srcId, h.msgId, nowMs);
+    // Queue for deferred processing to keep RX independent from TX path.
+    rxQueue_.push(h, data + kHeaderSize, h.payloadLen);
+  }
+  const uint32_t dt = ESP.getCycleCount() - t0;
+  stats_.critLastCycles = dt;
+  if (dt > stats_.critMaxCycles) stats_.critMaxCycles = dt;
+  portEXIT_CRITICAL(&rxMux_);
+
+  if (!full && wakeFn_) wakeFn_();
+  if (full) {
+    DBG_PRINTF("[TRSPRT][RX] queue full, dropped src=%u msgId=%u\n",
+               (unsigned)h.srcId, (unsigned)h.msgId);
   }
+}
 
-  // Handle retries
+uint32_t TransportPort::nextWakeMs(uint32_t maxMs) {
   const uint32_t now = millis();
-  for (auto it = pending_.begin(); it != pending_.end(); ) {
-    Pending& p = it->second;
-    if ((now - p.lastSendMs) >= cfg_.retryMs) {
-      if (p.attempts >= cfg_.maxRetries) {
-        auto handlerIt = handlers_.find(p.msg.header.module);
-        if (handlerIt != handlers_.end() && handlerIt->second) {
-          handlerIt->second->onAckTimeout(p.msg);
-        }
-        it = pending_.erase(it);
-        continue;
-      }
-      p.attempts++;
-      p.lastSendMs = now;
-      sendNow_(p.msg);
+  uint32_t wait = maxMs;
+
+  portENTER_CRITICAL(&rxMux_);
+  const bool rxReady = !rxQueue_.empty();
+  portEXIT_CRITICAL(&rxMux_);
+  if (rxReady) return 0;
+
+  refillTokens_(now);
+  const uint32_t tokenWait =
+      (txTokens_ >= kTokenScale || !cfg_.txRatePerSec)
+          ? 0
+          : (kTokenScale - txTokens_ + cfg_.txRatePerSec - 1) / cfg_.txRatePerSec;
+
+  portENTER_CRITICAL(&txMux_);
+  const FrameSlot* head = txHead_(now);
+  const bool     txReady   = head && !inFlightFull_(head->header);
+  const bool     critical  = head && txHeadClass_ == TxClass::Critical;
+  const uint32_t headAgeMs = head ? (now - head->enqueuedMs) : 0;
+  portEXIT_CRITICAL(&txMux_);
+
+  if (txReady) {
+    if (critical) return 0;
+    uint32_t w = tokenWait;
+    const bool batching = batchFn_ && batchGate_ && cfg_.batchMaxBytes > kMaxFrameBytes;
+    if (batching && headAgeMs < cfg_.batchWindowMs) {
+      const uint32_t window = cfg_.batchWindowMs - headAgeMs;
+      if (window > w) w = window;
     }
-    ++it;
+    if (w < wait) wait = w;
+  }
+
+  portENTER_CRITICAL(&rxMux_);
+  for (const auto& a : ackOut_) {
+    if (!a.used || !a.unacked) continue;
+    const uint32_t age = now - a.firstMs;
+    const uint32_t w = age >= cfg_.ackDelayMs ? 0 : cfg_.ackDelayMs - age;
+    if (w < wait) wait = w;
+  }
+  portEXIT_CRITICAL(&rxMux_);
+
+  if (pendingCount_) {
+    const int32_t due = int32_t(pending_[retryHeap_[0]].deadlineMs - now);
+    uint32_t w = due > 0 ? uint32_t(due) : 0;
+    if (w < tokenWait) w = tokenWait;
+    if (w < wait) wait = w;
   }
+  return wait;
 }
 
-void TransportPort::onReceiveRaw(const uint8_t* data, size_t len) {
-  TransportMessage msg;
-  if (!Serializer::decode(data, len, msg)) return;
+// ---------------- Windowed (SACK) mode ----------------
+void TransportPort::setWindowedModule(Module module, bool enabled) {
+  const uint8_t m = static_cast<uint8_t>(module);
+  if (m >= 32) return;
+  if (enabled) windowedModules_ |= (1u << m);
+  else         windowedModules_ &= ~(1u << m);
+}
 
-  DBG_PRINTF("[ESPNOW][RX] TRSPRT src=%u dst=%u mod=0x%02X op=0x%02X type=0x%02X flags=0x%02X len=%u\n",
-               msg.header.srcId,
-               msg.header.destId,
-               (unsigned)msg.header.module,
-               (unsigned)msg.header.opCode,
-               (unsigned)msg.header.type,
-               (unsigned)msg.header.flags,
-               (unsigned)msg.header.payloadLen);
-
-  DedupKey key{msg.header.srcId, msg.header.msgId};
+bool TransportPort::isWindowedModule_(uint8_t module) const {
+  return module < 32 && (windowedModules_ & (1u << module)) != 0;
+}
+
+void TransportPort::noteWindowedRx_(uint8_t peer, uint16_t msgId, uint32_t now) {
+  AckOut* a = nullptr;
+  for (auto& e : ackOut_) {
+    if (e.used && e.peer == peer) { a = &e; break; }
+  }
+  if (!a) {
+    for (auto& e : ackOut_) {
+      if (!e.used) { a = &e; break; }
+    }
+    if (!a) {
+      a = &ackOut_[ackOutVictim_];
+      ackOutVictim_ = uint8_t((ackOutVictim_ + 1) % TRANSPORT_ACK_PEERS);
+    }
+    *a = AckOut();
+    a->used = true;
+    a->peer = peer;
+    a->base = msgId;
+  } else {
+    const int16_t diff = int16_t(msgId - a->base);
+    if (diff > 0) {
+      // Old base becomes bit (diff-1).
+      a->bits = (diff > 16) ? 0 : uint16_t(uint32_t(a->bits) << diff);
+      if (diff <= 16) a->bits |= uint16_t(1u << (diff - 1));
+      a->base = msgId;
+    } else if (diff < 0 && diff >= -16) {
+      a->bits |= uint16_t(1u << (-diff - 1));
+    }
+  }
+  if (a->unacked == 0) a->firstMs = now;
+  if (a->unacked < 0xFF) a->unacked++;
+}
+
+// Piggyback the SACK we owe h.destId when it fits in the frame.
+void TransportPort::attachAck_(Header& h) {
+  if (h.flags & kFlagAckTrailer) return;
+  if (kHeaderSize + h.payloadLen + trailerSize(h) + kAckTrailerSize > kMaxFrameBytes) return;
   portENTER_CRITICAL(&rxMux_);
-  if (isDuplicate_(key)) {
+  for (auto& a : ackOut_) {
+    if (!a.used || a.peer != h.destId || !a.unacked) continue;
+    h.flags  |= kFlagAckTrailer;
+    h.ackBase = a.base;
+    h.ackBits = a.bits;
+    a.unacked = 0;
+    stats_.sackPiggybacked++;
+    break;
+  }
+  portEXIT_CRITICAL(&rxMux_);
+}
+
+void TransportPort::applySack_(uint8_t peer, uint16_t base, uint16_t bits) {
+  for (uint8_t i = 0; i < TRANSPORT_PENDING_SLOTS; ++i) {
+    Pending& p = pending_[i];
+    if (!p.used || !(p.header.flags & kFlagWindowed) || p.header.destId != peer) continue;
+    const int16_t d = int16_t(base - p.header.msgId);
+    const bool acked = (d == 0) || (d >= 1 && d <= 16 && (bits & (1u << (d - 1))));
+    if (!acked) continue;
+    stats_.sackCompleted++;
+    heapRemove_(i);
+  }
+}
+
+// Emit one compact Link ack per peer once enough frames or time accumulated.
+void TransportPort::flushAcks_(uint32_t now) {
+  const uint8_t burst = cfg_.windowSize > 1 ? uint8_t(cfg_.windowSize / 2) : 1;
+  for (uint8_t i = 0; i < TRANSPORT_ACK_PEERS; ++i) {
+    Header h{};
+    bool due = false;
+    portENTER_CRITICAL(&rxMux_);
+    AckOut& a = ackOut_[i];
+    if (a.used && a.unacked &&
+        (a.unacked >= burst || (now - a.firstMs) >= cfg_.ackDelayMs)) {
+      h.destId  = a.peer;
+      h.ackBase = a.base;
+      h.ackBits = a.bits;
+      a.unacked = 0;
+      due = true;
+    }
     portEXIT_CRITICAL(&rxMux_);
-    return;
+    if (!due) continue;
+
+    // msgId 0, not deduped by the receiver (acks are idempotent).
+    TransportMessage& ack = ackScratch_;
+    ack.header         = h;
+    ack.header.version = 1;
+    ack.header.msgId   = 0;
+    ack.header.srcId   = selfId_;
+    ack.header.module  = static_cast<uint8_t>(Module::Link);
+    ack.header.type    = static_cast<uint8_t>(MessageType::Event);
+    ack.header.opCode  = kOpLinkAck;
+    ack.header.flags   = kFlagAckTrailer;
+    if (wantsCrc16_(h.destId)) ack.header.flags |= kFlagCrc16;
+    ack.header.payloadLen = 0;
+    ack.payload.clear();
+    if (transmit_(ack)) stats_.sackFramesSent++;
   }
-  recordDedup_(key);
+}
 
-  // Queue for deferred processing to keep RX independent from TX path.
-  rxQueue_.push_back(msg);
-  portEXIT_CRITICAL(&rxMux_);
+void TransportPort::unpackBatch_(const uint8_t* data, size_t len) {
+  const uint8_t count = data[1];
+  size_t off = kBatchHeaderSize;
+  stats_.rxBatches++;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (off >= len) break;
+    const size_t recLen = data[off++];
+    if (recLen == 0 || off + recLen > len) {
+      stats_.rxInvalid++;
+      break;                         // truncated/malformed: drop the rest
+    }
+    if (data[off] != kBatchMagic) {  // no nesting
+      onReceiveRaw(data + off, recLen);
+    }
+    off += recLen;
+  }
 }
 
 void TransportPort::drainRxQueue() {
   for (;;) {
-    TransportMessage msg;
     portENTER_CRITICAL(&rxMux_);
     if (rxQueue_.empty()) {
       portEXIT_CRITICAL(&rxMux_);
       break;
     }
-    msg = rxQueue_.front();
-    rxQueue_.erase(rxQueue_.begin());
+    const FrameSlot& slot = rxQueue_.front();
+    portEXIT_CRITICAL(&rxMux_);
+
+    // Dispatch straight from the ring slot; the producer only writes the
+    // tail, so the head stays stable until we pop it.
+    const uint32_t lat = micros() - slot.enqueuedUs;
+    stats_.rxDispatchLastUs = lat;
+    if (lat > stats_.rxDispatchMaxUs) stats_.rxDispatchMaxUs = lat;
+    handleIncoming_(TransportMessageView(slot.header,
+                                         ByteSpan(slot.payload, slot.header.payloadLen)));
+
+    portENTER_CRITICAL(&rxMux_);
+    rxQueue_.pop();
     portEXIT_CRITICAL(&rxMux_);
-    handleIncoming_(msg);
   }
 }
 
-void TransportPort::handleIncoming_(const TransportMessage& msg) {
-  if (isResponse_(msg)) {
+void TransportPort::handleIncoming_(const TransportMessageView& msg) {
+  if (msg.header.flags & kFlagAckTrailer) {
+    applySack_(msg.header.srcId, msg.header.ackBase, msg.header.ackBits);
+  }
+  if (msg.header.module == static_cast<uint8_t>(Module::Link)) return;  // control only
+
+  if (isResponse_(msg.header)) {
     completePending_(msg.header.msgId);
   }
   const uint8_t module = msg.header.module;
   auto it = handlers_.find(module);
   if (it != handlers_.end() && it->second) {
-    it->second->onMessage(msg);
+    if (enterFn_ && !enterFn_()) return;   // owner is stopping the port
+    it->second->onMessageView(msg);
+    if (leaveFn_) leaveFn_();
   }
-  maybeAutoAck_(msg);
+  maybeAutoAck_(msg.header);
 }
 
-void TransportPort::maybeAutoAck_(const TransportMessage& msg) {
-  if (!isAckRequired_(msg)) return;
-  if (isResponse_(msg)) return;
+void TransportPort::maybeAutoAck_(const Header& req) {
+  if (!isAckRequired_(req)) return;
+  if (isResponse_(req)) return;
+  if (req.flags & kFlagWindowed) return;   // covered by SACK
 
-  // Build minimal OK response
-  TransportMessage resp;
+  // Build minimal OK response (reuses the ack scratch message; no allocation)
+  TransportMessage& resp = ackScratch_;
   resp.header.version = 1;
-  resp.header.msgId   = msg.header.msgId;
+  resp.header.msgId   = req.msgId;
   resp.header.srcId   = selfId_;
-  resp.header.destId  = msg.header.srcId;
-  resp.header.module  = msg.header.module;
+  resp.header.destId  = req.srcId;
+  resp.header.module  = req.module;
   resp.header.type    = static_cast<uint8_t>(MessageType::Response);
-  resp.header.opCode  = msg.header.opCode;
-  resp.header.flags   = 0x02; // isResponse
-  resp.payload = { static_cast<uint8_t>(StatusCode::OK) };
+  resp.header.opCode  = req.opCode;
+  resp.header.flags   = kFlagResponse;
+  if (wantsCrc16_(resp.header.destId)) resp.header.flags |= kFlagCrc16;
+  resp.payload.assign(1, static_cast<uint8_t>(StatusCode::OK));
   resp.header.payloadLen = static_cast<uint8_t>(resp.payload.size());
+  attachAck_(resp.header);
 
   sendNow_(resp);
 }
 
-void TransportPort::recordDedup_(const DedupKey& k) {
-  if (dedupBuf_.size() >= cfg_.dedupEntries && !dedupBuf_.empty()) {
-    dedupBuf_.erase(dedupBuf_.begin()); // drop oldest
+// ---------------- Warm resume ----------------
+void TransportPort::exportResume(ResumeState& out) {
+  memset(&out, 0, sizeof(out));
+  portENTER_CRITICAL(&txMux_);
+  out.nextMsgId = nextMsgId_;
+  portEXIT_CRITICAL(&txMux_);
+  portENTER_CRITICAL(&rxMux_);
+  out.senders = dedupWindow_.save(out.window);
+  out.keys    = static_cast<uint8_t>(dedupSet_.newest(out.dedupKeys, TRANSPORT_RESUME_DEDUP_KEYS));
+  portEXIT_CRITICAL(&rxMux_);
+}
+
+void TransportPort::importResume(const ResumeState& in) {
+  const uint8_t keys = in.keys > TRANSPORT_RESUME_DEDUP_KEYS ? TRANSPORT_RESUME_DEDUP_KEYS : in.keys;
+  portENTER_CRITICAL(&txMux_);
+  if (in.nextMsgId) nextMsgId_ = in.nextMsgId;
+  portEXIT_CRITICAL(&txMux_);
+  portENTER_CRITICAL(&rxMux_);
+  dedupWindow_.restore(in.window, in.senders);
+  for (uint8_t i = 0; i < keys; ++i) {
+    const uint32_t k = in.dedupKeys[i];
+    dedupSet_.insert(static_cast<uint8_t>(k >> 16), static_cast<uint16_t>(k));
   }
-  dedupBuf_.push_back(k);
+  portEXIT_CRITICAL(&rxMux_);
 }
 
-bool TransportPort::isDuplicate_(const DedupKey& k) const {
-  for (const auto& e : dedupBuf_) {
-    if (e.srcId == k.srcId && e.msgId == k.msgId) return true;
+// Called under rxMux_. Records the frame when it is new.
+bool TransportPort::isDuplicate_(const Header& h, uint32_t nowMs) {
+  if (cfg_.dedupMode == DedupMode::SlidingWindow && !(h.flags & kFlagResponse)) {
+    return dedupWindow_.checkAndRecord(h.srcId, h.msgId, nowMs);
   }
+  if (dedupSet_.contains(h.srcId, h.msgId)) return true;
+  dedupSet_.insert(h.srcId, h.msgId);
   return false;
 }
 
 void TransportPort::completePending_(uint16_t msgId) {
-  pending_.erase(msgId);
+  for (uint8_t i = 0; i < TRANSPORT_PENDING_SLOTS; ++i) {
+    Pending& p = pending_[i];
+    if (!p.used || p.header.msgId != msgId) continue;
+    const uint32_t now = millis();
+    stats_.acks++;
+    if (p.attempts == 1) {   // RTT is ambiguous after a retry
+      const uint32_t rtt = now - p.lastSendMs;
+      stats_.ackRttLastMs = rtt;
+      stats_.ackRttSumMs += rtt;
+      stats_.ackRttSamples++;
+      if (rtt > stats_.ackRttMaxMs) stats_.ackRttMaxMs = rtt;
+    }
+    heapRemove_(i);
+    return;
+  }
 }
 
-bool TransportPort::isAckRequired_(const TransportMessage& msg) {
-  return (msg.header.flags & 0x01) != 0;
+bool TransportPort::isAckRequired_(const Header& h) {
+  return (h.flags & kFlagAckRequired) != 0;
 }
 
-bool TransportPort::isResponse_(const TransportMessage& msg) {
-  return (msg.header.flags & 0x02) != 0 ||
-         msg.header.type == static_cast<uint8_t>(MessageType::Response);
+bool TransportPort::isResponse_(const Header& h) {
+  return (h.flags & kFlagResponse) != 0 ||
+         h.type == static_cast<uint8_t>(MessageType::Response);
 }
 
 } // namespace transport
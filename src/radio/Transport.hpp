@@ -17,15 +17,86 @@
 
 #include <Arduino.h>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <unordered_map>
 #include <vector>
 #include <FreeRTOS.h>
+#include <TransportCrc.hpp>
+
+// ---------- Queue sizing (compile-time, frames live inline) ----------
+#ifndef TRANSPORT_RX_QUEUE_SLOTS
+#define TRANSPORT_RX_QUEUE_SLOTS      16
+#endif
+// One TX ring per TxClass.
+#ifndef TRANSPORT_TX_CRITICAL_QUEUE_SLOTS
+#define TRANSPORT_TX_CRITICAL_QUEUE_SLOTS  8
+#endif
+#ifndef TRANSPORT_TX_CONTROL_QUEUE_SLOTS
+#define TRANSPORT_TX_CONTROL_QUEUE_SLOTS   16
+#endif
+#ifndef TRANSPORT_TX_TELEMETRY_QUEUE_SLOTS
+#define TRANSPORT_TX_TELEMETRY_QUEUE_SLOTS 8
+#endif
+#ifndef TRANSPORT_TX_BULK_QUEUE_SLOTS
+#define TRANSPORT_TX_BULK_QUEUE_SLOTS      8
+#endif
+
+// ---------- Retry pool (ackRequired frames awaiting a response) ----------
+#ifndef TRANSPORT_PENDING_SLOTS
+#define TRANSPORT_PENDING_SLOTS        16  // >= Config::maxInFlight
+#endif
+
+// ---------- Windowed (SACK) mode ----------
+#ifndef TRANSPORT_ACK_PEERS
+#define TRANSPORT_ACK_PEERS            4   // peers we can owe SACKs to at once
+#endif
+
+// ---------- Dedup ----------
+#ifndef TRANSPORT_DEDUP_WINDOW_SENDERS
+#define TRANSPORT_DEDUP_WINDOW_SENDERS 8   // per-sender bitmap windows (SlidingWindow mode)
+#endif
+#ifndef TRANSPORT_DEDUP_RESTART_IDLE_MS
+#define TRANSPORT_DEDUP_RESTART_IDLE_MS 500  // silence that lets a frame behind the window re-seed it
+#endif
+#ifndef TRANSPORT_RESUME_DEDUP_KEYS
+#define TRANSPORT_RESUME_DEDUP_KEYS 16     // newest hashed-dedup keys kept across deep sleep
+#endif
 
 namespace transport {
 
+// ------- Frame limits -------
+constexpr size_t kHeaderSize      = 11;                          // fixed header bytes
+constexpr size_t kMaxFrameBytes   = 200;                         // header + payload
+constexpr size_t kMaxPayloadBytes = kMaxFrameBytes - kHeaderSize; // 189
+constexpr size_t kCrc16Size       = 2;                           // optional trailer
+
+// ------- Device state record -------
+// StateQuery response (after the status byte) and StateReport event payload:
+// armed, locked, door, breach, motor, batt, pmode, band, cfgMode, configured,
+// sleepPending, uptime ms (u32 LE), role, motion.
+constexpr size_t kStateRecordSize = 17;
+
+// ------- Batch frame -------
+// [kBatchMagic][count u8] then count x ([len u8][frame bytes]). The magic
+// can never be a frame's first byte (version must be 1).
+constexpr uint8_t kBatchMagic      = 0xBA;
+constexpr size_t  kBatchHeaderSize = 2;
+
+// ------- Header flag bits -------
+constexpr uint8_t kFlagAckRequired = 0x01;
+constexpr uint8_t kFlagResponse    = 0x02;
+constexpr uint8_t kFlagError       = 0x04;
+constexpr uint8_t kFlagCrc16       = 0x08; // CRC-16 trailer over header+payload
+constexpr uint8_t kFlagWindowed    = 0x10; // ackRequired frame acked by SACK, not per-frame
+constexpr uint8_t kFlagAckTrailer  = 0x20; // carries ackBase/ackBits trailer
+
+constexpr size_t  kAckTrailerSize  = 4;    // ackBase u16 + ackBits u16
+constexpr uint8_t kOpLinkAck       = 0x01; // Module::Link compact ack frame
+
 // ------- Enums -------
 enum class Module : uint8_t {
+  Link        = 0x00, // transport control (compact SACK frames); never dispatched
   Device      = 0x01,
   Motor       = 0x02,
   Shock       = 0x03,
@@ -38,6 +109,15 @@ enum class Module : uint8_t {
 
 enum class MessageType : uint8_t { Request = 0, Response = 1, Event = 2, Command = 3 };
 
+// TX scheduling class, served in strict priority order (lowest value first).
+enum class TxClass : uint8_t {
+  Critical  = 0, // alarms/breach/critical power: bypasses the TX token bucket
+  Control   = 1, // responses and command/state-change events
+  Telemetry = 2, // periodic state; usually superseded/deadlined
+  Bulk      = 3, // journal/log transfers
+};
+constexpr size_t kTxClassCount = 4;
+
 enum class StatusCode : uint8_t {
   OK = 0,
   INVALID_PARAM = 1,
@@ -60,9 +140,15 @@ struct Header {
   uint8_t  module      = 0;
   uint8_t  type        = 0;
   uint8_t  opCode      = 0;
-  uint8_t  flags       = 0;     // bit0=ackRequired, bit1=isResponse, bit2=isError
-  uint8_t  payloadLen  = 0;     // Must satisfy header+payload <= 200
+  uint8_t  flags       = 0;     // bit0=ackRequired, bit1=isResponse, bit2=isError, bit3=crc16,
+                                // bit4=windowed, bit5=ackTrailer
+  uint8_t  payloadLen  = 0;     // Must satisfy header+payload(+crc16) <= 200
   uint8_t  crc8        = 0;     // CRC over header bytes except crc8
+
+  // Not part of the fixed header: filled from/written to the ack trailer
+  // when flags has kFlagAckTrailer.
+  uint16_t ackBase     = 0;     // newest windowed msgId received from the peer
+  uint16_t ackBits     = 0;     // bit i => (ackBase - 1 - i) also received
 };
 
 // ------- Transport message -------
@@ -71,11 +157,195 @@ struct TransportMessage {
   std::vector<uint8_t> payload;
 };
 
+// ------- Non-owning views -------
+// Read-only pointer/length over bytes owned elsewhere (an RX ring slot or a
+// caller buffer). Mirrors the subset of std::vector handlers use.
+struct ByteSpan {
+  const uint8_t* ptr = nullptr;
+  size_t         len = 0;
+
+  ByteSpan() = default;
+  ByteSpan(const uint8_t* p, size_t n) : ptr(p), len(n) {}
+  ByteSpan(const std::vector<uint8_t>& v) : ptr(v.data()), len(v.size()) {}
+
+  size_t         size()  const { return len; }
+  bool           empty() const { return len == 0; }
+  const uint8_t* data()  const { return ptr; }
+  const uint8_t* begin() const { return ptr; }
+  const uint8_t* end()   const { return ptr + len; }
+  uint8_t operator[](size_t i) const { return ptr[i]; }
+};
+
+// Header plus a payload view. Only valid for the duration of the handler
+// call that receives it; copy out anything that must outlive it.
+struct TransportMessageView {
+  Header   header;
+  ByteSpan payload;
+
+  TransportMessageView() = default;
+  TransportMessageView(const Header& h, ByteSpan p) : header(h), payload(p) {}
+  TransportMessageView(const TransportMessage& m) : header(m.header), payload(m.payload) {}
+
+  // Owning copy, for handlers that need to keep the message.
+  void copyTo(TransportMessage& out) const {
+    out.header = header;
+    out.payload.assign(payload.begin(), payload.end());
+  }
+};
+
+// ------- Fixed-capacity frame ring -------
+// Frames are copied inline into preallocated slots, so enqueue/dequeue never
+// touch the heap and both are O(1). Not thread-safe on its own: the owner
+// guards it with a portMUX.
+struct FrameSlot {
+  Header   header;
+  uint32_t enqueuedMs = 0;
+  uint32_t enqueuedUs = 0;   // for sub-ms RX dispatch latency
+  uint32_t deadlineMs = 0;   // TX: drop if still queued at this time (0 = none)
+  bool     supersede  = false; // TX: a newer send with the same key replaces it
+  uint8_t  payload[kMaxPayloadBytes];
+};
+
+template <size_t N>
+class FrameRing {
+public:
+  static_assert(N > 0, "FrameRing needs at least one slot");
+
+  bool   empty() const { return count_ == 0; }
+  bool   full()  const { return count_ == N; }
+  size_t size()  const { return count_; }
+  static constexpr size_t capacity() { return N; }
+
+  // Copy header + payload into the tail slot. Returns the slot (so the
+  // caller can set TX metadata), or nullptr when full.
+  FrameSlot* push(const Header& h, const uint8_t* payload, size_t len) {
+    if (full() || len > kMaxPayloadBytes) return nullptr;
+    FrameSlot& s = slots_[tail_];
+    s.header = h;
+    s.header.payloadLen = static_cast<uint8_t>(len);
+    s.enqueuedMs = millis();
+    s.enqueuedUs = micros();
+    s.deadlineMs = 0;
+    s.supersede  = false;
+    if (len) memcpy(s.payload, payload, len);
+    tail_ = next_(tail_);
+    ++count_;
+    return &s;
+  }
+
+  // Oldest slot; only valid while !empty(). push() never writes the head
+  // slot, so a single consumer may read it outside the owner's lock and
+  // pop() afterwards.
+  const FrameSlot& front() const { return slots_[head_]; }
+
+  void pop() {
+    if (empty()) return;
+    head_ = next_(head_);
+    --count_;
+  }
+
+  // Newest queued slot matching `pred`, or nullptr. Writing through the
+  // result races a lock-free front() reader, so only use it on rings whose
+  // consumer reads under the owner's lock (the TX rings).
+  template <typename Pred>
+  FrameSlot* findLast(Pred pred) {
+    size_t i = tail_;
+    for (size_t n = 0; n < count_; ++n) {
+      i = (i == 0) ? N - 1 : i - 1;
+      if (pred(slots_[i])) return &slots_[i];
+    }
+    return nullptr;
+  }
+
+private:
+  static size_t next_(size_t i) { return (i + 1 == N) ? 0 : i + 1; }
+
+  FrameSlot slots_[N];
+  size_t head_  = 0;
+  size_t tail_  = 0;
+  size_t count_ = 0;
+};
+
+// ------- Dedup window -------
+// Fixed-size open-addressing set of (srcId,msgId) with a circular FIFO that
+// evicts the oldest key once `entries` keys are held. Storage is allocated
+// once at construction; contains()/insert() are O(1) (linear probing with
+// backward-shift delete, load factor <= 0.5), so a large window does not
+// lengthen the RX critical section.
+class DedupSet {
+public:
+  explicit DedupSet(uint32_t entries);
+
+  bool contains(uint8_t srcId, uint16_t msgId) const;
+  void insert(uint8_t srcId, uint16_t msgId);
+  uint32_t capacity() const { return static_cast<uint32_t>(fifo_.size()); }
+  // Copies up to max of the newest keys, oldest first; returns the count.
+  uint32_t newest(uint32_t* out, uint32_t max) const;
+
+private:
+  static constexpr uint32_t kEmpty = 0xFFFFFFFFu;
+  static uint32_t key_(uint8_t srcId, uint16_t msgId) {
+    return (static_cast<uint32_t>(srcId) << 16) | msgId;
+  }
+  uint32_t slotOf_(uint32_t key) const;
+  void erase_(uint32_t key);
+
+  std::vector<uint32_t> table_;  // power-of-two sized, kEmpty = free
+  std::vector<uint32_t> fifo_;   // insertion order for eviction
+  uint32_t mask_ = 0;
+  uint32_t fifoHead_ = 0;
+  uint32_t fifoCount_ = 0;
+};
+
+// Per-sender sliding window over msgId: highest id seen plus a 64-bit bitmap
+// of the ids just below it. A frame behind the window is a sender restart
+// (counter reset, re-seed) when the jump is large or when the sender was
+// silent for TRANSPORT_DEDUP_RESTART_IDLE_MS (a reboot always is); otherwise
+// it is a late duplicate, whatever its id.
+class SeqWindow {
+public:
+  static constexpr uint16_t kWindowBits   = 64;
+  static constexpr uint16_t kRestartDelta = 1024;
+
+  // Returns true if (srcId,msgId) was already seen; otherwise records it.
+  bool checkAndRecord(uint8_t srcId, uint16_t msgId, uint32_t nowMs);
+
+  struct Saved {
+    uint8_t  srcId;
+    uint16_t highest;
+    uint64_t bitmap;
+  };
+  uint8_t save(Saved* out) const;              // used senders; returns the count
+  void    restore(const Saved* in, uint8_t n);
+
+private:
+  struct Sender {
+    bool     used    = false;
+    uint8_t  srcId   = 0;
+    uint16_t highest = 0;
+    uint64_t bitmap  = 0;   // bit n => (highest - n) seen
+    uint32_t lastMs  = 0;   // last frame from this sender (0 = unknown)
+  };
+  static void seed_(Sender& s, uint16_t msgId, uint32_t nowMs);
+  Sender  senders_[TRANSPORT_DEDUP_WINDOW_SENDERS];
+  uint8_t nextVictim_ = 0;
+};
+
 // ------- Handler interface -------
+// Override onMessageView() to consume frames in place from the RX ring (no
+// payload copy), or onMessage() for an owning message. Each default forwards
+// to the other, so a handler must override at least one of them.
 class TransportHandler {
 public:
   virtual ~TransportHandler() = default;
-  virtual void onMessage(const TransportMessage& msg) = 0;
+  virtual void onMessage(const TransportMessage& msg) {
+    onMessageView(TransportMessageView(msg));
+  }
+  virtual void onMessageView(const TransportMessageView& view) {
+    TransportMessage msg;
+    view.copyTo(msg);
+    onMessage(msg);
+  }
   virtual void onAckTimeout(const TransportMessage& msg) {}
   virtual void onLinkState(uint8_t /*logicalId*/, bool /*online*/) {}
 };
@@ -84,7 +354,14 @@ public:
 class Serializer {
 public:
   static bool encode(const TransportMessage& msg, std::vector<uint8_t>& out);
+  static bool encode(const Header& h, const uint8_t* payload, size_t len,
+                     std::vector<uint8_t>& out);
   static bool decode(const uint8_t* buf, size_t len, TransportMessage& out);
+  // Zero-copy decode: payload view points into buf.
+  static bool decode(const uint8_t* buf, size_t len, TransportMessageView& out);
+  // Validate header/length/CRC without copying the payload; payload starts at
+  // buf + kHeaderSize on success.
+  static bool decodeHeader(const uint8_t* buf, size_t len, Header& out);
 };
 
 // ------- Transport core -------
@@ -92,20 +369,128 @@ class TransportPort {
 public:
   using SendFn = std::function<bool(const TransportMessage& msg,
                                     const uint8_t* data, size_t len)>;
+  // Batch path: can `destId` take multi-record frames, and the raw send.
+  using BatchGateFn = std::function<bool(uint8_t destId)>;
+  using BatchSendFn = std::function<bool(uint8_t destId,
+                                         const uint8_t* data, size_t len)>;
+  // Called (from the producing task) whenever RX or TX work is queued.
+  using WakeFn = std::function<void()>;
+  using EnterFn = std::function<bool()>;
+  using LeaveFn = std::function<void()>;
+  using TxTapFn = std::function<void(const TransportMessage& msg)>;
+
+  enum class DedupMode : uint8_t {
+    Hashed        = 0,  // (srcId,msgId) set of dedupEntries keys
+    SlidingWindow = 1,  // per-sender msgId bitmap; responses still use the set
+  };
 
   struct Config {
-    uint8_t  maxRetries   = 3;
-    uint32_t retryMs      = 200;
-    uint32_t dedupEntries = 32;
+    uint8_t   maxRetries   = 3;     // total attempts per ackRequired frame
+    uint32_t  retryMs      = 200;   // first retry delay; doubles per attempt
+    uint32_t  retryMaxMs   = 2000;  // backoff ceiling
+    uint8_t   retryJitterPct = 25;  // +0..N% random jitter on each delay
+    uint32_t  dedupEntries = 128;
+    DedupMode dedupMode    = DedupMode::Hashed;
+    // Append the CRC-16 trailer to every frame. When false, it is still used
+    // toward any peer that has sent us a CRC-16 frame.
+    bool      crc16        = false;
+    // Aggregation: pack queued frames for the same destId into one batch
+    // frame of at most batchMaxBytes (0 or <= kMaxFrameBytes disables).
+    // The oldest queued frame is held up to batchWindowMs so a burst can
+    // coalesce.
+    uint16_t  batchMaxBytes = 250;
+    uint16_t  batchWindowMs = 5;
+    // TX pacing: token bucket (one token per radio frame, batch or retry)
+    // and a cap on outstanding ackRequired frames (0 = no cap).
+    uint16_t  txRatePerSec  = 50;
+    uint8_t   txBurst       = 8;
+    uint8_t   maxInFlight   = 8;
+    // Windowed reliability (modules enabled with setWindowedModule()): up
+    // to windowSize ackRequired frames outstanding, acked by SACK instead of
+    // one response per frame. The receiver piggybacks the SACK trailer on
+    // any frame it sends to that peer, else emits one compact Link ack after
+    // windowSize/2 frames or ackDelayMs.
+    uint8_t   windowSize    = 8;    // <= 17 (ackBase + 16-bit bitmap)
+    uint16_t  ackDelayMs    = 20;
+  };
+
+  // Counters (read from the transport task; not reset).
+  struct Stats {
+    uint32_t rxFrames       = 0;  // frames passing header/CRC checks
+    uint32_t rxDuplicates   = 0;
+    uint32_t rxInvalid      = 0;  // failed version/length/CRC-8/CRC-16 checks
+    uint32_t rxQueueDrops   = 0;
+    uint32_t critLastCycles = 0;  // rxMux_ hold time of the last frame (CPU cycles)
+    uint32_t critMaxCycles  = 0;
+    uint32_t rxBatches      = 0;  // batch frames unpacked
+    uint32_t txBatches      = 0;  // batch frames sent
+    uint32_t txBatchedMsgs  = 0;  // messages carried inside batch frames
+    uint32_t txBatchFails   = 0;  // batch frames the radio refused
+    uint32_t txBatchLost    = 0;  // untracked messages lost with a failed batch
+    uint32_t txEncodeErrors = 0;  // dequeued messages that failed to encode
+    uint32_t txSent         = 0;  // queued messages handed to the radio
+    uint32_t txRetries      = 0;
+    uint32_t txRateLimited  = 0;  // ticks that stopped on an empty bucket
+    uint32_t txInFlightFull = 0;  // ticks that stopped on maxInFlight
+    uint32_t txLatencyLastMs = 0; // enqueue -> send of the last message
+    uint32_t txLatencyMaxMs  = 0;
+    uint32_t txLatencySumMs  = 0; // avg = sum / txSent
+    uint32_t txTimeouts      = 0; // ackRequired frames that exhausted maxRetries
+    uint32_t txPendingFull   = 0; // frames sent without retry tracking (pool full)
+    uint32_t acks            = 0; // responses that completed a pending frame
+    uint32_t ackRttLastMs    = 0; // first-attempt acks only (Karn)
+    uint32_t ackRttMaxMs     = 0;
+    uint32_t ackRttSumMs     = 0;
+    uint32_t ackRttSamples   = 0;
+    uint32_t rxDispatchLastUs = 0; // RX enqueue -> handler dispatch
+    uint32_t rxDispatchMaxUs  = 0;
+    uint32_t sackFramesSent   = 0; // compact Link ack frames
+    uint32_t sackPiggybacked  = 0; // SACK trailers carried on other frames
+    uint32_t sackCompleted    = 0; // windowed frames completed by a SACK
+
+    // Per TxClass (indexed by the enum value).
+    struct TxClassStats {
+      uint32_t depth      = 0;  // frames queued now
+      uint32_t maxDepth   = 0;
+      uint32_t sent       = 0;
+      uint32_t drops      = 0;  // rejected by send(): ring full
+      uint32_t expired    = 0;  // dropped at dequeue: deadline passed
+      uint32_t superseded = 0;  // replaced in place by a newer send()
+    };
+    TxClassStats txClass[kTxClassCount];
+  };
+
+  // Per-message TX options for send().
+  struct TxOptions {
+    TxClass  cls        = TxClass::Control;
+    uint32_t deadlineMs = 0;     // relative; drop if not sent by then (0 = never)
+    bool     supersede  = false; // last value wins: replace a queued frame with
+                                 // the same destId/module/opCode (also supersede)
+  };
+
+  // Kept across deep sleep (WarmState): our msgId counter and the newest
+  // dedup state, so ids do not restart at 1 and a retry that straddles the
+  // sleep is still recognised as a duplicate.
+  struct ResumeState {
+    uint16_t         nextMsgId;
+    uint8_t          senders;
+    uint8_t          keys;
+    SeqWindow::Saved window[TRANSPORT_DEDUP_WINDOW_SENDERS];
+    uint32_t         dedupKeys[TRANSPORT_RESUME_DEDUP_KEYS];
   };
 
   explicit TransportPort(uint8_t selfId, SendFn sender, Config cfg);
 
   bool registerHandler(Module module, TransportHandler* handler);
 
-  // Enqueue and transmit; sets msgId and srcId automatically. High-priority
-  // queue is reserved for ackRequired/control frames.
-  bool send(TransportMessage msg, bool highPriority = true);
+  // Enqueue and transmit; sets msgId and srcId automatically. Returns false
+  // when the class ring is full or the payload exceeds kMaxPayloadBytes (a
+  // superseding send that replaces a queued frame returns true).
+  // Safe to call from any task.
+  bool send(const TransportMessage& msg, const TxOptions& opt);
+
+  // Legacy form: highPriority maps to TxClass::Control, else Telemetry.
+  bool send(const TransportMessage& msg, bool highPriority = true);
 
   // Feed incoming raw bytes (from radio) into the transport.
   void onReceiveRaw(const uint8_t* data, size_t len);
@@ -116,28 +501,93 @@ public:
   // Pump retries/timeouts; call periodically from a loop or timer.
   void tick();
 
+  // Milliseconds until tick() has work again (0 = now), capped at maxMs.
+  // Lets a transport task sleep until the next RX/TX, batch window, token,
+  // or retry deadline instead of polling. Call from the tick() task.
+  uint32_t nextWakeMs(uint32_t maxMs);
+
+  // Sender-side opt-in: ackRequired frames of this module use the windowed
+  // (SACK) mode. Receivers follow the per-frame flag, so no handshake is
+  // needed; enable only toward peers that speak transport natively.
+  void setWindowedModule(Module module, bool enabled);
+
+  // Hook used to wake the task that calls tick() (see TransportManager).
+  void setWakeHook(WakeFn fn) { wakeFn_ = std::move(fn); }
+
+  // Optional guard around module handler callbacks (onMessageView,
+  // onAckTimeout). enter() returning false skips the callback and the
+  // auto-ack; leave() runs after each callback enter() allowed.
+  void setDispatchGuard(EnterFn enter, LeaveFn leave) {
+    enterFn_ = std::move(enter);
+    leaveFn_ = std::move(leave);
+  }
+
+  // Observer called once per send() (never for retries), queued or not.
+  // Runs on the sender's task; keep it short.
+  void setTxTap(TxTapFn fn) { txTapFn_ = std::move(fn); }
+
   void setSelfId(uint8_t id) { selfId_ = id; }
 
+  // Enable aggregation; without a batch sender every frame goes out alone.
+  void setBatchSender(BatchGateFn gate, BatchSendFn sender) {
+    batchGate_ = std::move(gate);
+    batchFn_   = std::move(sender);
+  }
+
+  const Stats& stats() const { return stats_; }
+
+  void exportResume(ResumeState& out);
+  void importResume(const ResumeState& in);   // before the transport task starts
+
 private:
+  // One outstanding ackRequired frame. The encoded frame is cached so a
+  // retry is a plain resend (no encode/CRC).
   struct Pending {
-    TransportMessage msg;
-    uint8_t  attempts = 0;
+    bool     used       = false;
+    uint8_t  attempts   = 0;
+    uint8_t  frameLen   = 0;
+    uint8_t  heapPos    = 0;
     uint32_t lastSendMs = 0;
+    uint32_t deadlineMs = 0;
+    Header   header;
+    uint8_t  frame[kMaxFrameBytes];
   };
 
-  struct DedupKey {
-    uint8_t  srcId;
-    uint16_t msgId;
-  };
-
-  bool sendNow_(TransportMessage& msg);
-  void handleIncoming_(const TransportMessage& msg);
-  void maybeAutoAck_(const TransportMessage& msg);
-  void recordDedup_(const DedupKey& k);
-  bool isDuplicate_(const DedupKey& k) const;
+  bool sendNow_(const TransportMessage& msg);
+  bool transmit_(const TransportMessage& msg);
+  bool sendOne_();
+  bool sendBatch_();
+  template <typename Fn> auto withTxRing_(TxClass cls, Fn&& fn);
+  const FrameSlot* txHead_(uint32_t now); // caller holds txMux_; drops expired heads
+  void popTxHead_();                      // caller holds txMux_; pops the last txHead_()
+  void addPending_(const Header& h, const uint8_t* frame, size_t len, uint32_t now);
+  uint32_t backoffMs_(uint8_t attempts);
+  void heapPush_(uint8_t slot);
+  void heapRemove_(uint8_t slot);
+  void heapSiftUp_(uint8_t pos);
+  void heapSiftDown_(uint8_t pos);
+  bool heapLess_(uint8_t a, uint8_t b) const;
+  void heapSwap_(uint8_t a, uint8_t b);
+  void serviceRetries_(uint32_t now);
+  void loadPending_(const Pending& p, TransportMessage& out) const;
+  bool isWindowedModule_(uint8_t module) const;
+  void noteWindowedRx_(uint8_t peer, uint16_t msgId, uint32_t now);  // caller holds rxMux_
+  void attachAck_(Header& h);
+  void applySack_(uint8_t peer, uint16_t base, uint16_t bits);
+  void flushAcks_(uint32_t now);
+  bool inFlightFull_(const Header& h) const;
+  void refillTokens_(uint32_t now);
+  bool takeToken_();
+  void noteTxLatency_(const FrameSlot& slot, uint32_t now);
+  void unpackBatch_(const uint8_t* data, size_t len);
+  bool wantsCrc16_(uint8_t destId) const;
+  static void loadSlot_(const FrameSlot& slot, TransportMessage& out);
+  void handleIncoming_(const TransportMessageView& msg);
+  void maybeAutoAck_(const Header& h);
+  bool isDuplicate_(const Header& h, uint32_t nowMs);
   void completePending_(uint16_t msgId);
-  static bool isAckRequired_(const TransportMessage& msg);
-  static bool isResponse_(const TransportMessage& msg);
+  static bool isAckRequired_(const Header& h);
+  static bool isResponse_(const Header& h);
 public:
   static uint8_t computeCrc8(const uint8_t* data, size_t len);
 
@@ -145,14 +595,54 @@ private:
   uint8_t selfId_;
   uint16_t nextMsgId_ = 1;
   SendFn sendFn_;
+  BatchGateFn batchGate_;
+  BatchSendFn batchFn_;
+  WakeFn      wakeFn_;
+  TxTapFn     txTapFn_;
+  EnterFn     enterFn_;
+  LeaveFn     leaveFn_;
   Config cfg_;
 
   portMUX_TYPE rxMux_ = portMUX_INITIALIZER_UNLOCKED;
-  std::vector<TransportMessage> rxQueue_;
-  std::vector<DedupKey> dedupBuf_;
-  std::vector<TransportMessage> txHigh_;
-  std::vector<TransportMessage> txLow_;
-  std::unordered_map<uint16_t, Pending> pending_; // keyed by msgId
+  portMUX_TYPE txMux_ = portMUX_INITIALIZER_UNLOCKED;
+  FrameRing<TRANSPORT_RX_QUEUE_SLOTS>      rxQueue_;
+  FrameRing<TRANSPORT_TX_CRITICAL_QUEUE_SLOTS>  txCritical_;
+  FrameRing<TRANSPORT_TX_CONTROL_QUEUE_SLOTS>   txControl_;
+  FrameRing<TRANSPORT_TX_TELEMETRY_QUEUE_SLOTS> txTelemetry_;
+  FrameRing<TRANSPORT_TX_BULK_QUEUE_SLOTS>      txBulk_;
+  TxClass   txHeadClass_ = TxClass::Critical; // class of the last txHead_()
+  uint8_t   crc16Peers_[32] = {}; // bitset of srcIds seen sending CRC-16
+  uint32_t  txTokens_ = 0;        // milli-tokens
+  uint32_t  lastRefillMs_ = 0;
+  DedupSet  dedupSet_;
+  SeqWindow dedupWindow_;
+  Stats     stats_;
+
+  // Scratch buffers reused by tick() (capacity reserved once).
+  TransportMessage txScratch_;
+  TransportMessage ackScratch_;
+  std::vector<uint8_t> encodeBuf_;
+  TransportMessage batchFirst_;
+  std::vector<uint8_t> batchBuf_;
+  // Pending pool + min-heap of slot indices ordered by deadlineMs, so
+  // tick() only touches frames that are due.
+  Pending  pending_[TRANSPORT_PENDING_SLOTS];
+  uint8_t  retryHeap_[TRANSPORT_PENDING_SLOTS] = {};
+  uint8_t  pendingCount_ = 0;
+  uint8_t  windowedPending_ = 0;
+
+  // SACK state we owe each peer (guarded by rxMux_).
+  struct AckOut {
+    bool     used    = false;
+    uint8_t  peer    = 0;
+    uint8_t  unacked = 0;       // frames received since the last SACK sent
+    uint16_t base    = 0;
+    uint16_t bits    = 0;
+    uint32_t firstMs = 0;       // first unacked frame time
+  };
+  AckOut   ackOut_[TRANSPORT_ACK_PEERS];
+  uint8_t  ackOutVictim_ = 0;
+  uint32_t windowedModules_ = 0; // bit per Module value
   std::unordered_map<uint8_t, TransportHandler*> handlers_; // module -> handler
 };
 
@@ -0,0 +1,171 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#pragma once
+/**
+ * @file TransportCrc.h
+ * @brief CRC engines used by the transport serializer.
+ *
+ *  - CRC-8  (poly 0x07, init 0x00, MSB-first): header check byte.
+ *  - CRC-16 (CCITT-FALSE, poly 0x1021, init 0xFFFF): optional trailer over
+ *    header + payload (header flag bit3).
+ *
+ * Lookup tables are generated at compile time (constexpr) and checked against
+ * the bitwise reference with static_asserts, so a table bug fails the build.
+ * The CRC-8 engine used by crc8() is selected with TRANSPORT_CRC8_ENGINE.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+// ---------- CRC-8 engine selection ----------
+#define TRANSPORT_CRC8_BITWISE   0   // reference loop, no table
+#define TRANSPORT_CRC8_TABLE     1   // 256-entry table, 1 byte/step
+#define TRANSPORT_CRC8_SLICE4    2   // 4x256 tables, 4 bytes/step
+#ifndef TRANSPORT_CRC8_ENGINE
+#define TRANSPORT_CRC8_ENGINE    TRANSPORT_CRC8_TABLE
+#endif
+
+namespace transport {
+namespace crc {
+
+// ------- Reference (bitwise) -------
+constexpr uint8_t crc8Bitwise(const uint8_t* data, size_t len, uint8_t crc = 0x00) {
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; ++b) {
+      crc = (crc & 0x80) ? uint8_t((crc << 1) ^ 0x07) : uint8_t(crc << 1);
+    }
+  }
+  return crc;
+}
+
+constexpr uint16_t crc16Bitwise(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= uint16_t(data[i]) << 8;
+    for (int b = 0; b < 8; ++b) {
+      crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// ------- Compile-time tables -------
+struct Crc8Tables {
+  uint8_t t[4][256] = {};   // t[k][x] = crc8 of byte x followed by k zero bytes
+};
+
+struct Crc16Table {
+  uint16_t t[256] = {};
+};
+
+constexpr Crc8Tables makeCrc8Tables() {
+  Crc8Tables out{};
+  for (int x = 0; x < 256; ++x) {
+    const uint8_t b = uint8_t(x);
+    out.t[0][x] = crc8Bitwise(&b, 1);
+  }
+  for (int k = 1; k < 4; ++k) {
+    for (int x = 0; x < 256; ++x) {
+      out.t[k][x] = out.t[0][out.t[k - 1][x]];
+    }
+  }
+  return out;
+}
+
+constexpr Crc16Table makeCrc16Table() {
+  Crc16Table out{};
+  for (int x = 0; x < 256; ++x) {
+    uint16_t crc = uint16_t(x << 8);
+    for (int b = 0; b < 8; ++b) {
+      crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+    }
+    out.t[x] = crc;
+  }
+  return out;
+}
+
+inline constexpr Crc8Tables kCrc8Tables = makeCrc8Tables();
+inline constexpr Crc16Table kCrc16Table = makeCrc16Table();
+
+// ------- Table engines -------
+constexpr uint8_t crc8Table(const uint8_t* data, size_t len, uint8_t crc = 0x00) {
+  for (size_t i = 0; i < len; ++i) crc = kCrc8Tables.t[0][crc ^ data[i]];
+  return crc;
+}
+
+constexpr uint8_t crc8Slice4(const uint8_t* data, size_t len, uint8_t crc = 0x00) {
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    crc = kCrc8Tables.t[3][crc ^ data[i]] ^
+          kCrc8Tables.t[2][data[i + 1]] ^
+          kCrc8Tables.t[1][data[i + 2]] ^
+          kCrc8Tables.t[0][data[i + 3]];
+  }
+  for (; i < len; ++i) crc = kCrc8Tables.t[0][crc ^ data[i]];
+  return crc;
+}
+
+constexpr uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  for (size_t i = 0; i < len; ++i) {
+    crc = uint16_t(crc << 8) ^ kCrc16Table.t[uint8_t(crc >> 8) ^ data[i]];
+  }
+  return crc;
+}
+
+// ------- Selected CRC-8 engine -------
+constexpr uint8_t crc8(const uint8_t* data, size_t len) {
+#if TRANSPORT_CRC8_ENGINE == TRANSPORT_CRC8_SLICE4
+  return crc8Slice4(data, len);
+#elif TRANSPORT_CRC8_ENGINE == TRANSPORT_CRC8_TABLE
+  return crc8Table(data, len);
+#else
+  return crc8Bitwise(data, len);
+#endif
+}
+
+// ------- Conformance (evaluated at compile time) -------
+namespace detail {
+constexpr uint8_t kCheck[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+constexpr bool crc8EnginesAgree() {
+  // Every single byte, plus every prefix of a 64-byte pattern so the
+  // slice-by-4 tail handling is covered for all remainders.
+  for (int x = 0; x < 256; ++x) {
+    const uint8_t b = uint8_t(x);
+    if (crc8Table(&b, 1) != crc8Bitwise(&b, 1)) return false;
+    if (crc8Slice4(&b, 1) != crc8Bitwise(&b, 1)) return false;
+  }
+  uint8_t buf[64] = {};
+  for (int i = 0; i < 64; ++i) buf[i] = uint8_t(i * 37 + 11);
+  for (size_t n = 0; n <= sizeof(buf); ++n) {
+    if (crc8Table(buf, n) != crc8Bitwise(buf, n)) return false;
+    if (crc8Slice4(buf, n) != crc8Bitwise(buf, n)) return false;
+  }
+  return true;
+}
+
+constexpr bool crc16EnginesAgree() {
+  uint8_t buf[64] = {};
+  for (int i = 0; i < 64; ++i) buf[i] = uint8_t(i * 53 + 7);
+  for (size_t n = 0; n <= sizeof(buf); ++n) {
+    if (crc16(buf, n) != crc16Bitwise(buf, n)) return false;
+  }
+  return true;
+}
+} // namespace detail
+
+static_assert(crc8Bitwise(detail::kCheck, 9) == 0xF4, "CRC-8 check value");
+static_assert(crc8(detail::kCheck, 9) == 0xF4, "CRC-8 engine check value");
+static_assert(crc16Bitwise(detail::kCheck, 9) == 0x29B1, "CRC-16/CCITT-FALSE check value");
+static_assert(crc16(detail::kCheck, 9) == 0x29B1, "CRC-16 table check value");
+static_assert(detail::crc8EnginesAgree(), "CRC-8 table/slice4 engines diverge from bitwise");
+static_assert(detail::crc16EnginesAgree(), "CRC-16 table engine diverges from bitwise");
+
+} // namespace crc
+} // namespace transport
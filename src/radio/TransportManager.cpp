@@ -1,38 +1,319 @@
 #include <TransportManager.hpp>
 #include <ConfigNvs.hpp>
-#include <stdio.h>
+#include <Utils.hpp>
+#include <string.h>
 
 TransportManager::TransportManager(uint8_t selfId, EspNowManager* now, NVS* nvs)
     : adapter_(selfId,
                now,
                [this](uint8_t destId, uint8_t outMac[6]) { return resolvePeer_(destId, outMac); },
                transport::TransportPort::Config()),
-      nvs_(nvs) {}
+      now_(now),
+      nvs_(nvs) {
+  adapter_.port().setWakeHook([this]() { wake_(); });
+  adapter_.port().setDispatchGuard([this]() { return enterHandler_(); },
+                                   [this]() { leaveHandler_(); });
+  // Master-bound events raised while the link is down go to the journal.
+  adapter_.port().setTxTap([now](const transport::TransportMessage& m) {
+    if (now) now->journalOffline(m);
+  });
+}
 
 void TransportManager::onRadioReceive(const uint8_t* data, size_t len) {
   adapter_.onRadioReceive(data, len);
 }
 
+bool TransportManager::begin() {
+  if (taskH_) return true;
+  if (!joinSem_) joinSem_ = xSemaphoreCreateBinary();
+  if (!joinSem_) return false;
+  stopReq_ = false;
+  const BaseType_t ok = xTaskCreatePinnedToCore(
+      taskEntry_,
+      "trsp_task",
+      TRANSPORT_TASK_STACK,
+      this,
+      TRANSPORT_TASK_PRIO,
+      &taskH_,
+      TRANSPORT_TASK_CORE);
+  if (ok != pdPASS) {
+    taskH_ = nullptr;
+    DBG_PRINTLN("[TRSPRT] task create failed; falling back to tick() polling");
+    return false;
+  }
+  DBG_PRINTF("[TRSPRT] task started: handle=%p core=%d stack=%u prio=%u\n",
+             (void*)taskH_, (int)TRANSPORT_TASK_CORE,
+             (unsigned)TRANSPORT_TASK_STACK, (unsigned)TRANSPORT_TASK_PRIO);
+  return true;
+}
+
+bool TransportManager::stop() {
+  TaskHandle_t h = taskH_;
+  if (!h) return true;
+  stopReq_ = true;
+  xTaskNotifyGive(h);
+  if (xSemaphoreTake(joinSem_, pdMS_TO_TICKS(TRANSPORT_TASK_STOP_MS)) != pdTRUE) {
+    DBG_PRINTLN("[TRSPRT] task did not stop in time; left running");
+    return false;
+  }
+  DBG_PRINTLN("[TRSPRT] task stopped");
+  return true;
+}
+
 void TransportManager::tick() {
+  if (taskH_) return;   // the transport task owns tick()
   adapter_.port().tick();
 }
 
-bool TransportManager::resolvePeer_(uint8_t destId, uint8_t outMac[6]) {
-  // For now, only master is supported as destId=1 (example).
-  if (destId != 1) return false;
-  if (!nvs_) return false;
-  String macStr = nvs_->GetString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
-  if (macStr.isEmpty() || macStr == MASTER_ESPNOW_ID_DEFAULT) return false;
-  return parseMac_(macStr, outMac);
-}
-
-bool TransportManager::parseMac_(const String& macStr, uint8_t outMac[6]) {
-  if (macStr.length() != 17) return false;
-  int values[6];
-  if (sscanf(macStr.c_str(), "%x:%x:%x:%x:%x:%x",
-             &values[0], &values[1], &values[2], &values[3], &values[4], &values[5]) != 6) {
-    return false;
+void TransportManager::wake_() {
+  TaskHandle_t h = taskH_;
+  if (h) xTaskNotifyGive(h);
+}
+
+void TransportManager::taskEntry_(void* arg) {
+  static_cast<TransportManager*>(arg)->taskLoop_();
+}
+
+void TransportManager::taskLoop_() {
+  transport::TransportPort& p = adapter_.port();
+  while (!stopReq_) {
+    p.tick();
+    if (stopReq_) break;
+    const uint32_t waitMs = p.nextWakeMs(TRANSPORT_TASK_IDLE_MS);
+    if (waitMs) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs) ? pdMS_TO_TICKS(waitMs) : 1);
+    }
+  }
+  // Exit between ticks: no handler, NVS or port lock is held here.
+  taskH_ = nullptr;
+  xSemaphoreGive(joinSem_);
+  vTaskDelete(nullptr);
+}
+
+// The owner may hold the lock while it calls stop(); wait in slices so a
+// stop request is never blocked behind it.
+bool TransportManager::enterHandler_() {
+  if (!handlerLock_) return true;
+  while (xSemaphoreTakeRecursive(handlerLock_, pdMS_TO_TICKS(TRANSPORT_LOCK_POLL_MS)) != pdTRUE) {
+    if (stopReq_) return false;
   }
-  for (int i = 0; i < 6; ++i) outMac[i] = static_cast<uint8_t>(values[i]);
   return true;
 }
+
+void TransportManager::leaveHandler_() {
+  if (handlerLock_) xSemaphoreGiveRecursive(handlerLock_);
+}
+
+bool TransportManager::resolvePeer_(uint8_t destId, uint8_t outMac[6]) {
+  if (destId == TRANSPORT_MASTER_ID) return resolveMaster(outMac);
+  bool found = false;
+  taskENTER_CRITICAL(&peerMux_);
+  for (const PeerInfo& p : peers_) {
+    if (p.used && p.logicalId == destId) {
+      memcpy(outMac, p.mac, 6);
+      found = true;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+  return found;
+}
+
+// =============================================================
+//  Peer table
+// =============================================================
+bool TransportManager::healthy_(const PeerInfo& p, uint32_t now) const {
+  return p.failStreak < TRANSPORT_PEER_FAIL_MAX ||
+         (now - p.lastFailMs) >= TRANSPORT_PEER_RETRY_MS;
+}
+
+TransportManager::PeerInfo* TransportManager::findPeer_(const uint8_t mac[6]) {
+  if (!mac) return nullptr;
+  for (PeerInfo& p : peers_) {
+    if (p.used && memcmp(p.mac, mac, 6) == 0) return &p;
+  }
+  return nullptr;
+}
+
+// (Re)build the table from the EspNowManager identity cache when it was
+// invalidated. Health counters survive a rebuild for peers that stay.
+// Worker only: the identity load may read NVS and the standby is
+// (un)registered with ESP-NOW, neither of which belongs in a callback.
+void TransportManager::refreshPeers() {
+  taskENTER_CRITICAL(&peerMux_);
+  const uint32_t gen = peersGen_;
+  const bool fresh = (peersLoaded_ == gen);
+  taskEXIT_CRITICAL(&peerMux_);
+  if (fresh || !now_) return;
+
+  EspNowManager::PeerIdentity primary, standby;
+  (void)now_->masterIdentity(primary);
+  (void)now_->standbyIdentity(standby);
+  if (primary.valid && standby.valid && memcmp(primary.mac, standby.mac, 6) == 0) {
+    standby.valid = false;   // same radio: nothing to fail over to
+  }
+
+  // Keep the ESP-NOW peer list in step with the standby entry. Re-adding
+  // picks up a changed LMK; the primary is registered by EspNowManager.
+  static const uint8_t kNoMac[6] = {0};
+  if (memcmp(standbyMac_, kNoMac, 6) != 0 &&
+      !(primary.valid && memcmp(standbyMac_, primary.mac, 6) == 0)) {
+    (void)now_->unregisterPeer(standbyMac_);
+  }
+  if (standby.valid &&
+      now_->registerPeer(standby.mac, standby.hasLmk, standby.hasLmk ? standby.lmk : nullptr) != ESP_OK) {
+    DBG_PRINTLN("[TRSPRT][peer] standby registration failed");
+  }
+  memcpy(standbyMac_, standby.valid ? standby.mac : kNoMac, 6);
+
+  PeerInfo next[TRANSPORT_PEER_SLOTS];
+  size_t n = 0;
+  auto fill = [&](const EspNowManager::PeerIdentity& id, uint8_t logicalId, PeerRole role) {
+    PeerInfo& p = next[n++];
+    p.used      = true;
+    p.logicalId = logicalId;
+    p.role      = role;
+    memcpy(p.mac, id.mac, 6);
+    p.channel   = id.channel;
+    p.hasLmk    = id.hasLmk;
+    memcpy(p.lmk, id.lmk, sizeof(p.lmk));
+  };
+  if (primary.valid) fill(primary, TRANSPORT_MASTER_ID, PeerRole::Primary);
+  if (standby.valid) fill(standby, TRANSPORT_STANDBY_ID, PeerRole::Standby);
+
+  taskENTER_CRITICAL(&peerMux_);
+  if (peersGen_ == gen) {
+    for (size_t i = 0; i < n; ++i) {
+      const PeerInfo* old = findPeer_(next[i].mac);
+      if (!old) continue;
+      next[i].lastOkMs   = old->lastOkMs;
+      next[i].lastFailMs = old->lastFailMs;
+      next[i].txStartMs  = old->txStartMs;
+      next[i].timing     = old->timing;
+      next[i].rttMs      = old->rttMs;
+      next[i].failStreak = old->failStreak;
+      next[i].sent       = old->sent;
+      next[i].delivered  = old->delivered;
+      next[i].failed     = old->failed;
+    }
+    for (size_t i = 0; i < TRANSPORT_PEER_SLOTS; ++i) peers_[i] = next[i];
+    active_      = -1;
+    peersLoaded_ = gen;
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+  DBG_PRINTF("[TRSPRT][peer] table: primary=%d standby=%d\n",
+             (int)primary.valid, (int)standby.valid);
+}
+
+void TransportManager::invalidatePeers() {
+  taskENTER_CRITICAL(&peerMux_);
+  peersGen_++;
+  taskEXIT_CRITICAL(&peerMux_);
+}
+
+bool TransportManager::resolveMaster(uint8_t outMac[6]) {
+  const uint32_t now = millis();
+  int  pick = -1;
+  int  prev = -1;
+  bool toPrimary = false;
+  taskENTER_CRITICAL(&peerMux_);
+  int primary = -1;
+  int standby = -1;
+  int best    = -1;
+  for (int i = 0; i < TRANSPORT_PEER_SLOTS; ++i) {
+    const PeerInfo& p = peers_[i];
+    if (!p.used) continue;
+    if (p.role == PeerRole::Primary) { primary = i; continue; }
+    if (standby < 0) standby = i;
+    if (!healthy_(p, now)) continue;
+    // Unknown RTT (0) ranks after any measured one.
+    const uint16_t r  = p.rttMs ? p.rttMs : UINT16_MAX;
+    const uint16_t rb = (best >= 0 && peers_[best].rttMs) ? peers_[best].rttMs : UINT16_MAX;
+    if (best < 0 || r < rb) best = i;
+  }
+  if (primary >= 0 && healthy_(peers_[primary], now)) pick = primary;
+  else if (best >= 0)                                 pick = best;
+  else                                                pick = (primary >= 0) ? primary : standby;
+  prev = active_;
+  if (pick >= 0) {
+    memcpy(outMac, peers_[pick].mac, 6);
+    toPrimary = (peers_[pick].role == PeerRole::Primary);
+    active_ = static_cast<int8_t>(pick);
+    if (prev >= 0 && prev != pick) failovers_++;
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+
+  if (pick >= 0 && prev >= 0 && prev != pick) {
+    DBG_PRINTF("[TRSPRT][peer] master route -> %s %02X:%02X:%02X:%02X:%02X:%02X\n",
+               toPrimary ? "primary" : "standby",
+               outMac[0], outMac[1], outMac[2], outMac[3], outMac[4], outMac[5]);
+  }
+  return pick >= 0;
+}
+
+bool TransportManager::isMasterPeer(const uint8_t mac[6]) {
+  taskENTER_CRITICAL(&peerMux_);
+  const bool known = (findPeer_(mac) != nullptr);
+  taskEXIT_CRITICAL(&peerMux_);
+  return known;
+}
+
+void TransportManager::notePeerSent(const uint8_t mac[6]) {
+  const uint32_t now = millis();
+  taskENTER_CRITICAL(&peerMux_);
+  if (PeerInfo* p = findPeer_(mac)) {
+    p->sent++;
+    if (!p->timing) {   // one sample at a time: oldest outstanding frame
+      p->timing    = true;
+      p->txStartMs = now;
+    }
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+}
+
+void TransportManager::notePeerStatus(const uint8_t mac[6], bool ok) {
+  const uint32_t now = millis();
+  taskENTER_CRITICAL(&peerMux_);
+  if (PeerInfo* p = findPeer_(mac)) {
+    if (ok) {
+      p->delivered++;
+      p->failStreak = 0;
+      p->lastOkMs   = now;
+      if (p->timing) {
+        const uint32_t sample = now - p->txStartMs;
+        const int32_t  rtt    = p->rttMs;
+        const int32_t  next   = rtt ? rtt + (static_cast<int32_t>(sample) - rtt) / 8
+                                    : static_cast<int32_t>(sample);
+        p->rttMs = static_cast<uint16_t>(next < 1 ? 1 : (next > 0xFFFF ? 0xFFFF : next));
+      }
+    } else {
+      p->failed++;
+      if (p->failStreak < 0xFF) p->failStreak++;
+      p->lastFailMs = now;
+    }
+    p->timing = false;
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+}
+
+void TransportManager::notePeerRx(const uint8_t mac[6]) {
+  const uint32_t now = millis();
+  taskENTER_CRITICAL(&peerMux_);
+  if (PeerInfo* p = findPeer_(mac)) {
+    p->lastOkMs   = now;
+    p->failStreak = 0;
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+}
+
+size_t TransportManager::peers(PeerInfo* out, size_t max) {
+  if (!out) return 0;
+  size_t n = 0;
+  taskENTER_CRITICAL(&peerMux_);
+  for (const PeerInfo& p : peers_) {
+    if (n >= max) break;
+    if (p.used) out[n++] = p;
+  }
+  taskEXIT_CRITICAL(&peerMux_);
+  return n;
+}
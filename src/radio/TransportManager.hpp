@@ -12,17 +12,61 @@
  * @brief Wrapper that owns EspNowAdapter + TransportPort and exposes a simple API.
  *
  * Integrates:
- *  - Resolves logical destId -> MAC (master MAC from NVS).
+ *  - Resolves logical destId -> MAC through a small peer table: the paired
+ *    (primary) master plus an optional standby master, each with liveness,
+ *    consecutive-failure count and an RTT estimate. destId=1 resolves to the
+ *    healthiest master, so traffic fails over to the standby while the
+ *    primary stops acknowledging and returns once it answers again.
  *  - Provides entrypoints to feed RX and tick retries.
  *  - Lets callers register module handlers and send messages.
+ *  - Owns the transport task: it sleeps on a task notification given by
+ *    onRadioReceive()/TransportPort::send(), or until the port's next
+ *    deadline (retry, batch window, pacing token), then runs tick().
+ *    Module handlers run on that task, each one under the owner's handler
+ *    lock (setHandlerLock()). stop() asks the task to exit and waits for it.
  *
  * NOTE: This does NOT modify EspNowManager; caller must:
  *   - Call onRadioReceive() from EspNowManager::onDataReceived.
- *   - Call tick() regularly (e.g., in Device::loop()).
+ *   - Call begin() once handlers are registered. Without the task (begin()
+ *     not called or task creation failed), call tick() regularly instead.
  */
 
 #include <EspNowAdapter.hpp>
 #include <NVSManager.hpp>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// ---------- Transport Task ----------
+#ifndef TRANSPORT_TASK_STACK
+#define TRANSPORT_TASK_STACK         4096
+#endif
+#ifndef TRANSPORT_TASK_PRIO
+#define TRANSPORT_TASK_PRIO          4         // above the ESP-NOW worker (3)
+#endif
+#ifndef TRANSPORT_TASK_CORE
+#define TRANSPORT_TASK_CORE          APP_CPU_NUM
+#endif
+#ifndef TRANSPORT_TASK_IDLE_MS
+#define TRANSPORT_TASK_IDLE_MS       1000UL    // max sleep with nothing pending
+#endif
+#ifndef TRANSPORT_TASK_STOP_MS
+#define TRANSPORT_TASK_STOP_MS       500UL     // stop(): wait for the task to exit
+#endif
+#ifndef TRANSPORT_LOCK_POLL_MS
+#define TRANSPORT_LOCK_POLL_MS       50UL      // handler lock wait slice (checks stop)
+#endif
+
+// ---------- Peer Table ----------
+#ifndef TRANSPORT_PEER_SLOTS
+#define TRANSPORT_PEER_SLOTS         4
+#endif
+#ifndef TRANSPORT_PEER_FAIL_MAX
+#define TRANSPORT_PEER_FAIL_MAX      3         // consecutive failed sends -> unhealthy
+#endif
+#ifndef TRANSPORT_PEER_RETRY_MS
+#define TRANSPORT_PEER_RETRY_MS      30000UL   // probe an unhealthy peer again after this
+#endif
 
 class TransportManager {
 public:
@@ -31,18 +75,87 @@ public:
   // Feed raw ESP-NOW frames into transport (call from EspNowManager::onDataReceived).
   void onRadioReceive(const uint8_t* data, size_t len);
 
-  // Pump retries/timeouts (call in loop()).
+  // Recursive mutex taken around every module handler callback; pass the
+  // lock the owner holds while it touches the same state. Set before begin().
+  void setHandlerLock(SemaphoreHandle_t m) { handlerLock_ = m; }
+
+  // Start/stop the transport task. stop() returns once the task has left
+  // tick() (never mid-callback or holding the NVS lock); false on timeout.
+  bool begin();
+  bool stop();
+  bool isRunning() const { return taskH_ != nullptr; }
+
+  // Pump retries/timeouts manually; no-op while the transport task runs.
   void tick();
 
   // Expose the transport port to register handlers and send messages.
   transport::TransportPort& port() { return adapter_.port(); }
 
+  // ---------- Peer Table ----------
+  enum class PeerRole : uint8_t { Primary = 0, Standby = 1 };
+  struct PeerInfo {
+    bool     used       = false;
+    uint8_t  logicalId  = 0;
+    PeerRole role       = PeerRole::Primary;
+    uint8_t  mac[6]     = {0};
+    uint8_t  channel    = 0;
+    bool     hasLmk     = false;
+    uint8_t  lmk[16]    = {0};
+    uint32_t lastOkMs   = 0;     // last delivery report OK or frame received
+    uint32_t lastFailMs = 0;
+    uint32_t txStartMs  = 0;     // send time of the RTT sample in progress
+    bool     timing     = false;
+    uint16_t rttMs      = 0;     // EWMA (1/8) of send -> delivery report
+    uint8_t  failStreak = 0;     // consecutive failed delivery reports
+    uint32_t sent       = 0;
+    uint32_t delivered  = 0;
+    uint32_t failed     = 0;
+  };
+
+  // Lookups below read the last built table and never rebuild it, so they
+  // are safe from radio callbacks and any task.
+  // Healthiest master (primary unless it is failing and a standby is not).
+  bool resolveMaster(uint8_t outMac[6]);
+  // True for the primary or a standby master (accept commands from either).
+  bool isMasterPeer(const uint8_t mac[6]);
+  // Liveness hooks, called from EspNowManager (radio callbacks included).
+  void notePeerSent(const uint8_t mac[6]);
+  void notePeerStatus(const uint8_t mac[6], bool ok);
+  void notePeerRx(const uint8_t mac[6]);
+  // Mark the table stale; the ESP-NOW worker rebuilds it on its next pass.
+  void invalidatePeers();
+  // Rebuild after invalidatePeers(). ESP-NOW worker task only.
+  void refreshPeers();
+  // Snapshot of the table; returns the number of entries written.
+  size_t peers(PeerInfo* out, size_t max);
+  uint32_t failovers() const { return failovers_; }
+
 private:
+  static void taskEntry_(void* arg);
+  void taskLoop_();
+  void wake_();
+  bool enterHandler_();
+  void leaveHandler_();
   bool resolvePeer_(uint8_t destId, uint8_t outMac[6]);
-  bool parseMac_(const String& macStr, uint8_t outMac[6]);
+  PeerInfo* findPeer_(const uint8_t mac[6]);
+  bool healthy_(const PeerInfo& p, uint32_t now) const;
 
   EspNowAdapter adapter_;
+  EspNowManager* now_;
   NVS* nvs_;
+  TaskHandle_t      taskH_       = nullptr;
+  SemaphoreHandle_t handlerLock_ = nullptr;
+  SemaphoreHandle_t joinSem_     = nullptr;   // given by the task on exit
+  volatile bool     stopReq_     = false;
+
+  // Peer table (guarded by peerMux_; rebuilt by refreshPeers() on generation change).
+  PeerInfo     peers_[TRANSPORT_PEER_SLOTS];
+  uint32_t     peersGen_    = 1;   // bumped by invalidatePeers()
+  uint32_t     peersLoaded_ = 0;   // generation the table was built from
+  int8_t       active_      = -1;  // index resolveMaster() returned last
+  uint32_t     failovers_   = 0;
+  uint8_t      standbyMac_[6] = {0};   // registered with ESP-NOW (zeros = none)
+  portMUX_TYPE peerMux_ = portMUX_INITIALIZER_UNLOCKED;
 };
 
 
@@ -1,5 +1,6 @@
 #include <DeviceHandler.hpp>
 #include <Device.hpp>
+#include <BootTrace.hpp>
 #include <ConfigNvs.hpp>
 #include <NVSManager.hpp>
 #include <ESPNOWManager.hpp>
@@ -25,8 +26,13 @@ static constexpr uint8_t OPC_HEARTBEAT      = 0x0D;
 static constexpr uint8_t OPC_CANCEL_TIMERS  = 0x15;
 static constexpr uint8_t OPC_SET_ROLE       = 0x16;
 static constexpr uint8_t OPC_PING           = 0x17;
+static constexpr uint8_t OPC_PEER_SET       = 0x18;
+static constexpr uint8_t OPC_LINK_STATS     = 0x19;
+static constexpr uint8_t OPC_CHANNEL_RESCAN = 0x1A;
+static constexpr uint8_t OPC_BOOT_TIMES     = 0x1C;
+static constexpr uint8_t OPC_CMD_STATS      = 0x1D;
 
-void DeviceHandler::onMessage(const transport::TransportMessage& msg) {
+void DeviceHandler::onMessageView(const transport::TransportMessageView& msg) {
   const uint8_t op = msg.header.opCode;
   switch (op) {
     case OPC_CONFIG_MODE:   handleConfigMode_(msg);   break;
@@ -44,13 +50,18 @@ void DeviceHandler::onMessage(const transport::TransportMessage& msg) {
     case OPC_PING:          handleHeartbeat_(msg);    break;
     case OPC_CANCEL_TIMERS: handleCancelTimers_(msg); break;
     case OPC_SET_ROLE:      handleSetRole_(msg);      break;
+    case OPC_PEER_SET:      handlePeerSet_(msg);      break;
+    case OPC_LINK_STATS:    handleLinkStats_(msg);    break;
+    case OPC_CHANNEL_RESCAN: handleChannelRescan_(msg); break;
+    case OPC_BOOT_TIMES:    handleBootTimes_(msg);    break;
+    case OPC_CMD_STATS:     handleCmdStats_(msg);     break;
     default:
       sendStatusOnly_(msg, transport::StatusCode::UNSUPPORTED);
       break;
   }
 }
 
-void DeviceHandler::handleConfigMode_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleConfigMode_(const transport::TransportMessageView& msg) {
   // Trigger config mode on Device via ESPNOW command path
   if (!dev_ || !dev_->Now) {
     sendStatusOnly_(msg, transport::StatusCode::DENIED);
@@ -60,12 +71,12 @@ void DeviceHandler::handleConfigMode_(const transport::TransportMessage& msg) {
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
 
-void DeviceHandler::handleStateQuery_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleStateQuery_(const transport::TransportMessageView& msg) {
   if (!dev_) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
 
   // Build state struct payload
   std::vector<uint8_t> pl;
-  pl.reserve(17);
+  pl.reserve(transport::kStateRecordSize);
   const bool armed     = dev_->isArmed_();
   const bool motion    = dev_->isMotionEnabled_();
   const bool locked    = dev_->isAlarmRole_ ? false : dev_->isLocked_();
@@ -113,7 +124,7 @@ void DeviceHandler::handleStateQuery_(const transport::TransportMessage& msg) {
   if (port_) port_->send(resp, true);
 }
 
-void DeviceHandler::handleConfigStatus_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleConfigStatus_(const transport::TransportMessageView& msg) {
   const bool configured = dev_ ? dev_->isConfigured_() : false;
   transport::TransportMessage resp;
   resp.header = msg.header;
@@ -129,7 +140,7 @@ void DeviceHandler::handleConfigStatus_(const transport::TransportMessage& msg)
   if (port_) port_->send(resp, true);
 }
 
-void DeviceHandler::handleArm_(const transport::TransportMessage& msg, bool arm) {
+void DeviceHandler::handleArm_(const transport::TransportMessageView& msg, bool arm) {
   if (!dev_ || !CONF) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
   CONF->PutBool(ARMED_STATE, arm);
   sendStatusOnly_(msg, transport::StatusCode::OK);
@@ -139,7 +150,7 @@ void DeviceHandler::handleArm_(const transport::TransportMessage& msg, bool arm)
   }
 }
 
-void DeviceHandler::handleReboot_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleReboot_(const transport::TransportMessageView& msg) {
   if (!dev_) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
   // Optional payload[0]: 0 = plain reboot, 1 = factory reset.
   bool factoryReset = false;
@@ -154,16 +165,16 @@ void DeviceHandler::handleReboot_(const transport::TransportMessage& msg) {
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
 
-void DeviceHandler::handleCapsSet_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleCapsSet_(const transport::TransportMessageView& msg) {
   if (!dev_ || !CONF || msg.payload.size() < 1) {
     sendStatusOnly_(msg, transport::StatusCode::INVALID_PARAM);
     return;
   }
   uint8_t prevBits = 0;
-  prevBits |= CONF->GetBool(HAS_OPEN_SWITCH_KEY,   HAS_OPEN_SWITCH_DEFAULT)   ? 0x01 : 0;
-  prevBits |= CONF->GetBool(HAS_SHOCK_SENSOR_KEY,  HAS_SHOCK_SENSOR_DEFAULT)  ? 0x02 : 0;
-  prevBits |= CONF->GetBool(HAS_REED_SWITCH_KEY,   HAS_REED_SWITCH_DEFAULT)   ? 0x04 : 0;
-  prevBits |= CONF->GetBool(HAS_FINGERPRINT_KEY,   HAS_FINGERPRINT_DEFAULT)   ? 0x08 : 0;
+  prevBits |= CONF->get<Cfg::HasOpenSwitch>() ? 0x01 : 0;
+  prevBits |= CONF->get<Cfg::HasShockSensor>() ? 0x02 : 0;
+  prevBits |= CONF->get<Cfg::HasReedSwitch>() ? 0x04 : 0;
+  prevBits |= CONF->get<Cfg::HasFingerprint>() ? 0x08 : 0;
 
   uint8_t bits = msg.payload[0];
   if (dev_ && dev_->isAlarmRole_) {
@@ -183,10 +194,10 @@ void DeviceHandler::handleCapsSet_(const transport::TransportMessage& msg) {
   CONF->PutBool(HAS_FINGERPRINT_KEY,   bits & 0x08);
   dev_->refreshCapabilities_();
   uint8_t nowBits = 0;
-  nowBits |= CONF->GetBool(HAS_OPEN_SWITCH_KEY,   HAS_OPEN_SWITCH_DEFAULT)   ? 0x01 : 0;
-  nowBits |= CONF->GetBool(HAS_SHOCK_SENSOR_KEY,  HAS_SHOCK_SENSOR_DEFAULT)  ? 0x02 : 0;
-  nowBits |= CONF->GetBool(HAS_REED_SWITCH_KEY,   HAS_REED_SWITCH_DEFAULT)   ? 0x04 : 0;
-  nowBits |= CONF->GetBool(HAS_FINGERPRINT_KEY,   HAS_FINGERPRINT_DEFAULT)   ? 0x08 : 0;
+  nowBits |= CONF->get<Cfg::HasOpenSwitch>() ? 0x01 : 0;
+  nowBits |= CONF->get<Cfg::HasShockSensor>() ? 0x02 : 0;
+  nowBits |= CONF->get<Cfg::HasReedSwitch>() ? 0x04 : 0;
+  nowBits |= CONF->get<Cfg::HasFingerprint>() ? 0x08 : 0;
   DBG_PRINTF("[Caps] NVS updated: bits=0x%02X (O%d S%d R%d F%d)\n",
                (unsigned)nowBits,
                (nowBits & 0x01) ? 1 : 0,
@@ -196,13 +207,13 @@ void DeviceHandler::handleCapsSet_(const transport::TransportMessage& msg) {
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
 
-void DeviceHandler::handleCapsQuery_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleCapsQuery_(const transport::TransportMessageView& msg) {
   if (!dev_ || !CONF) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
   uint8_t bits = 0;
-  bits |= CONF->GetBool(HAS_OPEN_SWITCH_KEY,   HAS_OPEN_SWITCH_DEFAULT)   ? 0x01 : 0;
-  bits |= CONF->GetBool(HAS_SHOCK_SENSOR_KEY,  HAS_SHOCK_SENSOR_DEFAULT)  ? 0x02 : 0;
-  bits |= CONF->GetBool(HAS_REED_SWITCH_KEY,   HAS_REED_SWITCH_DEFAULT)   ? 0x04 : 0;
-  bits |= CONF->GetBool(HAS_FINGERPRINT_KEY,   HAS_FINGERPRINT_DEFAULT)   ? 0x08 : 0;
+  bits |= CONF->get<Cfg::HasOpenSwitch>() ? 0x01 : 0;
+  bits |= CONF->get<Cfg::HasShockSensor>() ? 0x02 : 0;
+  bits |= CONF->get<Cfg::HasReedSwitch>() ? 0x04 : 0;
+  bits |= CONF->get<Cfg::HasFingerprint>() ? 0x08 : 0;
   if (dev_ && dev_->isAlarmRole_) {
     bits = 0x06;
   }
@@ -221,7 +232,7 @@ void DeviceHandler::handleCapsQuery_(const transport::TransportMessage& msg) {
   if (port_) port_->send(resp, true);
 }
 
-void DeviceHandler::handleNvsWrite_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleNvsWrite_(const transport::TransportMessageView& msg) {
   // keyId:uint8 + value bytes (bool expected)
   if (!CONF || msg.payload.size() < 2) {
     sendStatusOnly_(msg, transport::StatusCode::INVALID_PARAM);
@@ -256,7 +267,7 @@ void DeviceHandler::handleNvsWrite_(const transport::TransportMessage& msg) {
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
 
-void DeviceHandler::sendStatusOnly_(const transport::TransportMessage& req,
+void DeviceHandler::sendStatusOnly_(const transport::TransportMessageView& req,
                                     transport::StatusCode status) {
   transport::TransportMessage resp;
   resp.header = req.header;
@@ -269,7 +280,7 @@ void DeviceHandler::sendStatusOnly_(const transport::TransportMessage& req,
   if (port_) port_->send(resp, true);
 }
 
-void DeviceHandler::handlePairInit_(const transport::TransportMessage& msg) {
+void DeviceHandler::handlePairInit_(const transport::TransportMessageView& msg) {
   // Payload: master MAC (6 bytes) + optional token (ignored here)
   if (!CONF || msg.payload.size() < 6) {
     sendStatusOnly_(msg, transport::StatusCode::INVALID_PARAM);
@@ -280,32 +291,31 @@ void DeviceHandler::handlePairInit_(const transport::TransportMessage& msg) {
            msg.payload[0], msg.payload[1], msg.payload[2],
            msg.payload[3], msg.payload[4], msg.payload[5]);
   CONF->PutString(MASTER_ESPNOW_ID, macStr);
+  if (dev_ && dev_->Now) dev_->Now->invalidatePeerCache();
   CONF->PutBool(DEVICE_CONFIGURED, true);
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
 
-void DeviceHandler::handlePairStatus_(const transport::TransportMessage& msg) {
+void DeviceHandler::handlePairStatus_(const transport::TransportMessageView& msg) {
   transport::TransportMessage resp;
   resp.header = msg.header;
   resp.header.srcId  = msg.header.destId;
   resp.header.destId = msg.header.srcId;
   resp.header.type   = static_cast<uint8_t>(transport::MessageType::Response);
   resp.header.flags  = 0x02;
-  bool configured = CONF ? CONF->GetBool(DEVICE_CONFIGURED, false) : false;
+  bool configured = CONF ? CONF->get<Cfg::DeviceConfigured>() : false;
   resp.payload.push_back(static_cast<uint8_t>(transport::StatusCode::OK));
   resp.payload.push_back(static_cast<uint8_t>(configured));
   if (CONF) {
-    String mac = CONF->GetString(MASTER_ESPNOW_ID, MASTER_ESPNOW_ID_DEFAULT);
     uint8_t buf[6] = {0};
-    sscanf(mac.c_str(), "%hhX:%hhX:%hhX:%hhX:%hhX:%hhX",
-           &buf[0], &buf[1], &buf[2], &buf[3], &buf[4], &buf[5]);
+    if (dev_ && dev_->Now) (void)dev_->Now->masterMac(buf);   // zeros when unpaired
     resp.payload.insert(resp.payload.end(), buf, buf + 6);
   }
   resp.header.payloadLen = static_cast<uint8_t>(resp.payload.size());
   if (port_) port_->send(resp, true);
 }
 
-void DeviceHandler::handleHeartbeat_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleHeartbeat_(const transport::TransportMessageView& msg) {
   static uint16_t seq = 0;
   transport::TransportMessage resp;
   resp.header = msg.header;
@@ -325,11 +335,112 @@ void DeviceHandler::handleHeartbeat_(const transport::TransportMessage& msg) {
   if (port_) port_->send(resp, true);
 }
 
-void DeviceHandler::handleCancelTimers_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleCancelTimers_(const transport::TransportMessageView& msg) {
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
 
-void DeviceHandler::handleSetRole_(const transport::TransportMessage& msg) {
+void DeviceHandler::handleSetRole_(const transport::TransportMessageView& msg) {
   // Role not persisted here; accept and respond OK.
   sendStatusOnly_(msg, transport::StatusCode::OK);
 }
+
+void DeviceHandler::handlePeerSet_(const transport::TransportMessageView& msg) {
+  // role:uint8 (0=clear standby, 1=set standby) + mac(6) + optional lmk(16)
+  if (!CONF || msg.payload.size() < 1) {
+    sendStatusOnly_(msg, transport::StatusCode::INVALID_PARAM);
+    return;
+  }
+  const uint8_t role = msg.payload[0];
+  if (role == 0) {
+    CONF->PutString(MASTER_STANDBY_ID, MASTER_STANDBY_ID_DEFAULT);
+    CONF->PutString(MASTER_STANDBY_LMK, MASTER_STANDBY_LMK_DEFAULT);
+  } else if (role == 1) {
+    const size_t n = msg.payload.size();
+    if (n != 7 && n != 23) {
+      sendStatusOnly_(msg, transport::StatusCode::INVALID_PARAM);
+      return;
+    }
+    char macStr[18];
+    snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X",
+             msg.payload[1], msg.payload[2], msg.payload[3],
+             msg.payload[4], msg.payload[5], msg.payload[6]);
+    char lmkHex[33] = {0};
+    if (n == 23) {
+      for (size_t i = 0; i < 16; ++i) {
+        snprintf(lmkHex + i * 2, 3, "%02X", msg.payload[7 + i]);
+      }
+    }
+    CONF->PutString(MASTER_STANDBY_ID, macStr);
+    CONF->PutString(MASTER_STANDBY_LMK, lmkHex);
+  } else {
+    sendStatusOnly_(msg, transport::StatusCode::UNSUPPORTED);
+    return;
+  }
+  // Identity cache + transport peer table reload on next use.
+  if (dev_ && dev_->Now) dev_->Now->invalidatePeerCache();
+  sendStatusOnly_(msg, transport::StatusCode::OK);
+}
+
+void DeviceHandler::handleLinkStats_(const transport::TransportMessageView& msg) {
+  if (!dev_ || !dev_->Now) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
+  AckLinkStatsPayload stats;
+  dev_->Now->linkStatsPayload(stats);
+  transport::TransportMessage resp;
+  resp.header = msg.header;
+  resp.header.srcId  = msg.header.destId;
+  resp.header.destId = msg.header.srcId;
+  resp.header.type   = static_cast<uint8_t>(transport::MessageType::Response);
+  resp.header.flags  = 0x02;
+  resp.payload.reserve(1 + sizeof(stats));
+  resp.payload.push_back(static_cast<uint8_t>(transport::StatusCode::OK));
+  const uint8_t* raw = reinterpret_cast<const uint8_t*>(&stats);
+  resp.payload.insert(resp.payload.end(), raw, raw + sizeof(stats));
+  resp.header.payloadLen = static_cast<uint8_t>(resp.payload.size());
+  if (port_) port_->send(resp, true);
+}
+
+void DeviceHandler::handleChannelRescan_(const transport::TransportMessageView& msg) {
+  if (!dev_ || !dev_->Now) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
+  // Result lands in LinkStats (channel, rescan counters); the hop runs in the ESP-NOW worker.
+  const bool started = dev_->Now->requestChannelRescan();
+  sendStatusOnly_(msg, started ? transport::StatusCode::OK : transport::StatusCode::BUSY);
+}
+
+void DeviceHandler::handleBootTimes_(const transport::TransportMessageView& msg) {
+  uint8_t times[1 + 4 * static_cast<size_t>(BootTrace::Phase::Count)];
+  const size_t n = BootTrace::payload(times, sizeof(times));
+  transport::TransportMessage resp;
+  resp.header = msg.header;
+  resp.header.srcId  = msg.header.destId;
+  resp.header.destId = msg.header.srcId;
+  resp.header.type   = static_cast<uint8_t>(transport::MessageType::Response);
+  resp.header.flags  = 0x02;
+  resp.payload.reserve(1 + n);
+  resp.payload.push_back(static_cast<uint8_t>(transport::StatusCode::OK));
+  resp.payload.insert(resp.payload.end(), times, times + n);
+  resp.header.payloadLen = static_cast<uint8_t>(resp.payload.size());
+  if (port_) port_->send(resp, true);
+}
+
+void DeviceHandler::handleCmdStats_(const transport::TransportMessageView& msg) {
+  if (!dev_ || !dev_->Now) { sendStatusOnly_(msg, transport::StatusCode::DENIED); return; }
+  const EspNowManager::CmdStats& st = dev_->Now->cmdStats();
+  const uint32_t fields[] = {st.decoded, st.unknown, st.badLen, st.policy,
+                             st.decodeLastCycles, st.decodeMaxCycles};
+  transport::TransportMessage resp;
+  resp.header = msg.header;
+  resp.header.srcId  = msg.header.destId;
+  resp.header.destId = msg.header.srcId;
+  resp.header.type   = static_cast<uint8_t>(transport::MessageType::Response);
+  resp.header.flags  = 0x02;
+  resp.payload.reserve(1 + sizeof(fields));
+  resp.payload.push_back(static_cast<uint8_t>(transport::StatusCode::OK));
+  for (const uint32_t v : fields) {
+    resp.payload.push_back(uint8_t(v));
+    resp.payload.push_back(uint8_t(v >> 8));
+    resp.payload.push_back(uint8_t(v >> 16));
+    resp.payload.push_back(uint8_t(v >> 24));
+  }
+  resp.header.payloadLen = static_cast<uint8_t>(resp.payload.size());
+  if (port_) port_->send(resp, true);
+}
@@ -26,23 +26,28 @@ public:
   DeviceHandler(Device* dev, transport::TransportPort* port)
       : dev_(dev), port_(port) {}
 
-  void onMessage(const transport::TransportMessage& msg) override;
+  void onMessageView(const transport::TransportMessageView& msg) override;
 
 private:
-  void handleConfigMode_(const transport::TransportMessage& msg);
-  void handleStateQuery_(const transport::TransportMessage& msg);
-  void handleConfigStatus_(const transport::TransportMessage& msg);
-  void handleArm_(const transport::TransportMessage& msg, bool arm);
-  void handleReboot_(const transport::TransportMessage& msg);
-  void handleCapsSet_(const transport::TransportMessage& msg);
-  void handleCapsQuery_(const transport::TransportMessage& msg);
-  void handlePairInit_(const transport::TransportMessage& msg);
-  void handlePairStatus_(const transport::TransportMessage& msg);
-  void handleNvsWrite_(const transport::TransportMessage& msg);
-  void handleHeartbeat_(const transport::TransportMessage& msg);
-  void handleCancelTimers_(const transport::TransportMessage& msg);
-  void handleSetRole_(const transport::TransportMessage& msg);
-  void sendStatusOnly_(const transport::TransportMessage& req, transport::StatusCode status);
+  void handleConfigMode_(const transport::TransportMessageView& msg);
+  void handleStateQuery_(const transport::TransportMessageView& msg);
+  void handleConfigStatus_(const transport::TransportMessageView& msg);
+  void handleArm_(const transport::TransportMessageView& msg, bool arm);
+  void handleReboot_(const transport::TransportMessageView& msg);
+  void handleCapsSet_(const transport::TransportMessageView& msg);
+  void handleCapsQuery_(const transport::TransportMessageView& msg);
+  void handlePairInit_(const transport::TransportMessageView& msg);
+  void handlePairStatus_(const transport::TransportMessageView& msg);
+  void handleNvsWrite_(const transport::TransportMessageView& msg);
+  void handleHeartbeat_(const transport::TransportMessageView& msg);
+  void handleCancelTimers_(const transport::TransportMessageView& msg);
+  void handleSetRole_(const transport::TransportMessageView& msg);
+  void handlePeerSet_(const transport::TransportMessageView& msg);
+  void handleLinkStats_(const transport::TransportMessageView& msg);
+  void handleChannelRescan_(const transport::TransportMessageView& msg);
+  void handleBootTimes_(const transport::TransportMessageView& msg);
+  void handleCmdStats_(const transport::TransportMessageView& msg);
+  void sendStatusOnly_(const transport::TransportMessageView& req, transport::StatusCode status);
 
   Device* dev_;
   transport::TransportPort* port_;
@@ -12,7 +12,7 @@ static constexpr uint8_t SHOCK_SET_THS  = 0x11;
 static constexpr uint8_t SHOCK_SET_L2D  = 0x12;
 static constexpr uint8_t SHOCK_REASON_INT_MISSING = 0x01;
 
-void ShockHandler::onMessage(const transport::TransportMessage& msg) {
+void ShockHandler::onMessageView(const transport::TransportMessageView& msg) {
   if (!nvs_) { sendStatus_(msg, transport::StatusCode::DENIED); return; }
 
   auto applyCfg = [this]() -> bool {
@@ -134,12 +134,12 @@ void ShockHandler::onMessage(const transport::TransportMessage& msg) {
   }
 }
 
-void ShockHandler::sendStatus_(const transport::TransportMessage& req,
+void ShockHandler::sendStatus_(const transport::TransportMessageView& req,
                                transport::StatusCode status) {
   sendStatus_(req, status, {});
 }
 
-void ShockHandler::sendStatus_(const transport::TransportMessage& req,
+void ShockHandler::sendStatus_(const transport::TransportMessageView& req,
                                transport::StatusCode status,
                                const std::vector<uint8_t>& extra) {
   transport::TransportMessage resp;
@@ -22,12 +22,12 @@ public:
   ShockHandler(NVS* nvs, transport::TransportPort* port, ShockSensor* sensor)
       : nvs_(nvs), port_(port), sensor_(sensor) {}
 
-  void onMessage(const transport::TransportMessage& msg) override;
+  void onMessageView(const transport::TransportMessageView& msg) override;
 
 private:
-  void sendStatus_(const transport::TransportMessage& req,
+  void sendStatus_(const transport::TransportMessageView& req,
                    transport::StatusCode status);
-  void sendStatus_(const transport::TransportMessage& req,
+  void sendStatus_(const transport::TransportMessageView& req,
                    transport::StatusCode status,
                    const std::vector<uint8_t>& extra);
 
@@ -131,7 +131,7 @@ void Fingerprint::begin() {
                sensorPresent_ ? 1 : 0,
                tamperDetected_ ? 1 : 0);
     if (ok) {
-        const bool configured = (CONF && CONF->GetBool(DEVICE_CONFIGURED, false));
+        const bool configured = (CONF && CONF->get<Cfg::DeviceConfigured>());
         if (!configured) {
             DBG_PRINTLN("[FP] unpaired -> releasing adopted sensor to default");
             releaseSensorToDefault();
@@ -1191,7 +1191,7 @@ bool Fingerprint::getNextFreeId(uint16_t& id) {
 // -----------------------------------------------------------
 bool Fingerprint::isDeviceConfigured() {
     if (!CONF) return false;
-    return CONF->GetBool(FP_DEVICE_CONFIGURED_KEY, false);
+    return CONF->get<Cfg::FpDeviceConfigured>();
 }
 
 void Fingerprint::setDeviceConfigured(bool value) {
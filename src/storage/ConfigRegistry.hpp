@@ -0,0 +1,75 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#ifndef CONFIG_REGISTRY_H
+#define CONFIG_REGISTRY_H
+/**
+ * @file ConfigRegistry.h
+ * @brief Typed config key IDs generated from CONFIG_KEY_TABLE (ConfigNvs.hpp).
+ *
+ *   CONF->get<Cfg::DeviceConfigured>()        -> bool, O(1), no string compare
+ *   CONF->set<Cfg::ArmedState>(true)          -> type checked at compile time
+ *   CONF->subscribe(fn, ctx, cfgBit(Cfg::X))  -> fn(id, ctx) after a change
+ *
+ * The enum order is the table order; NVS keeps its RAM entries in the same
+ * order, so an ID is a direct index.
+ */
+
+#include <Arduino.h>
+#include <ConfigNvs.hpp>
+
+namespace cfg {
+enum class Kind : uint8_t { Bool, Int, UInt, U64, Float, Str };
+enum class Policy : uint8_t { Deferred, Critical };
+
+template <Kind> struct Traits;
+template <> struct Traits<Kind::Bool>  { using type = bool; };
+template <> struct Traits<Kind::Int>   { using type = int; };
+template <> struct Traits<Kind::UInt>  { using type = uint32_t; };
+template <> struct Traits<Kind::U64>   { using type = uint64_t; };
+template <> struct Traits<Kind::Float> { using type = float; };
+template <> struct Traits<Kind::Str>   { using type = String; };
+
+struct Info {
+    const char* key;
+    Kind        kind;
+    Policy      policy;
+};
+} // namespace cfg
+
+enum class Cfg : uint8_t {
+#define CFG_ENUM_(id, key, kind, def, policy) id,
+    CONFIG_KEY_TABLE(CFG_ENUM_)
+#undef CFG_ENUM_
+    Count
+};
+
+inline constexpr cfg::Info kCfgInfo[] = {
+#define CFG_INFO_(id, key, kind, def, policy) { key, cfg::Kind::kind, cfg::Policy::policy },
+    CONFIG_KEY_TABLE(CFG_INFO_)
+#undef CFG_INFO_
+};
+static_assert(sizeof(kCfgInfo) / sizeof(kCfgInfo[0]) == static_cast<size_t>(Cfg::Count),
+              "CONFIG_KEY_TABLE expansion mismatch");
+static_assert(static_cast<size_t>(Cfg::Count) <= 64, "cfgBit() mask is 64 bits");
+
+template <Cfg K>
+using CfgType = typename cfg::Traits<kCfgInfo[static_cast<size_t>(K)].kind>::type;
+
+// Table default for each ID (string defaults stay const char*).
+template <Cfg K> struct CfgDefault;
+#define CFG_DEFAULT_(id, key, kind, def, policy) \
+    template <> struct CfgDefault<Cfg::id> { static constexpr auto value = def; };
+CONFIG_KEY_TABLE(CFG_DEFAULT_)
+#undef CFG_DEFAULT_
+
+// Subscription masks.
+constexpr uint64_t cfgBit(Cfg id) { return uint64_t(1) << static_cast<uint8_t>(id); }
+constexpr uint64_t kCfgAll = ~uint64_t(0);
+
+#endif // CONFIG_REGISTRY_H
@@ -0,0 +1,283 @@
+#include <FlashJournal.hpp>
+#include <TransportCrc.hpp>
+#include <Utils.hpp>
+#include <string.h>
+
+// ======================================================
+// ctor
+// ======================================================
+FlashJournal::FlashJournal() {
+    mutex_ = xSemaphoreCreateMutex();
+}
+
+// ======================================================
+// Slot helpers
+// ======================================================
+bool FlashJournal::slotBlank_(const Slot& s) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&s);
+    for (size_t i = 0; i < sizeof(Slot); ++i) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+bool FlashJournal::slotValid_(const Slot& s) {
+    if (s.magic != kMagic || s.len > kFields) return false;
+    const uint16_t crc = transport::crc::crc16(reinterpret_cast<const uint8_t*>(&s),
+                                               offsetof(Slot, crc));
+    return crc == s.crc;
+}
+
+bool FlashJournal::readSlots_(uint32_t idx, Slot* out, uint32_t n) {
+    return esp_partition_read(part_, idx * kSlotSize, out, n * kSlotSize) == ESP_OK;
+}
+
+// ======================================================
+// Recovery
+// ======================================================
+// Caller holds the mutex.
+bool FlashJournal::findPartition_() {
+    const esp_partition_t* p = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, FLASH_JOURNAL_LABEL);
+    if (!p || p->size < 2 * kSectorSize) {
+        DBG_PRINTLN("[JOURNAL] no '" FLASH_JOURNAL_LABEL "' partition");
+        return false;
+    }
+    part_  = p;
+    slots_ = (p->size / kSectorSize) * kSlotsPerSec;
+    return true;
+}
+
+bool FlashJournal::begin() {
+    lock_();
+    if (part_) { unlock_(); return true; }
+    if (!findPartition_()) { unlock_(); return false; }
+
+    const uint32_t t0 = micros();
+    bool     any       = false;
+    uint32_t lastStamp = 0;
+    uint32_t lastIdx   = 0;
+    Slot chunk[kChunkSlots];
+    for (uint32_t base = 0; base < slots_; base += kChunkSlots) {
+        if (!readSlots_(base, chunk, kChunkSlots)) continue;
+        for (uint32_t i = 0; i < kChunkSlots; ++i) {
+            const Slot& s = chunk[i];
+            if (slotBlank_(s)) continue;
+            if (!slotValid_(s)) { stats_.torn++; continue; }
+            if (!any || s.stamp > lastStamp) {
+                any = true;
+                lastStamp = s.stamp;
+                lastIdx   = base + i;
+            }
+            if (s.type == kTypeAck) {
+                if (s.seq > ackSeq_) ackSeq_ = s.seq;
+            } else if (s.seq > lastSeq_) {
+                lastSeq_ = s.seq;
+            }
+        }
+    }
+    stamp_     = lastStamp;
+    head_      = any ? (lastIdx + 1) % slots_ : 0;
+    headReady_ = false;
+    const bool ok = prepareHead_(true);
+    stats_.scanUs = micros() - t0;
+    unlock_();
+
+    DBG_PRINTF("[JOURNAL] %u slots head=%u last=%lu acked=%lu torn=%u scan=%luus\n",
+               (unsigned)slots_, (unsigned)head_, (unsigned long)lastSeq_,
+               (unsigned long)ackSeq_, (unsigned)stats_.torn,
+               (unsigned long)stats_.scanUs);
+    return ok;
+}
+
+// Warm wake: nothing wrote the partition while we slept, so the saved
+// cursor is the scan result. prepareHead_() still checks the head slot.
+// On failure nothing is kept, so the caller's begin() runs the full scan.
+bool FlashJournal::resume(const Cursor& c) {
+    lock_();
+    if (part_) { unlock_(); return true; }
+    if (!findPartition_()) { unlock_(); return false; }
+    if (c.slots != slots_ || c.head >= slots_ || c.ackSeq > c.lastSeq) {
+        forget_();
+        unlock_();
+        return false;
+    }
+    head_      = c.head;
+    stamp_     = c.stamp;
+    lastSeq_   = c.lastSeq;
+    ackSeq_    = c.ackSeq;
+    headReady_ = false;
+    if (!prepareHead_()) {
+        forget_();
+        unlock_();
+        DBG_PRINTLN("[JOURNAL] resume failed; rescanning");
+        return false;
+    }
+    stats_.scanUs = 0;
+    unlock_();
+
+    DBG_PRINTF("[JOURNAL] resumed head=%u last=%lu acked=%lu\n",
+               (unsigned)head_, (unsigned long)lastSeq_, (unsigned long)ackSeq_);
+    return true;
+}
+
+// Back to "no partition": begin() scans from scratch (its maxima start at 0).
+void FlashJournal::forget_() {
+    part_      = nullptr;
+    slots_     = 0;
+    head_      = 0;
+    headReady_ = false;
+    stamp_     = 0;
+    lastSeq_   = 0;
+    ackSeq_    = 0;
+}
+
+bool FlashJournal::cursor(Cursor& out) {
+    if (!part_) return false;
+    lock_();
+    out.slots   = slots_;
+    out.head    = head_;
+    out.stamp   = stamp_;
+    out.lastSeq = lastSeq_;
+    out.ackSeq  = ackSeq_;
+    unlock_();
+    return true;
+}
+
+// Makes head_ a blank slot. Entering a sector erases it (oldest data);
+// inside a sector, torn slots left by a power cut are stepped over
+// (`scanned`: begin() has counted them already).
+bool FlashJournal::prepareHead_(bool scanned) {
+    for (uint32_t guard = 0; guard <= kSlotsPerSec; ++guard) {
+        if (head_ % kSlotsPerSec == 0) {
+            Slot chunk[kChunkSlots];
+            bool blank = true;
+            for (uint32_t i = 0; i < kSlotsPerSec; i += kChunkSlots) {
+                if (!readSlots_(head_ + i, chunk, kChunkSlots)) { blank = false; continue; }
+                for (uint32_t k = 0; k < kChunkSlots; ++k) {
+                    const Slot& s = chunk[k];
+                    if (slotBlank_(s)) continue;
+                    blank = false;
+                    if (slotValid_(s) && s.type != kTypeAck && s.seq > ackSeq_) stats_.dropped++;
+                }
+            }
+            if (!blank) {
+                if (esp_partition_erase_range(part_, head_ * kSlotSize, kSectorSize) != ESP_OK) {
+                    stats_.writeErrors++;
+                    return false;
+                }
+                stats_.erases++;
+            }
+            headReady_ = true;
+            return true;
+        }
+        Slot s;
+        if (readSlots_(head_, &s, 1) && slotBlank_(s)) {
+            headReady_ = true;
+            return true;
+        }
+        if (!scanned) stats_.torn++;
+        head_ = (head_ + 1) % slots_;
+    }
+    return false;
+}
+
+// ======================================================
+// Append / ack
+// ======================================================
+bool FlashJournal::writeSlot_(uint8_t type, uint32_t seq, const uint8_t* fields, uint8_t len) {
+    if (!headReady_ && !prepareHead_()) return false;
+
+    Slot s;
+    memset(&s, 0xFF, sizeof(s));
+    s.magic = kMagic;
+    s.type  = type;
+    s.len   = len > kFields ? kFields : len;
+    s.stamp = ++stamp_;
+    s.seq   = seq;
+    if (fields && s.len) memcpy(s.fields, fields, s.len);
+    s.crc = transport::crc::crc16(reinterpret_cast<const uint8_t*>(&s), offsetof(Slot, crc));
+
+    const bool ok = esp_partition_write(part_, head_ * kSlotSize, &s, sizeof(s)) == ESP_OK;
+    if (ok) stats_.bytesWritten += sizeof(s);
+    else    stats_.writeErrors++;
+
+    // Advance even on failure: the slot may be half written.
+    head_ = (head_ + 1) % slots_;
+    headReady_ = (head_ % kSlotsPerSec) != 0;
+    return ok;
+}
+
+bool FlashJournal::append(uint32_t seq, uint8_t type, const uint8_t* fields, uint8_t len) {
+    if (!part_ || type == kTypeAck) return false;
+    lock_();
+    const bool ok = writeSlot_(type, seq, fields, len);
+    if (ok) {
+        stats_.appends++;
+        if (seq > lastSeq_) lastSeq_ = seq;
+    }
+    unlock_();
+    return ok;
+}
+
+bool FlashJournal::ack(uint32_t seq) {
+    if (!part_) return false;
+    lock_();
+    bool ok = true;
+    if (seq > ackSeq_) {
+        // Raised first: a sector this ACK opens holds nothing it leaves
+        // unacknowledged, so erasing it drops nothing.
+        const uint32_t prev = ackSeq_;
+        ackSeq_ = seq;
+        ok = writeSlot_(kTypeAck, seq, nullptr, 0);
+        if (ok) stats_.acks++;
+        else    ackSeq_ = prev;
+    }
+    unlock_();
+    return ok;
+}
+
+// ======================================================
+// Replay
+// ======================================================
+// Walks the ring once from head_: the slots from head_ to the end of its
+// sector are blank, torn, or (sector not yet erased) the oldest records.
+// `pos` is a cursor from an earlier call: where the visitor stopped, or
+// head_ as it was when the walk finished.
+size_t FlashJournal::forEachPending(Visitor fn, void* ctx, uint32_t& pos) {
+    if (!part_ || !fn) return 0;
+    lock_();
+    size_t n = 0;
+    const uint32_t oldest = head_;
+    uint32_t at = 0;                                 // distance from oldest
+    if (pos == head_)     at = slots_;               // finished, nothing appended since
+    else if (pos < slots_) at = (pos + slots_ - oldest) % slots_;
+    bool stopped = false;
+    if (lastSeq_ > ackSeq_) {
+        Slot chunk[kChunkSlots];
+        while (!stopped && at < slots_) {
+            const uint32_t idx  = (oldest + at) % slots_;
+            const uint32_t skip = idx % kChunkSlots;   // resume mid-chunk
+            if (readSlots_(idx - skip, chunk, kChunkSlots)) {
+                for (uint32_t i = skip; i < kChunkSlots; ++i) {
+                    const Slot& s = chunk[i];
+                    if (s.type == kTypeAck || !slotValid_(s) || s.seq <= ackSeq_) continue;
+                    if (!fn(ctx, s.seq, s.type, s.fields, s.len)) {
+                        at += i - skip;
+                        stopped = true;
+                        break;
+                    }
+                    ++n;
+                }
+            }
+            if (!stopped) at += kChunkSlots - skip;
+        }
+    }
+    // Walked to the end: later appends land at head_ or after it. Stopped
+    // on the oldest slot: same as starting over (pos == head_ means done).
+    if (!stopped)  pos = head_;
+    else if (at)   pos = (oldest + at) % slots_;
+    else           pos = kFromOldest;
+    unlock_();
+    return n;
+}
@@ -0,0 +1,134 @@
+/**************************************************************
+ *  Author      : Tshibangu Samuel
+ *  Role        : Freelance Embedded Systems Engineer
+ *  Expertise   : Secure IoT Systems, Embedded C++, RTOS, Control Logic
+ *  Contact     : tshibsamuel47@gmail.com
+ *  Portfolio   : https://www.freelancer.com/u/tshibsamuel477
+ *  Phone       : +216 54 429 793
+ **************************************************************/
+#ifndef FLASH_JOURNAL_H
+#define FLASH_JOURNAL_H
+/**
+ * @file FlashJournal.h
+ * @brief Append-only event ring on the raw "journal" data partition.
+ *
+ * - Fixed 32-byte slots, CRC-16 protected, written strictly in order.
+ * - append() writes one slot; ack(seq) writes one ACK slot (truncate), so
+ *   both are O(1) and nothing is ever rewritten in place.
+ * - Entering a sector erases it first; whatever it still held is the
+ *   oldest data and is dropped.
+ * - begin() scans once: the slot with the highest write stamp is the last
+ *   one written, the newest ACK says what the master already has. Torn
+ *   slots (power loss mid-write) fail the CRC and are skipped.
+ *
+ * - cursor()/resume() carry the ring position across deep sleep (RTC
+ *   memory), so a warm wake skips the scan.
+ *
+ * Slot: [magic][type][len][0xFF][stamp u32][seq u32][fields 18][crc16]
+ */
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#ifndef FLASH_JOURNAL_LABEL
+#define FLASH_JOURNAL_LABEL  "journal"
+#endif
+
+class FlashJournal {
+public:
+    static constexpr size_t  kSlotSize = 32;
+    static constexpr size_t  kFields   = 18;     // packed field bytes per slot
+    static constexpr uint8_t kTypeAck  = 0xFE;   // seq = newest acknowledged seq
+
+    struct Stats {
+        uint32_t appends      = 0;
+        uint32_t acks         = 0;
+        uint32_t erases       = 0;
+        uint32_t bytesWritten = 0;   // slot writes only (erases counted apart)
+        uint32_t writeErrors  = 0;
+        uint32_t torn         = 0;   // non-blank slots that failed the CRC
+        uint32_t dropped      = 0;   // unacknowledged records lost to an erase
+        uint32_t scanUs       = 0;   // begin() recovery scan
+    };
+
+    struct Cursor {
+        uint32_t slots;
+        uint32_t head;
+        uint32_t stamp;
+        uint32_t lastSeq;
+        uint32_t ackSeq;
+    };
+
+    // Called for each unacknowledged record, oldest first; false = stop
+    // (the record is left for the next call).
+    using Visitor = bool (*)(void* ctx, uint32_t seq, uint8_t type,
+                             const uint8_t* fields, uint8_t len);
+
+    // forEachPending() read cursor: start at the oldest slot.
+    static constexpr uint32_t kFromOldest = UINT32_MAX;
+
+    FlashJournal();
+
+    bool begin();                // find partition + recover; false = not present
+    bool resume(const Cursor& c); // begin() without the scan; false = call begin()
+    bool ready() const { return part_ != nullptr; }
+    bool cursor(Cursor& out);     // false = not ready
+
+    bool   append(uint32_t seq, uint8_t type, const uint8_t* fields, uint8_t len);
+    bool   ack(uint32_t seq);    // records with seq <= this are consumed
+    // Walks from slot `pos` to the head and leaves `pos` where the visitor
+    // stopped, so repeated calls read each slot once. A cursor made stale
+    // by a sector erase only defers records to a walk from kFromOldest.
+    size_t forEachPending(Visitor fn, void* ctx, uint32_t& pos);
+
+    uint32_t lastSeq()  const { return lastSeq_; }
+    uint32_t ackedSeq() const { return ackSeq_; }
+    uint32_t capacity() const { return slots_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+#pragma pack(push, 1)
+    struct Slot {
+        uint8_t  magic;
+        uint8_t  type;
+        uint8_t  len;
+        uint8_t  rsv;
+        uint32_t stamp;    // write order across all slots
+        uint32_t seq;
+        uint8_t  fields[kFields];
+        uint16_t crc;      // CRC-16 over everything above
+    };
+#pragma pack(pop)
+    static_assert(sizeof(Slot) == kSlotSize, "journal slot must stay 32 bytes");
+
+    static constexpr uint8_t  kMagic       = 0xA5;
+    static constexpr uint32_t kSectorSize  = 4096;
+    static constexpr uint32_t kSlotsPerSec = kSectorSize / kSlotSize;
+    static constexpr uint32_t kChunkSlots  = 8;   // slots per flash read
+
+    bool findPartition_();
+    static bool slotBlank_(const Slot& s);
+    static bool slotValid_(const Slot& s);
+
+    bool readSlots_(uint32_t idx, Slot* out, uint32_t n);
+    bool writeSlot_(uint8_t type, uint32_t seq, const uint8_t* fields, uint8_t len);
+    bool prepareHead_(bool scanned = false);
+    void forget_();
+
+    void lock_()   { if (mutex_) xSemaphoreTake(mutex_, portMAX_DELAY); }
+    void unlock_() { if (mutex_) xSemaphoreGive(mutex_); }
+
+    const esp_partition_t* part_ = nullptr;
+    SemaphoreHandle_t mutex_ = nullptr;
+    uint32_t slots_     = 0;
+    uint32_t head_      = 0;       // next slot to write
+    bool     headReady_ = false;   // head_ slot known blank
+    uint32_t stamp_     = 0;
+    uint32_t lastSeq_   = 0;
+    uint32_t ackSeq_    = 0;
+    Stats    stats_;
+};
+
+#endif // FLASH_JOURNAL_H
@@ -5,6 +5,7 @@
 #include <WiFi.h>
 #include <esp_sleep.h>
 #include <esp_task_wdt.h>
+#include <string.h>
 
 // ======================================================
 // Static singleton pointer
@@ -12,6 +13,18 @@
 NVS* NVS::s_instance = nullptr;
 
 
+// ======================================================
+// Cached keys: one entry per CONFIG_KEY_TABLE row, in Cfg order
+// critical = committed at once, with everything dirty before it
+// ======================================================
+NVS::Entry NVS::s_entries_[NVS::s_entryCount_] = {
+#define NVS_ENTRY_(id, key, kind, def, policy) \
+    { key, NVS::Kind::kind, cfg::Policy::policy == cfg::Policy::Critical },
+    CONFIG_KEY_TABLE(NVS_ENTRY_)
+#undef NVS_ENTRY_
+};
+
+
 // ======================================================
 // Singleton Init() and Get()
 // ======================================================
@@ -111,6 +124,7 @@ void NVS::startPreferencesRead() {
 // ======================================================
 void NVS::end() {
     lock_();
+    flushLocked_();
     if (is_open_) {
         preferences.end();
         is_open_ = false;
@@ -136,8 +150,8 @@ void NVS::begin() {
     DBG_PRINTLN("#                 Starting NVS Manager ⚙️                 #");
     DBG_PRINTLN("###########################################################");
     DBGSTP();
-    ensureOpenRO_();
-    bool resetFlag = preferences.getBool(RESET_FLAG, RESET_FLAG_DEFAULT);
+    // Cached read: a warm wake seeded from RTC memory opens no prefs here.
+    const bool resetFlag = get<Cfg::ResetFlag>();
 
     if (resetFlag) {
         DBG_PRINTLN("[NVS] Initializing the device... 🔄");
@@ -189,6 +203,8 @@ void NVS::initializeVariables() {
     PutString(DEVICE_ID,            devId);
     PutString(MASTER_ESPNOW_ID,     MASTER_ESPNOW_ID_DEFAULT);
     PutString(MASTER_LMK_KEY,       MASTER_LMK_DEFAULT);
+    PutString(MASTER_STANDBY_ID,    MASTER_STANDBY_ID_DEFAULT);
+    PutString(MASTER_STANDBY_LMK,   MASTER_STANDBY_LMK_DEFAULT);
     PutBool  (DEVICE_CONFIGURED,    DEVICE_CONFIGURED_DEFAULT);
 
     //
@@ -246,6 +262,7 @@ void NVS::initializeVariables() {
     // Pairing channel + fingerprint provisioning flags
     // -------------------------------------------------
     PutInt (MASTER_CHANNEL_KEY, MASTER_CHANNEL_DEFAULT);
+    PutInt (MASTER_WIRE_KEY,    MASTER_WIRE_DEFAULT);
     PutBool(FP_DEVICE_CONFIGURED_KEY, FP_DEVICE_CONFIGURED_DEFAULT);
 }
 
@@ -253,6 +270,7 @@ void NVS::initializeVariables() {
 // Reads (auto-open RO)
 // ======================================================
 bool NVS::GetBool(const char* key, bool defaultValue) {
+    if (Entry* e = cached_(key, Kind::Bool)) return read_(*e, defaultValue);
     esp_task_wdt_reset();
     ensureOpenRO_();
     bool v = preferences.getBool(key, defaultValue);
@@ -260,6 +278,7 @@ bool NVS::GetBool(const char* key, bool defaultValue) {
 }
 
 int NVS::GetInt(const char* key, int defaultValue) {
+    if (Entry* e = cached_(key, Kind::Int)) return read_(*e, defaultValue);
     esp_task_wdt_reset();
     ensureOpenRO_();
     int v = preferences.getInt(key, defaultValue);
@@ -267,6 +286,7 @@ int NVS::GetInt(const char* key, int defaultValue) {
 }
 
 uint64_t NVS::GetULong64(const char* key, int defaultValue) {
+    if (Entry* e = cached_(key, Kind::U64)) return read_(*e, static_cast<uint64_t>(defaultValue));
     esp_task_wdt_reset();
     ensureOpenRO_();
     uint64_t v = preferences.getULong64(key, defaultValue);
@@ -274,6 +294,7 @@ uint64_t NVS::GetULong64(const char* key, int defaultValue) {
 }
 
 float NVS::GetFloat(const char* key, float defaultValue) {
+    if (Entry* e = cached_(key, Kind::Float)) return read_(*e, defaultValue);
     esp_task_wdt_reset();
     ensureOpenRO_();
     float v = preferences.getFloat(key, defaultValue);
@@ -281,18 +302,28 @@ float NVS::GetFloat(const char* key, float defaultValue) {
 }
 
 String NVS::GetString(const char* key, const String& defaultValue) {
+    if (Entry* e = cached_(key, Kind::Str)) return read_(*e, defaultValue);
     esp_task_wdt_reset();
     ensureOpenRO_();
     String v = preferences.getString(key, defaultValue);
     return v;
 }
 
+size_t NVS::GetBytes(const char* key, void* out, size_t maxLen) {
+    esp_task_wdt_reset();
+    ensureOpenRO_();
+    const size_t n = preferences.getBytesLength(key);
+    if (n == 0 || n > maxLen || !out) return 0;
+    return preferences.getBytes(key, out, n);
+}
+
 
 // ======================================================
 // Writes (auto-open RW)
 // (We remove existing key first to guarantee type)
 // ======================================================
 void NVS::PutBool(const char* key, bool value) {
+    if (Entry* e = cached_(key, Kind::Bool)) { write_(*e, value); return; }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -302,6 +333,7 @@ void NVS::PutBool(const char* key, bool value) {
 }
 
 void NVS::PutUInt(const char* key, int value) {
+    if (Entry* e = cached_(key, Kind::UInt)) { write_(*e, static_cast<uint32_t>(value)); return; }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -311,6 +343,7 @@ void NVS::PutUInt(const char* key, int value) {
 }
 
 void NVS::PutULong64(const char* key, int value) {
+    if (Entry* e = cached_(key, Kind::U64)) { write_(*e, static_cast<uint64_t>(value)); return; }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -320,6 +353,7 @@ void NVS::PutULong64(const char* key, int value) {
 }
 
 void NVS::PutInt(const char* key, int value) {
+    if (Entry* e = cached_(key, Kind::Int)) { write_(*e, value); return; }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -329,6 +363,16 @@ void NVS::PutInt(const char* key, int value) {
 }
 
 void NVS::PutIntImmediate(const char* key, int value) {
+    if (Entry* e = cached_(key, Kind::Int)) {
+        lock_();
+        e->v32 = static_cast<uint32_t>(value);
+        e->present = true;
+        flushLocked_();
+        commit_(*e);
+        unlock_();
+        notify_(*e);
+        return;
+    }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -338,6 +382,7 @@ void NVS::PutIntImmediate(const char* key, int value) {
 }
 
 void NVS::PutFloat(const char* key, float value) {
+    if (Entry* e = cached_(key, Kind::Float)) { write_(*e, value); return; }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -347,6 +392,7 @@ void NVS::PutFloat(const char* key, float value) {
 }
 
 void NVS::PutString(const char* key, const String& value) {
+    if (Entry* e = cached_(key, Kind::Str)) { write_(*e, value); return; }
     esp_task_wdt_reset();
     lock_();
     ensureOpenRW_();
@@ -355,20 +401,44 @@ void NVS::PutString(const char* key, const String& value) {
     unlock_();
 }
 
+void NVS::PutBytes(const char* key, const void* data, size_t len) {
+    esp_task_wdt_reset();
+    lock_();
+    ensureOpenRW_();
+    if (preferences.isKey(key)) preferences.remove(key);
+    if (len) preferences.putBytes(key, data, len);
+    unlock_();
+}
+
 
 // ======================================================
 // Key management
 // ======================================================
 void NVS::ClearKey() {
     lock_();
+    for (size_t i = 0; i < s_entryCount_; ++i) {
+        s_entries_[i].dirty  = false;
+        s_entries_[i].loaded = false;
+    }
     ensureOpenRW_();
     preferences.clear();
     unlock_();
+    for (size_t i = 0; i < s_entryCount_; ++i) notify_(s_entries_[i]);
 }
 
 void NVS::RemoveKey(const char* key) {
     esp_task_wdt_reset();
     lock_();
+    Entry* cached = nullptr;
+    for (size_t i = 0; i < s_entryCount_; ++i) {
+        Entry& e = s_entries_[i];
+        if (strcmp(e.key, key) != 0) continue;
+        e.dirty   = false;
+        e.present = false;
+        e.loaded  = true;    // known absent
+        e.str     = String();
+        cached = &e;
+    }
     ensureOpenRW_();
     if (preferences.isKey(key)) {
         preferences.remove(key);
@@ -377,6 +447,344 @@ void NVS::RemoveKey(const char* key) {
         DBG_PRINTLN(key);
     }
     unlock_();
+    if (cached) notify_(*cached);
+}
+
+
+// ======================================================
+// Write-back cache
+// ======================================================
+// Returns the entry for a cached key, loading it on first use. A key read
+// with another type than its table kind is committed and bypassed.
+NVS::Entry* NVS::cached_(const char* key, Kind kind) {
+    if (!key) return nullptr;
+    Entry* e = nullptr;
+    for (size_t i = 0; i < s_entryCount_; ++i) {
+        if (s_entries_[i].key[0] == key[0] && strcmp(s_entries_[i].key, key) == 0) {
+            e = &s_entries_[i];
+            break;
+        }
+    }
+    if (!e) return nullptr;
+    if (e->kind != kind) {
+        lock_();
+        if (e->dirty) commit_(*e);
+        e->loaded = false;
+        unlock_();
+        return nullptr;
+    }
+    if (e->loaded) {
+        cacheStats_.hits++;
+        return e;
+    }
+    lock_();
+    if (!e->loaded) load_(*e);
+    unlock_();
+    return e;
+}
+
+void NVS::load_(Entry& e) {
+    esp_task_wdt_reset();
+    ensureOpenRO_();
+    cacheStats_.misses++;
+    e.present = preferences.isKey(e.key);
+    if (e.present) {
+        switch (e.kind) {
+            case Kind::Bool:  e.v32 = preferences.getBool(e.key, false) ? 1u : 0u; break;
+            case Kind::Int:   e.v32 = static_cast<uint32_t>(preferences.getInt(e.key, 0)); break;
+            case Kind::UInt:  e.v32 = preferences.getUInt(e.key, 0); break;
+            case Kind::Float: {
+                const float f = preferences.getFloat(e.key, 0.0f);
+                uint32_t bits;
+                memcpy(&bits, &f, sizeof(bits));
+                e.v32 = bits;
+                break;
+            }
+            case Kind::U64: {
+                const uint64_t v = preferences.getULong64(e.key, 0);
+                portENTER_CRITICAL(&cacheMux_);
+                e.v64 = v;
+                portEXIT_CRITICAL(&cacheMux_);
+                break;
+            }
+            case Kind::Str:   e.str = preferences.getString(e.key, ""); break;
+        }
+    }
+    e.dirty  = false;
+    e.loaded = true;
+}
+
+// Caller holds mutex_. Same remove-then-put as the uncached writers.
+void NVS::commit_(Entry& e) {
+    esp_task_wdt_reset();
+    ensureOpenRW_();
+    if (preferences.isKey(e.key)) preferences.remove(e.key);
+    if (e.present) {
+        switch (e.kind) {
+            case Kind::Bool:  preferences.putBool(e.key, e.v32 != 0); break;
+            case Kind::Int:   preferences.putInt(e.key, static_cast<int32_t>(e.v32)); break;
+            case Kind::UInt:  preferences.putUInt(e.key, e.v32); break;
+            case Kind::Float: {
+                const uint32_t bits = e.v32;
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                preferences.putFloat(e.key, f);
+                break;
+            }
+            case Kind::U64:   preferences.putULong64(e.key, e.v64); break;
+            case Kind::Str:   preferences.putString(e.key, e.str); break;
+        }
+    }
+    e.dirty = false;
+    cacheStats_.commits++;
+}
+
+// Caller holds mutex_. Critical keys go out now, after every key dirtied
+// before them, so flash never holds a critical value newer than its context.
+void NVS::markDirty_(Entry& e) {
+    if (e.critical || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        flushLocked_();
+        commit_(e);
+        return;
+    }
+    e.dirty = true;
+    cacheStats_.deferred++;
+    if (!flusher_) {
+        xTaskCreate(flusherTask_, "NvsFlush", NVS_FLUSH_TASK_STACK, this,
+                    NVS_FLUSH_TASK_PRIO, &flusher_);
+        if (!flusher_) { flushLocked_(); return; }
+    }
+    xTaskNotifyGive(flusher_);
+}
+
+bool NVS::put32_(Entry& e, uint32_t bits) {
+    lock_();
+    const bool changed = !(e.present && e.v32 == bits);
+    if (changed) {
+        e.v32 = bits;
+        e.present = true;
+        markDirty_(e);
+    } else {
+        cacheStats_.unchanged++;
+    }
+    unlock_();
+    return changed;
+}
+
+// ------- Typed readers / writers (entry already loaded) -------
+uint64_t NVS::read_(Entry& e, uint64_t def) {
+    if (!e.present) return def;
+    portENTER_CRITICAL(&cacheMux_);
+    const uint64_t v = e.v64;
+    portEXIT_CRITICAL(&cacheMux_);
+    return v;
+}
+
+float NVS::read_(Entry& e, float def) {
+    if (!e.present) return def;
+    const uint32_t bits = e.v32;
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+String NVS::read_(Entry& e, const String& def) {
+    lock_();
+    String v = e.present ? e.str : def;
+    unlock_();
+    return v;
+}
+
+void NVS::write_(Entry& e, uint64_t value) {
+    lock_();
+    const bool changed = !(e.present && e.v64 == value);
+    if (changed) {
+        portENTER_CRITICAL(&cacheMux_);
+        e.v64 = value;
+        portEXIT_CRITICAL(&cacheMux_);
+        e.present = true;
+        markDirty_(e);
+    } else {
+        cacheStats_.unchanged++;
+    }
+    unlock_();
+    if (changed) notify_(e);
+}
+
+void NVS::write_(Entry& e, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (put32_(e, bits)) notify_(e);
+}
+
+void NVS::write_(Entry& e, const String& value) {
+    lock_();
+    const bool changed = !(e.present && e.str == value);
+    if (changed) {
+        e.str = value;
+        e.present = true;
+        markDirty_(e);
+    } else {
+        cacheStats_.unchanged++;
+    }
+    unlock_();
+    if (changed) notify_(e);
+}
+
+// ------- Typed registry -------
+NVS::Entry& NVS::entry_(Cfg id) {
+    Entry& e = s_entries_[static_cast<size_t>(id)];
+    if (e.loaded) {
+        cacheStats_.hits++;
+        return e;
+    }
+    lock_();
+    if (!e.loaded) load_(e);
+    unlock_();
+    return e;
+}
+
+// ------- Warm-sleep snapshot -------
+// Only loaded, clean entries are exported; the rest load lazily as usual.
+void NVS::exportSnapshot(Snapshot& out) {
+    memset(&out, 0, sizeof(out));
+    size_t pool = 0;
+    lock_();
+    for (size_t i = 0; i < s_entryCount_; ++i) {
+        Entry& e = s_entries_[i];
+        if (!e.loaded || e.dirty) continue;
+        if (e.kind == Kind::Str) {
+            const size_t n = e.str.length() + 1;
+            if (pool + n > sizeof(out.strPool)) continue;
+            memcpy(out.strPool + pool, e.str.c_str(), n);
+            pool += n;
+        } else if (e.kind == Kind::U64) {
+            portENTER_CRITICAL(&cacheMux_);
+            out.value[i] = e.v64;
+            portEXIT_CRITICAL(&cacheMux_);
+        } else {
+            out.value[i] = e.v32;
+        }
+        const uint64_t bit = uint64_t(1) << i;
+        out.captured |= bit;
+        if (e.present) out.present |= bit;
+    }
+    unlock_();
+}
+
+size_t NVS::importSnapshot(const Snapshot& in) {
+    size_t seeded = 0;
+    size_t pool = 0;
+    lock_();
+    for (size_t i = 0; i < s_entryCount_; ++i) {
+        const uint64_t bit = uint64_t(1) << i;
+        if (!(in.captured & bit)) continue;
+        Entry& e = s_entries_[i];
+        if (e.kind == Kind::Str) {
+            const size_t n = strnlen(in.strPool + pool, sizeof(in.strPool) - pool);
+            if (pool + n >= sizeof(in.strPool)) break;   // unterminated: stop here
+            if (!e.loaded) e.str = String(in.strPool + pool);
+            pool += n + 1;
+        } else if (e.loaded) {
+            continue;
+        } else if (e.kind == Kind::U64) {
+            portENTER_CRITICAL(&cacheMux_);
+            e.v64 = in.value[i];
+            portEXIT_CRITICAL(&cacheMux_);
+        } else {
+            e.v32 = static_cast<uint32_t>(in.value[i]);
+        }
+        if (e.loaded) continue;
+        e.present = (in.present & bit) != 0;
+        e.dirty   = false;
+        e.loaded  = true;
+        ++seeded;
+    }
+    cacheStats_.warm += seeded;
+    unlock_();
+    return seeded;
+}
+
+bool NVS::subscribe(CfgListener fn, void* ctx, uint64_t mask) {
+    if (!fn) return false;
+    bool ok = false;
+    portENTER_CRITICAL(&cacheMux_);
+    if (listenerCount_ < NVS_MAX_LISTENERS) {
+        listeners_[listenerCount_++] = { fn, ctx, mask };
+        ok = true;
+    }
+    portEXIT_CRITICAL(&cacheMux_);
+    return ok;
+}
+
+// Listeners run outside mutex_, on the writer's task.
+void NVS::notify_(const Entry& e) {
+    const Cfg id = static_cast<Cfg>(&e - s_entries_);
+    const uint64_t bit = cfgBit(id);
+    Listener snap[NVS_MAX_LISTENERS];
+    portENTER_CRITICAL(&cacheMux_);
+    const uint8_t n = listenerCount_;
+    for (uint8_t i = 0; i < n; ++i) snap[i] = listeners_[i];
+    portEXIT_CRITICAL(&cacheMux_);
+    for (uint8_t i = 0; i < n; ++i) {
+        if (snap[i].mask & bit) snap[i].fn(id, snap[i].ctx);
+    }
+}
+
+#if NVS_BENCH
+void NVS::benchReads(uint32_t iterations) {
+    if (!iterations) return;
+    volatile bool sink = false;
+    (void)GetBool(DEVICE_CONFIGURED, false);   // warm the entry
+
+    uint32_t t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < iterations; ++i) sink = GetBool(DEVICE_CONFIGURED, false);
+    const uint32_t byKey = (ESP.getCycleCount() - t0) / iterations;
+
+    t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < iterations; ++i) sink = get<Cfg::DeviceConfigured>();
+    const uint32_t byId = (ESP.getCycleCount() - t0) / iterations;
+
+    lock_();
+    ensureOpenRO_();
+    t0 = ESP.getCycleCount();
+    for (uint32_t i = 0; i < iterations; ++i) sink = preferences.getBool(DEVICE_CONFIGURED, false);
+    const uint32_t flash = (ESP.getCycleCount() - t0) / iterations;
+    unlock_();
+    (void)sink;
+
+    DBG_PRINTF("[NVS][bench] cycles/read: Preferences=%lu key=%lu id=%lu\n",
+               (unsigned long)flash, (unsigned long)byKey, (unsigned long)byId);
+}
+#endif
+
+void NVS::flushLocked_() {
+    bool wrote = false;
+    for (size_t i = 0; i < s_entryCount_; ++i) {
+        if (s_entries_[i].dirty) {
+            commit_(s_entries_[i]);
+            wrote = true;
+        }
+    }
+    if (wrote) cacheStats_.flushes++;
+}
+
+void NVS::Flush() {
+    lock_();
+    flushLocked_();
+    unlock_();
+}
+
+// First deferred write wakes it; it waits out the window so a burst of
+// writes lands in one pass.
+void NVS::flusherTask_(void* arg) {
+    NVS* self = static_cast<NVS*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(NVS_FLUSH_DELAY_MS));
+        (void)ulTaskNotifyTake(pdTRUE, 0);
+        self->Flush();
+    }
 }
 
 
@@ -435,6 +843,7 @@ void NVS::CountdownDelay(unsigned long delayTime) {
 }
 
 void NVS::simulatePowerDown() {
+    Flush();
     esp_sleep_enable_timer_wakeup(1000000); // 1s
     esp_deep_sleep_start();
 }
@@ -20,14 +20,45 @@
  * After these changes:
  *   NVS::Get()->begin();
  *   CONF->PutBool(...);
+ *
+ * Write-back cache: every key from ConfigNvs.hpp has a RAM shadow. Scalar
+ * reads are plain memory loads after the first miss; writes that change
+ * the value mark the key dirty and a flusher task commits the batch after
+ * NVS_FLUSH_DELAY_MS. Critical keys (lock/armed/breach/configured/reset)
+ * commit at once, together with anything dirty before them. Flush() is
+ * called before deep sleep and reboot.
+ *
+ * Typed access (ConfigRegistry.hpp): get<Cfg::X>() / set<Cfg::X>() index
+ * the cache directly; subscribe() delivers change notifications so modules
+ * can keep their own copy instead of polling.
  */
 
 #include <Arduino.h>
+#include <ConfigRegistry.hpp>
 #include <Preferences.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 
+#ifndef NVS_FLUSH_DELAY_MS
+#define NVS_FLUSH_DELAY_MS      2000   // coalescing window for deferred keys
+#endif
+#ifndef NVS_FLUSH_TASK_STACK
+#define NVS_FLUSH_TASK_STACK    3072
+#endif
+#ifndef NVS_FLUSH_TASK_PRIO
+#define NVS_FLUSH_TASK_PRIO     1
+#endif
+#ifndef NVS_MAX_LISTENERS
+#define NVS_MAX_LISTENERS       8
+#endif
+#ifndef NVS_SNAPSHOT_STR_BYTES
+#define NVS_SNAPSHOT_STR_BYTES  256    // string pool of a warm-sleep snapshot
+#endif
+#ifndef NVS_BENCH
+#define NVS_BENCH               0      // 1 = benchReads() available (cycle counts)
+#endif
+
 class NVS {
 public:
     // -----------------------------------------------------------------
@@ -63,6 +94,7 @@ public:
     void PutString   (const char* key, const String& value);
     void PutUInt     (const char* key, int value);
     void PutULong64  (const char* key, int value);
+    void PutBytes    (const char* key, const void* data, size_t len);
 
     // -----------------------------------------------------------------
     // Reads (auto-open RO)
@@ -72,6 +104,7 @@ public:
     uint64_t GetULong64 (const char* key, int defaultValue);
     float    GetFloat   (const char* key, float defaultValue);
     String   GetString  (const char* key, const String& defaultValue);
+    size_t   GetBytes   (const char* key, void* out, size_t maxLen);  // 0 = missing/too large
 
     // -----------------------------------------------------------------
     // Keys / maintenance
@@ -79,6 +112,56 @@ public:
     void RemoveKey(const char* key);
     void ClearKey();
 
+    // -----------------------------------------------------------------
+    // Write-back cache
+    // -----------------------------------------------------------------
+    void Flush();   // commit every dirty cached key now (sleep/reboot hook)
+
+    struct CacheStats {
+        uint32_t hits      = 0;   // reads served from RAM
+        uint32_t misses    = 0;   // first read of a cached key (NVS load)
+        uint32_t deferred  = 0;   // writes left for the flusher
+        uint32_t unchanged = 0;   // writes skipped (same value)
+        uint32_t commits   = 0;   // keys written to flash
+        uint32_t flushes   = 0;   // Flush() passes that wrote something
+        uint32_t warm      = 0;   // keys seeded from a warm-sleep snapshot
+    };
+    const CacheStats& cacheStats() const { return cacheStats_; }
+
+    // -----------------------------------------------------------------
+    // Typed registry (O(1), no key strings)
+    // -----------------------------------------------------------------
+    template <Cfg K>
+    CfgType<K> get() { return read_(entry_(K), CfgType<K>(CfgDefault<K>::value)); }
+
+    template <Cfg K>
+    void set(const CfgType<K>& value) { write_(entry_(K), value); }
+
+    // Called from the writer's task after a value changed (not on same-value
+    // writes). Keep it short; it must not block.
+    using CfgListener = void (*)(Cfg id, void* ctx);
+    bool subscribe(CfgListener fn, void* ctx, uint64_t mask = kCfgAll);
+
+    // -----------------------------------------------------------------
+    // Warm-sleep snapshot (WarmState.hpp)
+    // -----------------------------------------------------------------
+    // Image of the RAM cache kept in RTC memory across deep sleep. Taken
+    // after Flush(), so it matches flash; importing it before begin() lets
+    // a warm wake run without reading config from flash.
+    struct Snapshot {
+        uint64_t captured;                          // cfgBit() per exported entry
+        uint64_t present;
+        uint64_t value[static_cast<size_t>(Cfg::Count)];   // scalar bits
+        char     strPool[NVS_SNAPSHOT_STR_BYTES];   // Str entries, Cfg order, NUL separated
+    };
+    void   exportSnapshot(Snapshot& out);
+    size_t importSnapshot(const Snapshot& in);     // returns entries seeded
+
+#if NVS_BENCH
+    // Average CPU cycles per read: string-keyed GetBool vs get<>().
+    void benchReads(uint32_t iterations = 1000);
+#endif
+
     // -----------------------------------------------------------------
     // System helpers (reboot, countdown, powerdown)
     // -----------------------------------------------------------------
@@ -118,6 +201,54 @@ private:
 
     static inline void sleepMs_(uint32_t ms);
 
+    // -----------------------------------------------------------------
+    // Write-back cache internals
+    // -----------------------------------------------------------------
+    using Kind = cfg::Kind;
+    struct Entry {
+        const char*       key;
+        Kind              kind;
+        bool              critical;
+        volatile bool     loaded  = false;
+        volatile bool     present = false;   // key exists (else caller default)
+        volatile bool     dirty   = false;
+        volatile uint32_t v32     = 0;       // Bool/Int/UInt/Float bits
+        uint64_t          v64     = 0;       // U64 (guarded by cacheMux_)
+        String            str;               // Str (guarded by mutex_)
+    };
+    static constexpr size_t s_entryCount_ = static_cast<size_t>(Cfg::Count);
+    static Entry s_entries_[s_entryCount_];   // Cfg order
+
+    Entry* cached_(const char* key, Kind kind);   // loaded entry or nullptr
+    Entry& entry_(Cfg id);                        // loaded entry
+    void   load_(Entry& e);
+    void   commit_(Entry& e);
+    void   markDirty_(Entry& e);
+    bool   put32_(Entry& e, uint32_t bits);       // true = value changed
+    void   flushLocked_();
+    static void flusherTask_(void* arg);
+
+    bool     read_(Entry& e, bool def)            { return e.present ? (e.v32 != 0) : def; }
+    int      read_(Entry& e, int def)             { return e.present ? static_cast<int>(e.v32) : def; }
+    uint32_t read_(Entry& e, uint32_t def)        { return e.present ? uint32_t(e.v32) : def; }
+    uint64_t read_(Entry& e, uint64_t def);
+    float    read_(Entry& e, float def);
+    String   read_(Entry& e, const String& def);
+
+    void     write_(Entry& e, bool value)         { if (put32_(e, value ? 1u : 0u)) notify_(e); }
+    void     write_(Entry& e, int value)          { if (put32_(e, static_cast<uint32_t>(value))) notify_(e); }
+    void     write_(Entry& e, uint32_t value)     { if (put32_(e, value)) notify_(e); }
+    void     write_(Entry& e, uint64_t value);
+    void     write_(Entry& e, float value);
+    void     write_(Entry& e, const String& value);
+    void     notify_(const Entry& e);
+
+    struct Listener {
+        CfgListener fn;
+        void*       ctx;
+        uint64_t    mask;
+    };
+
     // -----------------------------------------------------------------
     // NVS state
     // -----------------------------------------------------------------
@@ -129,6 +260,12 @@ private:
 
     // Recursive mutex so nested Put*/RemoveKey() etc. are safe
     SemaphoreHandle_t mutex_ = nullptr;
+
+    portMUX_TYPE  cacheMux_  = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t  flusher_   = nullptr;
+    CacheStats    cacheStats_;
+    Listener      listeners_[NVS_MAX_LISTENERS] = {};
+    uint8_t       listenerCount_ = 0;
 };
 
 // -----------------------------------------------------------------
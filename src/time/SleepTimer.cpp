@@ -124,29 +124,25 @@ void SleepTimer::goToSleep() {
     portEXIT_CRITICAL(&mux);
 
     const bool deviceConfigured =
-        (CONF && CONF->GetBool(DEVICE_CONFIGURED, false));
+        (CONF && CONF->get<Cfg::DeviceConfigured>());
 
     const bool hasReed =
         IS_SLAVE_ALARM ? true
-                       : (CONF && CONF->GetBool(HAS_REED_SWITCH_KEY,
-                                                HAS_REED_SWITCH_DEFAULT));
+                       : (CONF && CONF->get<Cfg::HasReedSwitch>());
 
     const bool hasOpenBtn =
         (!IS_SLAVE_ALARM &&
          (deviceConfigured
-            ? (CONF && CONF->GetBool(HAS_OPEN_SWITCH_KEY,
-                                     HAS_OPEN_SWITCH_DEFAULT))
+            ? (CONF && CONF->get<Cfg::HasOpenSwitch>())
             : true));
 
     const bool hasShock =
         IS_SLAVE_ALARM
             ? (deviceConfigured
-                   ? (CONF && CONF->GetBool(HAS_SHOCK_SENSOR_KEY,
-                                            HAS_SHOCK_SENSOR_DEFAULT))
+                   ? (CONF && CONF->get<Cfg::HasShockSensor>())
                    : true)
             : (deviceConfigured &&
-               CONF && CONF->GetBool(HAS_SHOCK_SENSOR_KEY,
-                                     HAS_SHOCK_SENSOR_DEFAULT));
+               CONF && CONF->get<Cfg::HasShockSensor>());
 
     // If reed exists and door is OPEN → don't sleep; reset timer
     if (hasReed) {
@@ -224,10 +220,10 @@ void SleepTimer::goToSleep() {
     bool shockActiveLow = true;
     if (deviceConfigured && hasShock && CONF) {
         const int type =
-            CONF->GetInt(SHOCK_SENSOR_TYPE_KEY, SHOCK_SENSOR_TYPE_DEFAULT);
+            CONF->get<Cfg::ShockType>();
         if (type == SHOCK_SENSOR_TYPE_INTERNAL) {
             const int lvl =
-                CONF->GetInt(SHOCK_L2D_INT_LVL_KEY, SHOCK_L2D_INT_LVL_DEFAULT);
+                CONF->get<Cfg::ShockIntLevel>();
             shockActiveLow = (lvl != 0);
         } else {
             shockActiveLow = true; // external is active-low
@@ -289,6 +285,10 @@ void SleepTimer::goToSleep() {
     }
     DBGSTP();
 
+    // Deferred NVS writes would be lost with RAM
+    if (CONF) CONF->Flush();
+    if (preSleepFn_) preSleepFn_(preSleepCtx_);
+
     DBGSTR();
     DBG_PRINTLN("[SLEEP] Entering deep sleep now…");
     DBGSTP();
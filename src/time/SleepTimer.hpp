@@ -57,6 +57,10 @@ public:
     // Enter deep sleep now (idempotent, guarded)
     void goToSleep();
 
+    // Runs last before esp_deep_sleep_start() (after the NVS flush).
+    using PreSleepHook = void (*)(void* ctx);
+    void setPreSleepHook(PreSleepHook fn, void* ctx) { preSleepFn_ = fn; preSleepCtx_ = ctx; }
+
     // Compatibility shim: previously started an RTOS task; now a no-op + warning
     void timerLoop();
 
@@ -81,6 +85,9 @@ private:
     // Soft rate-limit for prints (optional)
     uint32_t lastCheckPrintMs_ = 0;
 
+    PreSleepHook preSleepFn_  = nullptr;
+    void*        preSleepCtx_ = nullptr;
+
     // Lightweight spinlock so ISR path can safely bump the timestamp
     mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
 
@@ -12,6 +12,7 @@ void RGBLed::Init(int pinR, int pinG, int pinB, bool activeLow) {
   } else {
     s_instance->attachPins(pinR, pinG, pinB, activeLow);
   }
+  s_instance->createQueue_();
 }
 
 // Always return a valid pointer. If not initialized yet, create
@@ -64,22 +65,26 @@ void RGBLed::attachPins(int pinR, int pinG, int pinB, bool activeLow) {
 }
 
 // ---------------- Lifecycle ----------------
+bool RGBLed::createQueue_() {
+  if (!_mtx)   _mtx   = xSemaphoreCreateMutex();
+  if (!_queue) _queue = xQueueCreate(RGB_CMD_QUEUE_LEN, sizeof(Cmd));
+  return _mtx && _queue;
+}
+
+// The background starts as INIT (_bgState) unless a state was queued
+// before begin(); queued commands are not overridden.
 bool RGBLed::begin() {
+  if (_task) return true;
   if (_pinR < 0 || _pinG < 0 || _pinB < 0) return false;
   pinMode(_pinR, OUTPUT);
   pinMode(_pinG, OUTPUT);
   pinMode(_pinB, OUTPUT);
   writeColor(0,0,0);
 
-  _mtx = xSemaphoreCreateMutex();
-  _queue = xQueueCreate(RGB_CMD_QUEUE_LEN, sizeof(Cmd));
-  if (!_mtx || !_queue) return false;
+  if (!createQueue_()) return false;
 
   if (xTaskCreate(&RGBLed::taskThunk, "RGBLed", RGB_TASK_STACK, this,
                   RGB_TASK_PRIORITY, &_task) != pdPASS) return false;
-
-  // default background at startup
-  setDeviceState(DeviceState::INIT);
   return true;
 }
 
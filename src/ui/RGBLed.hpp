@@ -54,6 +54,8 @@ class RGBLed {
 public:
   // ---------------- Singleton access ----------------
   // Call once at boot to define pins; safe to call again to re-attach pins.
+  // Also creates the command queue, so commands posted before begin() are
+  // kept and played once the worker starts.
   static void     Init(int pinR, int pinG, int pinB, bool activeLow = true);
   // Always returns a valid pointer (auto-creates with unattached pins if no Init yet).
   static RGBLed*  Get();
@@ -61,7 +63,7 @@ public:
   static RGBLed*  TryGet();
 
   // ---------------- Lifecycle ----------------
-  // After Init(), call begin() once to start the worker.
+  // After Init(), call begin() once to start the worker (later calls are no-ops).
   bool begin();
   void end();
 
@@ -102,6 +104,7 @@ private:
   void writeColor(uint8_t r, uint8_t g, uint8_t b);
 
   // Helpers
+  bool createQueue_();
   bool sendCmd(const Cmd& c, TickType_t to = 0);
   void stepRainbow(uint16_t stepMs);
   void stepBlink(uint32_t color, uint16_t periodMs);
@@ -0,0 +1,73 @@
+// Cost of cmd::decodeCmd() per command on the host, next to the opcode
+// lookup alone and the linear table scan the compile-time index replaced.
+// Absolute numbers are host numbers; the ratio is what carries over.
+// On target, cmdStats().decodeLastCycles/decodeMaxCycles measure the same
+// path in CPU cycles.
+#include <CmdDecode.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+volatile uint32_t g_sink;
+
+const cmd::CmdDesc* linearFind(uint16_t opcode) {
+  for (const cmd::CmdDesc& d : cmd::kCmds) {
+    if (d.opcode == opcode) return &d;
+  }
+  return nullptr;
+}
+
+template <typename Fn>
+double nsPerOp(size_t ops, Fn&& fn) {
+  using clock = std::chrono::steady_clock;
+  fn(ops / 10);   // warm-up
+  const auto t0 = clock::now();
+  fn(ops);
+  const auto t1 = clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / double(ops);
+}
+
+}  // namespace
+
+int main() {
+  // Every table opcode once, plus unknown ones at the same rate as in a
+  // noisy link (one in eight).
+  std::vector<uint16_t> mix;
+  for (const cmd::CmdDesc& d : cmd::kCmds) mix.push_back(d.opcode);
+  for (size_t i = 0; i < cmd::kCmdCount / 8 + 1; ++i) mix.push_back(uint16_t(0xF0 + i));
+  const uint8_t payload[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  cmd::CmdContext ctx;
+  ctx.capBits = 0x05;
+  const size_t kOps = 20000000;
+
+  const double tIndex = nsPerOp(kOps, [&](size_t n) {
+    uint32_t acc = 0;
+    for (size_t i = 0, k = 0; i < n; ++i, k = (k + 1 == mix.size()) ? 0 : k + 1) {
+      acc += cmd::findCmd(mix[k]) != nullptr;
+    }
+    g_sink = acc;
+  });
+  const double tLinear = nsPerOp(kOps, [&](size_t n) {
+    uint32_t acc = 0;
+    for (size_t i = 0, k = 0; i < n; ++i, k = (k + 1 == mix.size()) ? 0 : k + 1) {
+      acc += linearFind(mix[k]) != nullptr;
+    }
+    g_sink = acc;
+  });
+  const double tDecode = nsPerOp(kOps, [&](size_t n) {
+    uint32_t acc = 0;
+    for (size_t i = 0, k = 0; i < n; ++i, k = (k + 1 == mix.size()) ? 0 : k + 1) {
+      const cmd::CmdDecoded d = cmd::decodeCmd(mix[k], payload, sizeof(payload), ctx);
+      acc += uint32_t(d.verdict) + d.n;
+    }
+    g_sink = acc;
+  });
+
+  std::printf("  %zu rows, %zu-opcode mix\n", cmd::kCmdCount, mix.size());
+  std::printf("  lookup  (index)       %6.2f ns/op\n", tIndex);
+  std::printf("  lookup  (linear scan) %6.2f ns/op  (%.1fx)\n", tLinear, tLinear / tIndex);
+  std::printf("  decodeCmd (full)      %6.2f ns/op\n", tDecode);
+  return 0;
+}
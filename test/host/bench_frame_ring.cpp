@@ -0,0 +1,191 @@
+// FrameRing (the RX/TX queues of TransportPort) against the queues it
+// replaced: std::vector<TransportMessage> with push_back() to enqueue and
+// front() + erase(begin()) to dequeue, each message owning a heap payload.
+// Both sides do what the port does per frame: copy header + payload in, then
+// read the oldest frame out. Reported per enqueue+dequeue pair, at a steady
+// queue depth, with the heap it costs (global operator new is counted).
+// FrameRing::push() also stamps millis()/micros() for the dispatch latency
+// stats, and on the host those two clock reads are most of its time; the
+// header line prints their cost. Host malloc is cheap next to the target
+// heap (locked, fragmenting), so the vector times are a floor; the
+// allocation and peak-heap columns carry over as they are.
+#include <Transport.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// ---------- Heap accounting ----------
+namespace heap {
+size_t live  = 0;
+size_t peak  = 0;
+size_t calls = 0;
+void reset() { peak = live; calls = 0; }
+}  // namespace heap
+
+namespace {
+constexpr size_t kHeapHdr = alignof(std::max_align_t);
+
+void* countedAlloc(size_t n) {
+  void* p = std::malloc(n + kHeapHdr);
+  if (!p) throw std::bad_alloc();
+  *static_cast<size_t*>(p) = n;
+  heap::live += n;
+  ++heap::calls;
+  if (heap::live > heap::peak) heap::peak = heap::live;
+  return static_cast<char*>(p) + kHeapHdr;
+}
+
+void countedFree(void* p) {
+  if (!p) return;
+  char* base = static_cast<char*>(p) - kHeapHdr;
+  heap::live -= *reinterpret_cast<size_t*>(base);
+  std::free(base);
+}
+}  // namespace
+
+void* operator new(size_t n)                 { return countedAlloc(n); }
+void* operator new[](size_t n)               { return countedAlloc(n); }
+void  operator delete(void* p) noexcept      { countedFree(p); }
+void  operator delete[](void* p) noexcept    { countedFree(p); }
+void  operator delete(void* p, size_t) noexcept   { countedFree(p); }
+void  operator delete[](void* p, size_t) noexcept { countedFree(p); }
+
+namespace {
+
+using transport::FrameRing;
+using transport::FrameSlot;
+using transport::Header;
+using transport::TransportMessage;
+
+volatile uint32_t g_sink;
+
+// The pre-ring queue, as TransportPort used it.
+class VectorQueue {
+public:
+  bool push(const Header& h, const uint8_t* payload, size_t len) {
+    TransportMessage msg;
+    msg.header = h;
+    msg.header.payloadLen = static_cast<uint8_t>(len);
+    msg.payload.assign(payload, payload + len);
+    q_.push_back(msg);
+    return true;
+  }
+  uint32_t pop() {
+    TransportMessage msg;
+    msg = q_.front();
+    q_.erase(q_.begin());
+    return msg.header.msgId + msg.payload[0];
+  }
+
+private:
+  std::vector<TransportMessage> q_;
+};
+
+template <size_t N>
+class RingQueue {
+public:
+  bool push(const Header& h, const uint8_t* payload, size_t len) {
+    return ring_.push(h, payload, len) != nullptr;
+  }
+  uint32_t pop() {
+    const FrameSlot& s = ring_.front();
+    const uint32_t v = s.header.msgId + s.payload[0];
+    ring_.pop();
+    return v;
+  }
+
+private:
+  FrameRing<N> ring_;
+};
+
+struct Result {
+  double ns;
+  size_t peakHeap;
+  double allocsPerFrame;
+};
+
+// `depth` frames stay queued; each op pushes one and pops the oldest.
+template <typename Q>
+Result run(size_t depth, size_t len, size_t ops) {
+  uint8_t payload[transport::kMaxPayloadBytes];
+  for (size_t i = 0; i < sizeof(payload); ++i) payload[i] = uint8_t(i);
+  Header h;
+  h.srcId = 1;
+  h.destId = 2;
+
+  heap::reset();
+  const size_t base = heap::live;
+  Result r{};
+  {
+    Q* q = new Q;   // FrameRing<16> is ~3 KB: off the stack, counted once
+    for (size_t i = 0; i < depth; ++i) q->push(h, payload, len);
+    const size_t callsBefore = heap::calls;
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    uint32_t acc = 0;
+    for (size_t i = 0; i < ops; ++i) {
+      h.msgId = uint16_t(i);
+      q->push(h, payload, len);
+      acc += q->pop();
+    }
+    const auto t1 = clock::now();
+    g_sink = acc;
+    r.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / double(ops);
+    r.allocsPerFrame = double(heap::calls - callsBefore) / double(ops);
+    r.peakHeap = heap::peak - base;
+    delete q;
+  }
+  return r;
+}
+
+constexpr size_t kSlots = TRANSPORT_RX_QUEUE_SLOTS;
+
+constexpr size_t kOps  = 1000000;
+constexpr int    kReps = 5;   // best of, against host frequency noise
+
+double stampNs() {
+  using clock = std::chrono::steady_clock;
+  double best = 1e9;
+  for (int rep = 0; rep < kReps; ++rep) {
+    uint32_t acc = 0;
+    const auto t0 = clock::now();
+    for (size_t i = 0; i < kOps; ++i) acc += millis() + micros();
+    const auto t1 = clock::now();
+    g_sink = acc;
+    best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / double(kOps));
+  }
+  return best;
+}
+
+template <typename Q>
+Result best(size_t depth, size_t len) {
+  Result r = run<Q>(depth, len, kOps);
+  for (int rep = 1; rep < kReps; ++rep) r.ns = std::min(r.ns, run<Q>(depth, len, kOps).ns);
+  return r;
+}
+
+void row(size_t depth, size_t len) {
+  const Result v = best<VectorQueue>(depth, len);
+  const Result r = best<RingQueue<kSlots>>(depth, len);
+  std::printf("  %5zu %5zu   %7.1f %7.1f   %6zu %7zu   %5.1f %5.1f\n", depth, len, v.ns, r.ns,
+              v.peakHeap, r.peakHeap, v.allocsPerFrame, r.allocsPerFrame);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("  FrameRing<%zu>: %zu B static, slot %zu B; push() timestamps %.1f ns\n", kSlots,
+              sizeof(FrameRing<kSlots>), sizeof(FrameSlot), stampNs());
+  std::printf("  %5s %5s   %7s %7s   %6s %7s   %5s %5s\n", "depth", "len", "vec ns", "ring ns",
+              "vec pk", "ring pk", "v new", "r new");
+  const size_t lens[] = {8, 64, transport::kMaxPayloadBytes};
+  const size_t depths[] = {0, 8, kSlots - 1};
+  for (size_t d : depths) {
+    for (size_t len : lens) row(d, len);
+  }
+  std::printf("  (pk = peak heap in bytes incl. the queue object; new = heap allocations per frame)\n");
+  return 0;
+}
@@ -0,0 +1,154 @@
+// Loopback latency from the radio callback to a module handler: a stub
+// EspNowManager (shim/ESPNOWManager.hpp) stands in for the radio, frames go
+// into TransportManager::onRadioReceive() and the transport task dispatches
+// them under the handler lock, as on target. A second thread plays
+// Device::loop() with that lock held either for the whole pass (the old
+// loop) or for its state sections only (the boot stage, sleep timer and
+// service calls run unlocked).
+//
+// The loop timeline is compressed (10 ms period instead of 300 ms) so a
+// short run sees many collisions; absolute numbers are host numbers.
+#include <TransportManager.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_t_ = std::chrono::steady_clock;
+
+constexpr uint32_t kFrames        = 3000;
+constexpr uint32_t kGapMinUs      = 300;    // between frames, uniform
+constexpr uint32_t kGapMaxUs      = 1500;
+constexpr uint32_t kStateUs       = 150;    // reset check + config/power/inputs
+constexpr uint32_t kUnlockedUs    = 3000;   // boot stage, sleep timer, service calls
+constexpr uint32_t kLoopPeriodMs  = 10;     // MAIN_LOOP_DELAY_MS, compressed
+
+enum class LoopMode { None, WholePass, StateOnly };
+
+uint64_t nowNs() {
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      clock_t_::now().time_since_epoch()).count());
+}
+
+void spinUs(uint32_t us) {
+  const auto end = clock_t_::now() + std::chrono::microseconds(us);
+  while (clock_t_::now() < end) {}
+}
+
+class StampHandler : public transport::TransportHandler {
+public:
+  explicit StampHandler(std::vector<uint32_t>& out) : out_(out) {}
+  void onMessageView(const transport::TransportMessageView& v) override {
+    uint64_t sent = 0;
+    if (v.payload.size() < sizeof(sent)) return;
+    memcpy(&sent, v.payload.data(), sizeof(sent));
+    out_.push_back(uint32_t((nowNs() - sent) / 1000));
+    done.fetch_add(1, std::memory_order_release);
+  }
+  std::atomic<uint32_t> done{0};
+
+private:
+  std::vector<uint32_t>& out_;
+};
+
+// One Device::loop() pass per period. Taking the lock the transport
+// handlers take is the only thing that matters here, so the work is spins
+// (CPU-bound state code) and sleeps (blocking bus/flash calls).
+void loopThread(SemaphoreHandle_t lock, LoopMode mode, const std::atomic<bool>& stop) {
+  while (!stop.load(std::memory_order_acquire)) {
+    const auto next = clock_t_::now() + std::chrono::milliseconds(kLoopPeriodMs);
+    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+    spinUs(kStateUs);
+    if (mode == LoopMode::StateOnly) xSemaphoreGiveRecursive(lock);
+    std::this_thread::sleep_for(std::chrono::microseconds(kUnlockedUs));
+    if (mode == LoopMode::WholePass) xSemaphoreGiveRecursive(lock);
+    std::this_thread::sleep_until(next);
+  }
+}
+
+struct Result {
+  uint32_t p50, p90, p99, max;
+  uint32_t over1ms;
+  uint32_t got;
+};
+
+Result run(LoopMode mode) {
+  EspNowManager now;
+  NVS nvs;
+  TransportManager tm(2, &now, &nvs);
+  SemaphoreHandle_t lock = xSemaphoreCreateRecursiveMutex();
+  tm.setHandlerLock(lock);
+
+  std::vector<uint32_t> lat;
+  lat.reserve(kFrames);
+  StampHandler h(lat);
+  tm.port().registerHandler(transport::Module::Device, &h);
+  tm.begin();
+
+  std::atomic<bool> stop{false};
+  std::thread loop;
+  if (mode != LoopMode::None) loop = std::thread(loopThread, lock, mode, std::cref(stop));
+
+  std::mt19937 rng(0x10AD);
+  std::uniform_int_distribution<uint32_t> gap(kGapMinUs, kGapMaxUs);
+  std::vector<uint8_t> frame;
+  transport::Header hd;
+  hd.srcId  = 1;
+  hd.destId = 2;
+  hd.module = uint8_t(transport::Module::Device);
+  hd.type   = uint8_t(transport::MessageType::Event);
+  hd.opCode = 0x01;
+  hd.payloadLen = sizeof(uint64_t);
+  for (uint32_t i = 0; i < kFrames; ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(gap(rng)));
+    hd.msgId = uint16_t(i + 1);
+    const uint64_t t = nowNs();
+    if (!transport::Serializer::encode(hd, reinterpret_cast<const uint8_t*>(&t), sizeof(t), frame)) {
+      break;
+    }
+    tm.onRadioReceive(frame.data(), frame.size());
+  }
+  const auto deadline = clock_t_::now() + std::chrono::seconds(2);
+  while (h.done.load(std::memory_order_acquire) < kFrames && clock_t_::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  stop.store(true, std::memory_order_release);
+  if (loop.joinable()) loop.join();
+  tm.stop();
+
+  Result r{};
+  r.got = h.done.load(std::memory_order_acquire);
+  std::vector<uint32_t> s(lat.begin(), lat.begin() + r.got);
+  std::sort(s.begin(), s.end());
+  if (s.empty()) return r;
+  r.p50 = s[s.size() / 2];
+  r.p90 = s[s.size() * 9 / 10];
+  r.p99 = s[s.size() * 99 / 100];
+  r.max = s.back();
+  r.over1ms = uint32_t(std::count_if(s.begin(), s.end(), [](uint32_t us) { return us > 1000; }));
+  return r;
+}
+
+void print(const char* name, const Result& r) {
+  std::printf("  %-22s %6u %6u %6u %7u   %5.1f%%   %u/%u\n", name, r.p50, r.p90, r.p99, r.max,
+              r.got ? 100.0 * r.over1ms / r.got : 0.0, r.got, kFrames);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("  loop: %u us locked state + %u us blocking work every %u ms\n",
+              kStateUs, kUnlockedUs, kLoopPeriodMs);
+  std::printf("  %-22s %6s %6s %6s %7s   %6s   %s\n", "rx -> handler (us)", "p50", "p90",
+              "p99", "max", ">1ms", "frames");
+  print("no loop", run(LoopMode::None));
+  print("lock whole pass", run(LoopMode::WholePass));
+  print("lock state sections", run(LoopMode::StateOnly));
+  return 0;
+}
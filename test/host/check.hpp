@@ -0,0 +1,36 @@
+// Minimal assertions for the host harnesses: report every failure and keep
+// going; summary() gives the exit status.
+#pragma once
+#include <cstdio>
+
+namespace check {
+inline int& failures() { static int n = 0; return n; }
+// Printed with each failure (e.g. the loop iteration under test).
+inline char* context() { static char buf[96] = ""; return buf; }
+inline int  summary(const char* name) {
+  if (failures()) std::printf("%s: %d check(s) FAILED\n", name, failures());
+  else            std::printf("%s: all checks passed\n", name);
+  return failures() ? 1 : 0;
+}
+}  // namespace check
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::printf("  FAIL %s:%d: %s %s\n", __FILE__, __LINE__, #cond,         \
+                  check::context());                                           \
+      ++check::failures();                                                     \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+  do {                                                                         \
+    const auto va_ = (a);                                                      \
+    const auto vb_ = (b);                                                      \
+    if (!(va_ == vb_)) {                                                       \
+      std::printf("  FAIL %s:%d: %s == %s (%lld vs %lld) %s\n", __FILE__,     \
+                  __LINE__, #a, #b, (long long)va_, (long long)vb_,            \
+                  check::context());                                           \
+      ++check::failures();                                                     \
+    }                                                                          \
+  } while (0)
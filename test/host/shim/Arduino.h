@@ -0,0 +1,24 @@
+// Host build of the Arduino core subset the harnesses touch.
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+inline uint32_t micros() {
+  using namespace std::chrono;
+  static const auto t0 = steady_clock::now();
+  return static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now() - t0).count());
+}
+inline uint32_t millis() { return micros() / 1000; }
+inline void delay(uint32_t) {}
+
+// ESP.getCycleCount(): nanoseconds on the host.
+struct EspClass {
+  uint32_t getCycleCount() const {
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+};
+inline EspClass ESP;
@@ -0,0 +1,2 @@
+// Host build: no NVS keys are read by the modules built here.
+#pragma once
@@ -0,0 +1,39 @@
+// Host build: the EspNowManager surface EspNowAdapter/TransportManager call.
+// Nothing reaches a radio; sends count and succeed. A harness plays the
+// radio by feeding frames to TransportManager::onRadioReceive() itself.
+#pragma once
+#include <esp_err.h>
+#include <Transport.hpp>
+
+#define ESPNOW_MAX_DATA_LEN          250
+
+class EspNowManager {
+public:
+  struct PeerIdentity {
+    bool    valid   = false;
+    uint8_t mac[6]  = {0};
+    uint8_t channel = 0;
+    bool    hasLmk  = false;
+    uint8_t lmk[16] = {0};
+    uint8_t wire    = 0;
+  };
+  bool masterIdentity(PeerIdentity& out) {
+    out = PeerIdentity();
+    out.valid = true;
+    memcpy(out.mac, kMasterMac, 6);
+    return true;
+  }
+  bool standbyIdentity(PeerIdentity& out) { out = PeerIdentity(); return false; }
+
+  esp_err_t registerPeer(const uint8_t*, bool, const uint8_t* = nullptr) { return ESP_OK; }
+  esp_err_t unregisterPeer(const uint8_t*) { return ESP_OK; }
+  esp_err_t sendData(const uint8_t*, const uint8_t*, size_t) { ++sent; return ESP_OK; }
+  bool queueBroadcast(const uint8_t*, size_t) { ++sent; return true; }
+  bool queueTransport(const uint8_t*, size_t) { ++sent; return true; }
+  bool nativeWire() { return true; }
+  bool handleTransportTx(const transport::TransportMessage&) { return false; }
+  void journalOffline(const transport::TransportMessage&) {}
+
+  static constexpr uint8_t kMasterMac[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+  uint32_t sent = 0;
+};
@@ -0,0 +1,3 @@
+// Host build: TransportManager only stores the pointer.
+#pragma once
+class NVS {};
@@ -0,0 +1,7 @@
+// Host build: debug output compiled out, as with a release firmware.
+// DBG_PRINTF arguments are still type-checked (and count as used).
+#pragma once
+#include <cstdio>
+#define DBG_PRINT(...)     do{}while(0)
+#define DBG_PRINTLN(...)   do{}while(0)
+#define DBG_PRINTF(...)    do{ if (0) std::printf(__VA_ARGS__); }while(0)
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstdint>
+#include <random>
+inline uint32_t esp_random() {
+  static thread_local std::mt19937 rng(0x5EED);
+  return rng();
+}
@@ -0,0 +1,73 @@
+#include <esp_partition.h>
+#include <fake_flash.hpp>
+#include <cstring>
+
+namespace fakeflash {
+namespace {
+constexpr size_t kSector = 4096;
+std::vector<uint8_t> g_image;
+esp_partition_t      g_part = {ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, 0, 0, "journal", false};
+long                 g_budget = -1;
+Counters             g_counters;
+
+// Bytes the current operation may still touch before the cut.
+size_t allowance(size_t len) {
+  if (g_budget < 0 || static_cast<size_t>(g_budget) >= len) {
+    if (g_budget >= 0) g_budget -= static_cast<long>(len);
+    return len;
+  }
+  const size_t n = static_cast<size_t>(g_budget);
+  g_budget = 0;
+  return n;
+}
+}  // namespace
+
+void reset(size_t size) {
+  g_image.assign(size, 0xFF);
+  g_part.size = static_cast<uint32_t>(size);
+  g_budget = -1;
+  g_counters = Counters();
+}
+std::vector<uint8_t>& image() { return g_image; }
+void armCut(long bytes) { g_budget = bytes; }
+Counters& counters() { return g_counters; }
+
+}  // namespace fakeflash
+
+using namespace fakeflash;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t, esp_partition_subtype_t,
+                                                const char* label) {
+  if (g_image.empty() || !label || strcmp(label, g_part.label) != 0) return nullptr;
+  return &g_part;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t off, void* dst, size_t len) {
+  if (p != &g_part || off + len > g_image.size()) return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, g_image.data() + off, len);
+  g_counters.bytesRead += len;
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t off, const void* src, size_t len) {
+  if (p != &g_part || off + len > g_image.size()) return ESP_ERR_INVALID_SIZE;
+  const size_t n = allowance(len);
+  const uint8_t* s = static_cast<const uint8_t*>(src);
+  for (size_t i = 0; i < n; ++i) g_image[off + i] &= s[i];   // NOR: 1 -> 0 only
+  g_counters.bytesWritten += n;
+  g_counters.writes++;
+  if (n < len) throw PowerCut();
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t off, size_t len) {
+  if (p != &g_part || off % kSector || len % kSector || off + len > g_image.size()) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const size_t n = allowance(len);
+  memset(g_image.data() + off, 0xFF, n);
+  g_counters.bytesErased += n;
+  g_counters.erases++;
+  if (n < len) throw PowerCut();
+  return ESP_OK;
+}
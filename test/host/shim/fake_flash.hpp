@@ -0,0 +1,29 @@
+// RAM flash behind the esp_partition_* shim.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fakeflash {
+
+// Thrown from a write or erase when the armed byte budget runs out. The
+// operation has then been applied up to that byte, as after a brown-out.
+struct PowerCut {};
+
+// (Re)creates the partition: `size` bytes, all 0xFF. size 0 = no partition.
+void reset(size_t size);
+std::vector<uint8_t>& image();
+
+// Cut power after `bytes` more programmed or erased bytes (-1 = never).
+void armCut(long bytes);
+
+struct Counters {
+  uint64_t bytesRead    = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t bytesErased  = 0;
+  uint32_t writes       = 0;
+  uint32_t erases       = 0;
+};
+Counters& counters();
+
+}  // namespace fakeflash
@@ -0,0 +1,28 @@
+// Host build of the FreeRTOS subset the harnesses touch. Tasks are threads
+// (freertos_host.cpp); 1 tick = 1 ms. Critical sections share one global
+// recursive lock, the way masking interrupts on a single core would.
+#pragma once
+#include <cstdint>
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdTRUE          1
+#define pdFALSE         0
+#define pdPASS          1
+#define portMAX_DELAY   0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) (ms)
+#define APP_CPU_NUM     1
+
+namespace hostrtos {
+void enterCritical();
+void exitCritical();
+}  // namespace hostrtos
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m)      ((void)(m), hostrtos::enterCritical())
+#define portEXIT_CRITICAL(m)       ((void)(m), hostrtos::exitCritical())
+#define portENTER_CRITICAL_ISR(m)  portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL_ISR(m)   portEXIT_CRITICAL(m)
+#define taskENTER_CRITICAL(m)      portENTER_CRITICAL(m)
+#define taskEXIT_CRITICAL(m)       portEXIT_CRITICAL(m)
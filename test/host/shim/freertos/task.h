@@ -0,0 +1,14 @@
+#pragma once
+#include <freertos/FreeRTOS.h>
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+// The thread runs fn(arg); *out is set before it starts. Stack, priority
+// and core are ignored.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* arg, UBaseType_t prio, TaskHandle_t* out,
+                                   BaseType_t core);
+void       xTaskNotifyGive(TaskHandle_t t);
+uint32_t   ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+// Only vTaskDelete(nullptr) at the end of a task: the thread ends when fn returns.
+void       vTaskDelete(TaskHandle_t t);
@@ -0,0 +1,138 @@
+// Threads, semaphores and critical sections behind the freertos/ shims.
+// Handles live until exit so a late give/notify never touches freed memory.
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::recursive_mutex g_critical;
+
+template <typename Pred>
+bool waitTicks(std::condition_variable& cv, std::unique_lock<std::mutex>& lk,
+               TickType_t ticks, Pred pred) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lk, pred);
+    return true;
+  }
+  return cv.wait_for(lk, std::chrono::milliseconds(ticks), pred);
+}
+
+}  // namespace
+
+struct HostSem {
+  std::mutex              m;
+  std::condition_variable cv;
+  unsigned                count = 0;
+  unsigned                max   = 1;
+  std::thread::id         owner;   // recursive mutex only
+  unsigned                depth = 0;
+};
+
+struct HostTask {
+  std::mutex              m;
+  std::condition_variable cv;
+  uint32_t                notify = 0;
+};
+
+namespace {
+
+std::mutex g_regMtx;
+std::vector<std::unique_ptr<HostSem>>  g_sems;
+std::vector<std::unique_ptr<HostTask>> g_tasks;
+thread_local HostTask* t_self = nullptr;
+
+HostSem* newSem(unsigned count) {
+  std::lock_guard<std::mutex> g(g_regMtx);
+  g_sems.emplace_back(new HostSem);
+  g_sems.back()->count = count;
+  return g_sems.back().get();
+}
+
+}  // namespace
+
+namespace hostrtos {
+void enterCritical() { g_critical.lock(); }
+void exitCritical()  { g_critical.unlock(); }
+}  // namespace hostrtos
+
+SemaphoreHandle_t xSemaphoreCreateMutex()          { return newSem(1); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return newSem(0); }
+SemaphoreHandle_t xSemaphoreCreateBinary()         { return newSem(0); }
+void vSemaphoreDelete(SemaphoreHandle_t) {}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+  std::unique_lock<std::mutex> lk(s->m);
+  if (!waitTicks(s->cv, lk, ticks, [s] { return s->count > 0; })) return pdFALSE;
+  --s->count;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  std::lock_guard<std::mutex> g(s->m);
+  if (s->count >= s->max) return pdFALSE;
+  ++s->count;
+  s->cv.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks) {
+  const std::thread::id self = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lk(s->m);
+  if (!waitTicks(s->cv, lk, ticks, [s, self] { return s->depth == 0 || s->owner == self; })) {
+    return pdFALSE;
+  }
+  s->owner = self;
+  ++s->depth;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s) {
+  std::lock_guard<std::mutex> g(s->m);
+  if (s->depth == 0 || s->owner != std::this_thread::get_id()) return pdFALSE;
+  if (--s->depth == 0) {
+    s->owner = std::thread::id();
+    s->cv.notify_one();
+  }
+  return pdTRUE;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* out, BaseType_t) {
+  HostTask* t;
+  {
+    std::lock_guard<std::mutex> g(g_regMtx);
+    g_tasks.emplace_back(new HostTask);
+    t = g_tasks.back().get();
+  }
+  if (out) *out = t;
+  std::thread([fn, arg, t] {
+    t_self = t;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+void xTaskNotifyGive(TaskHandle_t t) {
+  std::lock_guard<std::mutex> g(t->m);
+  ++t->notify;
+  t->cv.notify_one();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  HostTask* t = t_self;
+  if (!t) return 0;
+  std::unique_lock<std::mutex> lk(t->m);
+  waitTicks(t->cv, lk, ticks, [t] { return t->notify > 0; });
+  const uint32_t n = t->notify;
+  if (n) t->notify = clearOnExit ? 0 : n - 1;
+  return n;
+}
+
+void vTaskDelete(TaskHandle_t) {}
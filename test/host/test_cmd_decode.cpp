@@ -0,0 +1,167 @@
+// Fuzz of cmd::decodeCmd(): every opcode (and some past 0xFF), every
+// payload length up to 250 with random bytes, both roles, random cap
+// bits. Each result is checked against a linear scan of kCmds; payloads
+// are exact-size heap blocks so ASan flags any read past the end.
+#include <CmdDecode.hpp>
+#include <check.hpp>
+
+#include <memory>
+#include <random>
+
+namespace {
+
+using cmd::CmdArgs;
+using cmd::CmdRoute;
+using cmd::CmdVerdict;
+
+const cmd::CmdDesc* linearFind(uint16_t opcode) {
+  for (const cmd::CmdDesc& d : cmd::kCmds) {
+    if (d.opcode == opcode) return &d;
+  }
+  return nullptr;
+}
+
+uint8_t capBit(uint16_t opcode, bool& on) {
+  switch (opcode) {
+    case CMD_CAP_OPEN_ON:   on = true;  return 0x01;
+    case CMD_CAP_OPEN_OFF:  on = false; return 0x01;
+    case CMD_CAP_SHOCK_ON:  on = true;  return 0x02;
+    case CMD_CAP_SHOCK_OFF: on = false; return 0x02;
+    case CMD_CAP_REED_ON:   on = true;  return 0x04;
+    case CMD_CAP_REED_OFF:  on = false; return 0x04;
+    case CMD_CAP_FP_ON:     on = true;  return 0x08;
+    case CMD_CAP_FP_OFF:    on = false; return 0x08;
+  }
+  return 0;
+}
+
+void checkOne(uint16_t opcode, const uint8_t* payload, size_t len, const cmd::CmdContext& ctx) {
+  const cmd::CmdDecoded dec = cmd::decodeCmd(opcode, payload, len, ctx);
+  const cmd::CmdDesc* row = linearFind(opcode);
+  CHECK(dec.desc == row);
+  if (!row) {
+    CHECK(dec.verdict == CmdVerdict::Unknown);
+    return;
+  }
+  if ((row->flags & cmd::kCmdLockRole) && ctx.alarmRole) {
+    CHECK(dec.verdict == CmdVerdict::Policy);
+    return;
+  }
+  const size_t eff = payload ? len : 0;
+  if (eff < row->minLen || (ESPNOW_CMD_STRICT_LEN && eff > row->maxLen)) {
+    CHECK(dec.verdict == CmdVerdict::BadLen);
+    return;
+  }
+  CHECK(dec.verdict == CmdVerdict::Ok);
+  CHECK_EQ(dec.len, eff < row->maxLen ? eff : row->maxLen);
+  CHECK(dec.n <= ESPNOW_CMD_MAX_ARGS);
+  if (row->route == CmdRoute::Local) {
+    CHECK_EQ(dec.n, 0);
+    return;
+  }
+  switch (row->args) {
+    case CmdArgs::None:
+      CHECK_EQ(dec.n, 0);
+      break;
+    case CmdArgs::Copy:
+      CHECK_EQ(dec.n, row->minLen);
+      CHECK(memcmp(dec.args, payload, row->minLen) == 0);
+      break;
+    case CmdArgs::ByteOrZero:
+      CHECK_EQ(dec.n, 1);
+      CHECK_EQ(dec.args[0], eff ? payload[0] : 0);
+      break;
+    case CmdArgs::CapBits: {
+      bool on = false;
+      const uint8_t bit = capBit(opcode, on);
+      CHECK(bit != 0);
+      CHECK_EQ(dec.n, 1);
+      CHECK_EQ(dec.args[0] & uint8_t(~bit), ctx.capBits & uint8_t(~bit));
+      CHECK_EQ((dec.args[0] & bit) != 0, on);
+      break;
+    }
+    case CmdArgs::EmagKey:
+      CHECK_EQ(dec.n, 2);
+      CHECK_EQ(dec.args[0], 7);
+      CHECK_EQ(dec.args[1], row->arg);
+      break;
+  }
+}
+
+void fuzz() {
+  std::mt19937 rng(0xC0FFEE);
+  unsigned runs = 0;
+  for (uint16_t opcode = 0; opcode < 0x120; ++opcode) {
+    for (size_t len = 0; len <= 250; ++len) {
+      std::unique_ptr<uint8_t[]> buf(new uint8_t[len ? len : 1]);
+      for (size_t i = 0; i < len; ++i) buf[i] = uint8_t(rng());
+      for (int role = 0; role < 2; ++role) {
+        cmd::CmdContext ctx;
+        ctx.alarmRole = role != 0;
+        ctx.capBits   = uint8_t(rng() & 0x0F);
+        std::snprintf(check::context(), 96, "[op 0x%02X len %zu role %d]", opcode, len, role);
+        checkOne(opcode, len ? buf.get() : nullptr, len, ctx);
+        if (len) checkOne(opcode, buf.get(), len, ctx);
+        checkOne(opcode, nullptr, len, ctx);   // null payload counts as empty
+        runs += 3;
+      }
+    }
+  }
+  // Opcodes are 16-bit on the wire: anything past the one-byte index.
+  for (unsigned i = 0; i < 20000; ++i) {
+    const uint16_t opcode = uint16_t(rng());
+    uint8_t b[4] = {uint8_t(rng()), 0, 0, 0};
+    checkOne(opcode, b, sizeof(b), cmd::CmdContext());
+    ++runs;
+  }
+  check::context()[0] = '\0';
+  std::printf("  %u decodes fuzzed\n", runs);
+}
+
+// A few rows pinned by value, so a table edit that still passes the
+// generic checks shows up here.
+void pinned() {
+  cmd::CmdContext lock;
+  const uint8_t l2d[11] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  cmd::CmdDecoded d = cmd::decodeCmd(CMD_SET_SHOCK_L2D_CFG, l2d, sizeof(l2d), lock);
+  CHECK(d.verdict == CmdVerdict::Ok);
+  CHECK(d.desc->module == transport::Module::Shock);
+  CHECK_EQ(d.desc->op, 0x12);
+  CHECK_EQ(d.n, 11);
+  CHECK_EQ(d.args[10], 11);
+
+  d = cmd::decodeCmd(CMD_SET_SHOCK_L2D_CFG, l2d, 10, lock);
+  CHECK(d.verdict == CmdVerdict::BadLen);
+
+  d = cmd::decodeCmd(CMD_FORCE_UNLOCK, nullptr, 0, lock);
+  CHECK(d.verdict == CmdVerdict::Ok);
+  CHECK(d.desc->hook == cmd::CmdHook::ForceAck);
+  CHECK_EQ(d.desc->arg, 2);
+
+  cmd::CmdContext alarm;
+  alarm.alarmRole = true;
+  d = cmd::decodeCmd(CMD_FORCE_UNLOCK, nullptr, 0, alarm);
+  CHECK(d.verdict == CmdVerdict::Policy);
+
+  d = cmd::decodeCmd(CMD_SET_CHANNEL, l2d, 3, lock);
+  CHECK(d.verdict == CmdVerdict::Ok);
+  CHECK(d.desc->route == CmdRoute::Local);
+  CHECK_EQ(d.desc->ack, ACK_SET_CHANNEL);
+  CHECK_EQ(d.len, 1);
+
+  lock.capBits = 0x0F;
+  d = cmd::decodeCmd(CMD_CAP_SHOCK_OFF, nullptr, 0, lock);
+  CHECK_EQ(d.args[0], 0x0D);
+
+  d = cmd::decodeCmd(CMD_LOCK_EMAG_ON, nullptr, 0, lock);
+  CHECK_EQ(d.n, 2);
+  CHECK_EQ(d.args[1], 1);
+}
+
+}  // namespace
+
+int main() {
+  pinned();
+  fuzz();
+  return check::summary("test_cmd_decode");
+}
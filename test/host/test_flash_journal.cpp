@@ -0,0 +1,409 @@
+// FlashJournal on a RAM partition: recovery after a power cut at every byte
+// of a slot write and at every byte of a sector erase, ring wrap, ack
+// truncation and the forEachPending() cursor. Ends with the flash written
+// per record against the coalesced NVS blob the ring replaced.
+#include <FlashJournal.hpp>
+#include <JournalCodec.hpp>
+#include <fake_flash.hpp>
+#include <check.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr size_t   kSector  = 4096;
+constexpr size_t   kSectors = 3;                                   // smallest ring that wraps twice
+constexpr uint32_t kSlots   = kSectors * kSector / FlashJournal::kSlotSize;   // 384
+constexpr uint32_t kPerSec  = kSector / FlashJournal::kSlotSize;               // 128
+
+std::unique_ptr<FlashJournal> boot() {
+  std::unique_ptr<FlashJournal> j(new FlashJournal());
+  CHECK(j->begin());
+  return j;
+}
+
+bool collect(void* ctx, uint32_t seq, uint8_t, const uint8_t*, uint8_t) {
+  static_cast<std::vector<uint32_t>*>(ctx)->push_back(seq);
+  return true;
+}
+
+std::vector<uint32_t> pending(FlashJournal& j) {
+  std::vector<uint32_t> out;
+  uint32_t pos = FlashJournal::kFromOldest;
+  j.forEachPending(collect, &out, pos);
+  return out;
+}
+
+std::vector<uint32_t> range(uint32_t first, uint32_t last) {
+  std::vector<uint32_t> v;
+  for (uint32_t s = first; s <= last; ++s) v.push_back(s);
+  return v;
+}
+
+bool append(FlashJournal& j, uint32_t seq) {
+  const uint8_t f[3] = {uint8_t(seq), uint8_t(seq >> 8), 0x5A};
+  return j.append(seq, 1 + seq % 9, f, 1 + seq % 3);
+}
+
+void appendRange(FlashJournal& j, uint32_t first, uint32_t last) {
+  for (uint32_t s = first; s <= last; ++s) CHECK(append(j, s));
+}
+
+void setContext(const char* what, long at) {
+  std::snprintf(check::context(), 96, "[%s %ld]", what, at);
+}
+
+// ------------------------------------------------------------------
+
+void testRoundTrip() {
+  fakeflash::reset(kSectors * kSector);
+  auto j = boot();
+  CHECK_EQ(j->capacity(), kSlots);
+  appendRange(*j, 1, 10);
+  CHECK(j->ack(4));
+  CHECK(pending(*j) == range(5, 10));
+
+  // Fields survive, seq order is kept.
+  struct Seen { uint32_t seq; uint8_t type, len, f0; };
+  std::vector<Seen> seen;
+  uint32_t pos = FlashJournal::kFromOldest;
+  j->forEachPending([](void* ctx, uint32_t seq, uint8_t type, const uint8_t* f, uint8_t len) {
+    static_cast<std::vector<Seen>*>(ctx)->push_back({seq, type, len, f[0]});
+    return true;
+  }, &seen, pos);
+  CHECK_EQ(seen.size(), 6u);
+  for (const Seen& s : seen) {
+    CHECK_EQ(s.type, 1 + s.seq % 9);
+    CHECK_EQ(s.len, 1 + s.seq % 3);
+    CHECK_EQ(s.f0, uint8_t(s.seq));
+  }
+
+  auto r = boot();
+  CHECK_EQ(r->lastSeq(), 10u);
+  CHECK_EQ(r->ackedSeq(), 4u);
+  CHECK(pending(*r) == range(5, 10));
+  CHECK(append(*r, 11));
+  FlashJournal::Cursor c;
+  CHECK(r->cursor(c));
+  CHECK_EQ(c.head, 12u);   // 10 records + 1 ack + 1
+  CHECK_EQ(r->stats().erases, 0u);
+}
+
+// begin() takes the head from the highest stamp, wherever the ring wrapped.
+void testHeadSearchAfterWrap() {
+  fakeflash::reset(kSectors * kSector);
+  auto j = boot();
+  appendRange(*j, 1, 500);
+  CHECK(pending(*j) == range(129, 500));
+
+  auto r = boot();
+  FlashJournal::Cursor c;
+  CHECK(r->cursor(c));
+  CHECK_EQ(c.head, 500u - kSlots);
+  CHECK_EQ(r->lastSeq(), 500u);
+  CHECK(pending(*r) == range(129, 500));
+  CHECK(append(*r, 501));
+  CHECK(pending(*r) == range(129, 501));
+}
+
+// Power lost after `cut` bytes of the next slot write (append or ack).
+void testCutDuringSlotWrite() {
+  for (long cut = 0; cut <= long(FlashJournal::kSlotSize); ++cut) {
+    for (int isAck = 0; isAck < 2; ++isAck) {
+      setContext(isAck ? "ack cut" : "append cut", cut);
+      fakeflash::reset(kSectors * kSector);
+      {
+        auto j = boot();
+        appendRange(*j, 1, 10);
+        CHECK(j->ack(3));
+        fakeflash::armCut(cut);
+        try {
+          if (isAck) j->ack(8);
+          else       append(*j, 11);
+        } catch (const fakeflash::PowerCut&) {
+        }
+        fakeflash::armCut(-1);
+      }
+      const bool whole = cut == long(FlashJournal::kSlotSize);
+      auto r = boot();
+      CHECK_EQ(r->stats().torn, (cut > 0 && !whole) ? 1u : 0u);
+      CHECK_EQ(r->ackedSeq(), (isAck && whole) ? 8u : 3u);
+      CHECK_EQ(r->lastSeq(), (!isAck && whole) ? 11u : 10u);
+
+      std::vector<uint32_t> want = range((isAck && whole) ? 9 : 4, 10);
+      if (!isAck && whole) want.push_back(11);
+      CHECK(pending(*r) == want);
+
+      // The next write steps over the torn slot and lands after it.
+      CHECK(append(*r, 12));
+      want.push_back(12);
+      CHECK(pending(*r) == want);
+      FlashJournal::Cursor c;
+      CHECK(r->cursor(c));
+      CHECK_EQ(c.head, (cut > 0) ? 13u : 12u);
+
+      auto again = boot();
+      CHECK(pending(*again) == want);
+    }
+  }
+  check::context()[0] = '\0';
+}
+
+// Power lost after `cut` bytes of the erase that opens a full sector. The
+// half-erased sector holds blank slots, one torn slot and old records with
+// low stamps; the next boot must put the head back on it and erase again.
+void testCutDuringErase() {
+  for (long cut = 0; cut <= long(kSector); ++cut) {
+    setContext("erase cut", cut);
+    fakeflash::reset(kSectors * kSector);
+    {
+      auto j = boot();
+      appendRange(*j, 1, kSlots);   // full; head wraps to sector 0
+      fakeflash::armCut(cut);
+      try {
+        append(*j, kSlots + 1);
+      } catch (const fakeflash::PowerCut&) {
+      }
+      fakeflash::armCut(-1);
+    }
+    // cut == kSector: the erase completed and the slot write got nothing.
+    auto r = boot();
+    FlashJournal::Cursor c;
+    CHECK(r->cursor(c));
+    CHECK_EQ(c.head, 0u);
+    CHECK_EQ(r->stats().torn, (cut % FlashJournal::kSlotSize) ? 1u : 0u);
+    // Re-erased on boot; the records the cut spared are dropped now.
+    CHECK_EQ(r->stats().erases, cut < long(kSector) ? 1u : 0u);
+    CHECK_EQ(r->stats().dropped, uint32_t(kSector - cut) / FlashJournal::kSlotSize);
+    CHECK(append(*r, kSlots + 1));
+    CHECK(pending(*r) == range(kPerSec + 1, kSlots + 1));
+    auto again = boot();
+    CHECK(pending(*again) == range(kPerSec + 1, kSlots + 1));
+    CHECK_EQ(again->stats().torn, 0u);
+  }
+  check::context()[0] = '\0';
+}
+
+void testAckTruncation() {
+  fakeflash::reset(kSectors * kSector);
+  auto j = boot();
+  appendRange(*j, 1, 20);
+  CHECK(j->ack(10));
+  CHECK(pending(*j) == range(11, 20));
+
+  // An older ack is a no-op: no slot written.
+  const uint64_t written = fakeflash::counters().bytesWritten;
+  CHECK(j->ack(5));
+  CHECK_EQ(fakeflash::counters().bytesWritten, written);
+  CHECK_EQ(j->stats().acks, 1u);
+
+  CHECK(j->ack(20));
+  CHECK(pending(*j).empty());
+  auto r = boot();
+  CHECK_EQ(r->ackedSeq(), 20u);
+  CHECK(pending(*r).empty());
+  CHECK(append(*r, 21));
+  CHECK(pending(*r) == range(21, 21));
+}
+
+// Unacked records are overwritten a sector at a time, oldest first, and
+// counted; acked ones are not.
+void testWrapOverUnacked() {
+  fakeflash::reset(kSectors * kSector);
+  auto j = boot();
+  appendRange(*j, 1, kSlots + 200);
+  CHECK_EQ(j->stats().dropped, 2 * kPerSec);
+  CHECK_EQ(j->stats().erases, 2u);
+  CHECK(pending(*j) == range(2 * kPerSec + 1, kSlots + 200));
+  auto r = boot();
+  CHECK(pending(*r) == range(2 * kPerSec + 1, kSlots + 200));
+
+  fakeflash::reset(kSectors * kSector);
+  auto k = boot();
+  appendRange(*k, 1, kSlots);
+  CHECK(pending(*k) == range(1, kSlots));   // head on an unerased sector: oldest first
+  CHECK(k->ack(200));   // the ack slot itself opens sector 0 again
+  CHECK_EQ(k->stats().dropped, 0u);
+  CHECK(pending(*k) == range(201, kSlots));
+}
+
+struct Budget {
+  std::vector<uint32_t> seqs;
+  int left;
+};
+
+bool take(void* ctx, uint32_t seq, uint8_t, const uint8_t*, uint8_t) {
+  auto* b = static_cast<Budget*>(ctx);
+  if (b->left == 0) return false;
+  --b->left;
+  b->seqs.push_back(seq);
+  return true;
+}
+
+// Staged replay: each call picks up where the visitor stopped.
+void testPendingCursor() {
+  fakeflash::reset(kSectors * kSector);
+  auto j = boot();
+  appendRange(*j, 1, 50);
+
+  Budget b;
+  uint32_t pos = FlashJournal::kFromOldest;
+  unsigned calls = 0;
+  const uint64_t read0 = fakeflash::counters().bytesRead;
+  for (;;) {
+    b.left = 7;
+    ++calls;
+    if (j->forEachPending(take, &b, pos) == 0) break;
+  }
+  CHECK(b.seqs == range(1, 50));
+  // One ring walk plus one chunk re-read per resumed call.
+  CHECK(fakeflash::counters().bytesRead - read0 <=
+        uint64_t(kSlots + calls * 8) * FlashJournal::kSlotSize);
+
+  // Records appended after the walk are next in line for the same cursor.
+  appendRange(*j, 51, 60);
+  b.seqs.clear();
+  b.left = -1;
+  j->forEachPending(take, &b, pos);
+  CHECK(b.seqs == range(51, 60));
+
+  CHECK(j->ack(30));
+  CHECK(pending(*j) == range(31, 60));
+
+  // A cursor made stale by an erase yields nothing twice; a walk from the
+  // oldest slot still finds everything.
+  fakeflash::reset(kSectors * kSector);
+  auto k = boot();
+  appendRange(*k, 1, kSlots);
+  Budget s;
+  s.left = 10;
+  pos = FlashJournal::kFromOldest;
+  k->forEachPending(take, &s, pos);
+  CHECK(s.seqs == range(1, 10));
+  CHECK(append(*k, kSlots + 1));   // erases sector 0 (seq 1..128)
+  s.left = -1;
+  k->forEachPending(take, &s, pos);
+  for (size_t i = 1; i < s.seqs.size(); ++i) CHECK(s.seqs[i] > s.seqs[i - 1]);
+  CHECK(pending(*k) == range(kPerSec + 1, kSlots + 1));
+}
+
+void testResume() {
+  fakeflash::reset(kSectors * kSector);
+  FlashJournal::Cursor c;
+  {
+    auto j = boot();
+    appendRange(*j, 1, 140);
+    CHECK(j->ack(70));
+    CHECK(j->cursor(c));
+  }
+  FlashJournal warm;
+  CHECK(warm.resume(c));
+  CHECK_EQ(warm.stats().scanUs, 0u);
+  CHECK(pending(warm) == range(71, 140));
+  CHECK(append(warm, 141));
+  auto r = boot();
+  CHECK(pending(*r) == range(71, 141));
+
+  FlashJournal::Cursor bad = c;
+  bad.slots = kSlots + kPerSec;
+  FlashJournal cold;
+  CHECK(!cold.resume(bad));
+  CHECK(!cold.ready());
+  CHECK(cold.begin());
+  CHECK(pending(cold) == range(71, 141));
+}
+
+// ------------------------------------------------------------------
+// Write amplification: the ring against the coalesced NVS blob it
+// replaced (EspNowManager::nvSaveJournal_, kept for partition tables
+// without "journal"). NVS stores a blob as an index entry, a data header
+// entry and the data in 32-byte entries, never in place, and erases a
+// 4 KiB page per 126 entries written.
+constexpr size_t   kNvsEntry        = 32;
+constexpr size_t   kNvsPageEntries  = 126;
+constexpr size_t   kJournalMaxBytes = 1024;   // ESPNOW_JOURNAL_MAX_BYTES
+constexpr uint32_t kCoalesceMax     = 8;      // EspNowManager::JOURNAL_COALESCE_MAX
+
+struct Cost {
+  uint64_t bytes;
+  uint64_t erases;
+};
+
+uint8_t fieldLen(uint32_t seq) { return seq % 3; }   // 0..2 byte payloads, as in the firmware
+
+// saveEvery = records per blob save: kCoalesceMax for a burst, 1 when
+// events are more than JOURNAL_COALESCE_MS apart.
+Cost nvsBlob(uint32_t records, uint32_t saveEvery) {
+  std::vector<size_t> sizes;
+  size_t   len = 0;
+  uint64_t entries = 0;
+  auto save = [&]() {
+    const size_t blob = journal::varintSize(1) + len;
+    entries += 2 + (blob + kNvsEntry - 1) / kNvsEntry;
+  };
+  for (uint32_t seq = 1; seq <= records; ++seq) {
+    sizes.push_back(journal::recordSize(1, fieldLen(seq)));
+    len += sizes.back();
+    while (len > kJournalMaxBytes) {   // oldest evicted, as in appendJournalRam_
+      len -= sizes.front();
+      sizes.erase(sizes.begin());
+    }
+    if (seq % saveEvery == 0) save();
+  }
+  save();   // forced before replay
+  return {entries * kNvsEntry, entries / kNvsPageEntries};
+}
+
+// Steady state: the 64 KiB partition has wrapped before, so every sector
+// the records enter costs an erase.
+Cost ring(uint32_t records) {
+  fakeflash::reset(16 * kSector);
+  auto j = boot();
+  const uint8_t f[2] = {0x11, 0x22};
+  const uint32_t warm = j->capacity();
+  for (uint32_t seq = 1; seq <= warm; ++seq) j->append(seq, 1, f, 0);
+  j->ack(warm);
+  fakeflash::counters() = fakeflash::Counters();
+  const uint32_t written0 = j->stats().bytesWritten;
+  for (uint32_t seq = warm + 1; seq <= warm + records; ++seq) j->append(seq, 1, f, fieldLen(seq));
+  j->ack(warm + records);
+  CHECK_EQ(fakeflash::counters().bytesWritten, j->stats().bytesWritten - written0);
+  return {fakeflash::counters().bytesWritten, fakeflash::counters().erases};
+}
+
+void reportWriteAmplification() {
+  std::printf("\n  write amplification (flash bytes written, erases)\n");
+  std::printf("  %-8s %-6s %10s %6s %10s %6s %7s\n",
+              "records", "saves", "ring B", "erase", "nvs B", "erase", "nvs/ring");
+  const uint32_t counts[] = {8, 64, 256, 1024};
+  for (uint32_t n : counts) {
+    const Cost r = ring(n);
+    for (uint32_t every : {kCoalesceMax, 1u}) {
+      const Cost v = nvsBlob(n, every);
+      std::printf("  %-8u %-6s %10llu %6llu %10llu %6llu %7.2f\n", (unsigned)n,
+                  every == 1 ? "each" : "burst",
+                  (unsigned long long)r.bytes, (unsigned long long)r.erases,
+                  (unsigned long long)v.bytes, (unsigned long long)v.erases,
+                  double(v.bytes) / double(r.bytes));
+    }
+  }
+  // Once the blob has grown, every save rewrites it whole: the ring wins.
+  CHECK(nvsBlob(256, 1).bytes > ring(256).bytes);
+  CHECK(nvsBlob(1024, kCoalesceMax).bytes > ring(1024).bytes);
+}
+
+}  // namespace
+
+int main() {
+  testRoundTrip();
+  testHeadSearchAfterWrap();
+  testCutDuringSlotWrite();
+  testCutDuringErase();
+  testAckTruncation();
+  testWrapOverUnacked();
+  testPendingCursor();
+  testResume();
+  reportWriteAmplification();
+  return check::summary("test_flash_journal");
+}